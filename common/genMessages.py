@@ -0,0 +1,502 @@
+#!/usr/bin/env python3
+"""
+Generates the message definitions from common/messages.def.
+
+  python3 common/genMessages.py [SCHEMA [OUT_DIR]]
+
+Writes, next to the schema unless OUT_DIR is given:
+  messageDefinitions.h   packed C structs with explicit padding, message type IDs, and
+                         static_asserts on every size and offset
+  messageDispatch.h      type table, zero-copy views and a dispatch switch for C++
+  messageDefinitions.py  type IDs and struct module formats for Python modules
+
+The layout of every struct is the one a C compiler gives it with natural alignment, so the
+generated headers are wire compatible with the hand-written structs they replaced. Padding is
+written out as pad fields and the structs are packed, so the layout no longer depends on the
+compiler.
+
+Schema syntax, one statement per line:
+  # comment, not copied
+  /** ... */                       doc comment, copied in front of the next struct
+  const NAME VALUE [// comment]   constant, VALUE is a number or a string
+  section TEXT                    heading for the message types that follow
+  struct NAME {                   plain struct, e.g. MSG_HEADER
+  message NAME = ID {             message type NAME with struct M_NAME
+    TYPE NAME[DIM]...; [comment]  field, DIM is a number or a constant
+    TYPE NAME[DIM] count(FIELD) size(MACRO);
+                                  variable-length array: only FIELD entries are sent, and
+                                  MACRO(n) is the length of a packet with n entries
+  };
+"""
+
+import os
+import re
+import sys
+
+PRIMITIVES = {
+  # name: (size, struct module format)
+  'char': (1, 's'),
+  'short': (2, 'h'),
+  'unsigned short': (2, 'H'),
+  'int': (4, 'i'),
+  'unsigned int': (4, 'I'),
+  'float': (4, 'f'),
+  'double': (8, 'd'),
+  'int32_t': (4, 'i'),
+  'uint32_t': (4, 'I'),
+  'int64_t': (8, 'q'),
+  'uint64_t': (8, 'Q'),
+}
+
+FIELD_RE = re.compile(r'^(?P<type>(?:unsigned\s+)?\w+)\s+(?P<name>\w+)(?P<dims>(?:\[\w+\])*)'
+                      r'(?:\s+count\((?P<count>\w+)\)\s+size\((?P<size>\w+)\))?\s*;\s*(?P<comment>.*)$')
+
+
+class Field:
+  def __init__(self, typeName, name, dims, dimNames, comment, count=None, sizeMacro=None):
+    self.typeName = typeName
+    self.name = name
+    self.dims = dims # resolved numbers
+    self.dimNames = dimNames # as written in the schema
+    self.comment = comment
+    self.count = count
+    self.sizeMacro = sizeMacro
+    self.offset = 0
+    self.padding = False
+
+
+class Struct:
+  def __init__(self, name, doc, msgName=None, msgType=None, section=None):
+    self.name = name
+    self.doc = doc
+    self.msgName = msgName
+    self.msgType = msgType
+    self.section = section
+    self.fields = []
+    self.size = 0
+    self.align = 1
+
+  def variableField(self):
+    for field in self.fields:
+      if field.count is not None:
+        return field
+    return None
+
+
+class Schema:
+  def __init__(self):
+    self.consts = [] # (name, value, comment)
+    self.constValues = {}
+    self.sections = []
+    self.structs = []
+    self.structByName = {}
+
+  def typeInfo(self, typeName):
+    """Size and alignment of a field type."""
+    if typeName in PRIMITIVES:
+      size = PRIMITIVES[typeName][0]
+      return size, size
+    if typeName in self.structByName:
+      struct = self.structByName[typeName]
+      return struct.size, struct.align
+    raise SyntaxError('unknown type ' + typeName)
+
+  def dimValue(self, dim, lineNum):
+    if dim.isdigit():
+      return int(dim)
+    if dim in self.constValues and isinstance(self.constValues[dim], int):
+      return self.constValues[dim]
+    raise SyntaxError('line %d: unknown array size %s' % (lineNum, dim))
+
+
+def elementCount(field):
+  n = 1
+  for dim in field.dims:
+    n *= dim
+  return n
+
+
+def layout(schema, struct):
+  """Lays out a struct the way a C compiler does, writing the padding out as fields."""
+  fields = []
+  offset = 0
+  align = 1
+  padIndex = 0
+  for field in struct.fields:
+    size, fieldAlign = schema.typeInfo(field.typeName)
+    if offset % fieldAlign != 0:
+      padLength = fieldAlign - offset % fieldAlign
+      pad = Field('char', 'pad%d' % padIndex, [padLength], [str(padLength)], '')
+      pad.offset = offset
+      pad.padding = True
+      fields.append(pad)
+      padIndex += 1
+      offset += padLength
+    field.offset = offset
+    fields.append(field)
+    offset += size * elementCount(field)
+    align = max(align, fieldAlign)
+  if offset % align != 0:
+    padLength = align - offset % align
+    pad = Field('char', 'pad%d' % padIndex, [padLength], [str(padLength)], '')
+    pad.offset = offset
+    pad.padding = True
+    fields.append(pad)
+    offset += padLength
+  struct.fields = fields
+  struct.size = offset
+  struct.align = align
+
+
+def parse(path):
+  schema = Schema()
+  doc = []
+  inDoc = False
+  current = None
+  section = None
+  for lineNum, rawLine in enumerate(open(path), 1):
+    line = rawLine.rstrip('\n')
+    stripped = line.strip()
+    if inDoc:
+      doc.append(line)
+      if stripped.endswith('*/'):
+        inDoc = False
+      continue
+    if stripped == '' or stripped.startswith('#'):
+      continue
+    if stripped.startswith('/**'):
+      doc = [line]
+      inDoc = not stripped.endswith('*/')
+      continue
+    if current is not None:
+      if stripped == '};':
+        layout(schema, current)
+        schema.structs.append(current)
+        schema.structByName[current.name] = current
+        current = None
+        continue
+      match = FIELD_RE.match(stripped)
+      if match is None:
+        raise SyntaxError('line %d: cannot parse field: %s' % (lineNum, stripped))
+      dimNames = re.findall(r'\[(\w+)\]', match.group('dims'))
+      dims = [schema.dimValue(dim, lineNum) for dim in dimNames]
+      typeName = ' '.join(match.group('type').split())
+      schema.typeInfo(typeName)
+      current.fields.append(Field(typeName, match.group('name'), dims, dimNames, match.group('comment'),
+                                  match.group('count'), match.group('size')))
+      continue
+    words = stripped.split(None, 2)
+    if words[0] == 'const':
+      valueAndComment = words[2]
+      comment = ''
+      if '//' in valueAndComment and not valueAndComment.startswith('"'):
+        valueAndComment, comment = valueAndComment.split('//', 1)
+        comment = '//' + comment
+      value = valueAndComment.strip()
+      schema.consts.append((words[1], value, comment))
+      schema.constValues[words[1]] = int(value) if value.isdigit() else value
+    elif words[0] == 'section':
+      section = stripped[len('section'):].strip()
+      schema.sections.append(section)
+    elif words[0] == 'struct':
+      match = re.match(r'^struct\s+(\w+)\s*\{$', stripped)
+      if match is None:
+        raise SyntaxError('line %d: expected struct NAME {' % lineNum)
+      current = Struct(match.group(1), doc)
+      doc = []
+    elif words[0] == 'message':
+      match = re.match(r'^message\s+(\w+)\s*=\s*(\d+)\s*\{$', stripped)
+      if match is None:
+        raise SyntaxError('line %d: expected message NAME = ID {' % lineNum)
+      current = Struct('M_' + match.group(1), doc, match.group(1), int(match.group(2)), section)
+      doc = []
+    else:
+      raise SyntaxError('line %d: unknown statement %s' % (lineNum, words[0]))
+  if current is not None:
+    raise SyntaxError('%s ends inside struct %s' % (path, current.name))
+  types = {}
+  for struct in schema.structs:
+    if struct.msgType is not None:
+      if struct.msgType in types:
+        raise SyntaxError('%s and %s have the same type ID %d' % (types[struct.msgType], struct.msgName, struct.msgType))
+      types[struct.msgType] = struct.msgName
+  return schema
+
+
+def messagesIn(schema, section):
+  """Messages of a section, sorted by type ID."""
+  return sorted([s for s in schema.structs if s.msgType is not None and s.section == section], key=lambda s: s.msgType)
+
+
+def fieldDeclaration(field):
+  dims = ''.join('[%s]' % dim for dim in field.dimNames)
+  comment = (' ' + field.comment) if field.comment else ''
+  if field.padding:
+    comment = ' /**< Padding a C compiler would add */'
+  return '  %s %s%s;%s' % (field.typeName, field.name, dims, comment)
+
+
+def generateHeader(schema, schemaName):
+  out = []
+  out.append('// Generated by common/genMessages.py from common/%s, do not edit.' % schemaName)
+  out.append('#pragma once')
+  out.append('')
+  out.append('#include <stddef.h>')
+  out.append('')
+  for name, value, comment in schema.consts:
+    out.append(('#define %s %s %s' % (name, value, comment)).rstrip())
+  for section in schema.sections:
+    out.append('')
+    out.append('// ' + section)
+    for struct in messagesIn(schema, section):
+      out.append('#define %s %d' % (struct.msgName, struct.msgType))
+  out.append('')
+  out.append('#pragma pack(push, 1)')
+  for struct in schema.structs:
+    out.append('')
+    out.extend(struct.doc)
+    out.append('typedef struct {')
+    for field in struct.fields:
+      out.append(fieldDeclaration(field))
+    out.append('} %s;' % struct.name)
+    variable = struct.variableField()
+    if variable is not None:
+      elemSize = schema.typeInfo(variable.typeName)[0]
+      out.append('')
+      out.append('#define %s(%s) (offsetof(%s, %s) + (%s) * %d)' % (variable.sizeMacro, variable.count, struct.name,
+                                                                   variable.name, variable.count, elemSize))
+  out.append('')
+  out.append('#pragma pack(pop)')
+  out.append('')
+  out.append('// The layouts below are what the structs had before they were packed, and what modules in other')
+  out.append('// languages expect.')
+  for struct in schema.structs:
+    out.append('static_assert(sizeof(%s) == %d, "%s layout changed");' % (struct.name, struct.size, struct.name))
+    for field in struct.fields:
+      if not field.padding:
+        out.append('static_assert(offsetof(%s, %s) == %d, "%s layout changed");' % (struct.name, field.name, field.offset,
+                                                                                     struct.name))
+  out.append('')
+  return '\n'.join(out)
+
+
+def minSize(struct):
+  variable = struct.variableField()
+  return variable.offset if variable is not None else struct.size
+
+
+def generateDispatch(schema, schemaName):
+  messages = sorted([s for s in schema.structs if s.msgType is not None], key=lambda s: s.msgType)
+  out = []
+  out.append('// Generated by common/genMessages.py from common/%s, do not edit.' % schemaName)
+  out.append('#pragma once')
+  out.append('')
+  out.append('#ifndef _MESSAGEDISPATCH_H_')
+  out.append('#define _MESSAGEDISPATCH_H_')
+  out.append('')
+  out.append('#include <string.h>')
+  out.append('#include "messageDefinitions.h"')
+  out.append('')
+  out.append('/**')
+  out.append(' * @file messageDispatch.h')
+  out.append(' * @brief Message type table, zero-copy views and dispatch.')
+  out.append(' *')
+  out.append(' * The message structs are packed, so a view is just the packet cast to the struct, after')
+  out.append(' * checking its type and length. dispatchMessage calls visitor(message, length) with the view of')
+  out.append(' * a packet of any known type.')
+  out.append(' */')
+  out.append('')
+  out.append('typedef struct {')
+  out.append('  int type;')
+  out.append('  const char* name;')
+  out.append('  int size; /**< sizeof the struct */')
+  out.append('  int minSize; /**< Shortest valid packet, less than size for messages with a variable-length array */')
+  out.append('} MESSAGE_INFO;')
+  out.append('')
+  out.append('#define NUM_MESSAGE_TYPES %d' % len(messages))
+  out.append('')
+  out.append('/** All message types, sorted by type */')
+  out.append('static const MESSAGE_INFO MESSAGE_TABLE[NUM_MESSAGE_TYPES] = {')
+  for struct in messages:
+    out.append('  {%s, "%s", sizeof(%s), %d},' % (struct.msgName, struct.msgName, struct.name, minSize(struct)))
+  out.append('};')
+  out.append('')
+  out.append('/**')
+  out.append(' * @return Table entry of a message type, NULL if the type is unknown')
+  out.append(' */')
+  out.append('inline const MESSAGE_INFO* findMessageInfo(int type)')
+  out.append('{')
+  out.append('  int low = 0;')
+  out.append('  int high = NUM_MESSAGE_TYPES;')
+  out.append('  while (low < high) {')
+  out.append('    int mid = (low + high) / 2;')
+  out.append('    if (MESSAGE_TABLE[mid].type < type) {')
+  out.append('      low = mid + 1;')
+  out.append('    }')
+  out.append('    else {')
+  out.append('      high = mid;')
+  out.append('    }')
+  out.append('  }')
+  out.append('  return (low < NUM_MESSAGE_TYPES && MESSAGE_TABLE[low].type == type) ? &MESSAGE_TABLE[low] : NULL;')
+  out.append('}')
+  out.append('')
+  out.append('inline const char* messageName(int type)')
+  out.append('{')
+  out.append('  const MESSAGE_INFO* info = findMessageInfo(type);')
+  out.append('  return (info == NULL) ? "UNKNOWN" : info->name;')
+  out.append('}')
+  out.append('')
+  out.append('/**')
+  out.append(' * Message type of a packet, -1 if it is too short to have a MSG_HEADER.')
+  out.append(' */')
+  out.append('inline int packetMsgType(const char* packet, int length)')
+  out.append('{')
+  out.append('  if (length < (int) sizeof(MSG_HEADER)) {')
+  out.append('    return -1;')
+  out.append('  }')
+  out.append('  int msgType;')
+  out.append('  memcpy(&msgType, packet + offsetof(MSG_HEADER, msg_type), sizeof(msgType));')
+  out.append('  return msgType;')
+  out.append('}')
+  out.append('')
+  out.append('/**')
+  out.append(' * Message type and packet checks of each message struct. complete() checks that a packet is')
+  out.append(' * long enough for the entries its variable-length array says it has.')
+  out.append(' */')
+  out.append('template<typename T> struct MessageTraits;')
+  for struct in messages:
+    variable = struct.variableField()
+    out.append('')
+    out.append('template<> struct MessageTraits<%s>' % struct.name)
+    out.append('{')
+    out.append('  enum { type = %s, minSize = %d };' % (struct.msgName, minSize(struct)))
+    if variable is None:
+      out.append('  static bool complete(const %s*, int) { return true; }' % struct.name)
+    else:
+      maxCount = variable.dimNames[0]
+      out.append('  static bool complete(const %s* message, int length)' % struct.name)
+      out.append('  {')
+      out.append('    return message->%s <= %s && length >= (int) %s(message->%s);' % (variable.count, maxCount,
+                                                                                      variable.sizeMacro, variable.count))
+      out.append('  }')
+    out.append('};')
+  out.append('')
+  out.append('/**')
+  out.append(' * View of a packet as a message struct, without copying it.')
+  out.append(' * @return NULL if the packet is of another type, or too short')
+  out.append(' */')
+  out.append('template<typename T>')
+  out.append('inline const T* messageView(const char* packet, int length)')
+  out.append('{')
+  out.append('  if (length < (int) MessageTraits<T>::minSize || packetMsgType(packet, length) != (int) MessageTraits<T>::type) {')
+  out.append('    return NULL;')
+  out.append('  }')
+  out.append('  const T* message = reinterpret_cast<const T*>(packet);')
+  out.append('  return MessageTraits<T>::complete(message, length) ? message : NULL;')
+  out.append('}')
+  out.append('')
+  out.append('/**')
+  out.append(' * Calls visitor(view, length) with the view of a packet. The visitor needs an overload for every')
+  out.append(' * message type, or a template catch-all.')
+  out.append(' * @return 1 if the visitor was called, 0 if the type is unknown or the packet is too short')
+  out.append(' */')
+  out.append('template<typename Visitor>')
+  out.append('inline int dispatchMessage(const char* packet, int length, Visitor& visitor)')
+  out.append('{')
+  out.append('  switch (packetMsgType(packet, length))')
+  out.append('  {')
+  for struct in messages:
+    out.append('    case %s:' % struct.msgName)
+    out.append('    {')
+    out.append('      const %s* message = messageView<%s>(packet, length);' % (struct.name, struct.name))
+    out.append('      if (message == NULL) {')
+    out.append('        return 0;')
+    out.append('      }')
+    out.append('      visitor(*message, length);')
+    out.append('      return 1;')
+    out.append('    }')
+  out.append('    default:')
+  out.append('      return 0;')
+  out.append('  }')
+  out.append('}')
+  out.append('')
+  out.append('#endif')
+  out.append('')
+  return '\n'.join(out)
+
+
+def pythonFields(schema, struct, prefix):
+  """Flattened (name, format) pairs of a struct, in struct module notation."""
+  fields = []
+  for field in struct.fields:
+    name = prefix + field.name
+    if field.typeName in schema.structByName:
+      nested = schema.structByName[field.typeName]
+      if field.dims:
+        for i in range(elementCount(field)):
+          fields.extend(pythonFields(schema, nested, '%s[%d].' % (name, i)))
+      else:
+        fields.extend(pythonFields(schema, nested, name + '.'))
+    elif field.padding:
+      fields.append((None, '%dx' % field.dims[0]))
+    elif field.typeName == 'char':
+      # Each string of a char array is one bytes value
+      stringLength = field.dims[-1]
+      for i in range(elementCount(field) // stringLength):
+        suffix = '[%d]' % i if len(field.dims) > 1 else ''
+        fields.append((name + suffix, '%ds' % stringLength))
+    else:
+      count = elementCount(field)
+      fmt = PRIMITIVES[field.typeName][1]
+      fields.append((name, ('%d%s' % (count, fmt)) if field.dims else fmt))
+  return fields
+
+
+def generatePython(schema, schemaName):
+  out = []
+  out.append('# Generated by common/genMessages.py from common/%s, do not edit.' % schemaName)
+  out.append('"""')
+  out.append('Message type IDs and layouts for Python modules. MESSAGE_FORMATS gives the struct module format')
+  out.append('of each message type and the names of the values struct.unpack returns; arrays of numbers are')
+  out.append('returned as that many values in a row, strings as bytes.')
+  out.append('"""')
+  out.append('')
+  for name, value, comment in schema.consts:
+    out.append('%s = %s' % (name, value))
+  for section in schema.sections:
+    out.append('')
+    out.append('# ' + section)
+    for struct in messagesIn(schema, section):
+      out.append('%s = %d' % (struct.msgName, struct.msgType))
+  out.append('')
+  out.append('MESSAGE_FORMATS = {')
+  for struct in sorted([s for s in schema.structs if s.msgType is not None], key=lambda s: s.msgType):
+    fields = pythonFields(schema, struct, '')
+    fmt = '<' + ''.join(f for _, f in fields)
+    names = [n for n, _ in fields if n is not None]
+    out.append('  %s: (%r, %r, %d,' % (struct.msgName, struct.name, fmt, struct.size))
+    out.append('    %r),' % names)
+  out.append('}')
+  out.append('')
+  return '\n'.join(out)
+
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  schemaPath = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, 'messages.def')
+  outDir = sys.argv[2] if len(sys.argv) > 2 else os.path.dirname(os.path.abspath(schemaPath))
+  schema = parse(schemaPath)
+  schemaName = os.path.basename(schemaPath)
+  outputs = {
+    'messageDefinitions.h': generateHeader(schema, schemaName),
+    'messageDispatch.h': generateDispatch(schema, schemaName),
+    'messageDefinitions.py': generatePython(schema, schemaName),
+  }
+  for name, text in outputs.items():
+    with open(os.path.join(outDir, name), 'w') as outFile:
+      outFile.write(text)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
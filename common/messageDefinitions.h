@@ -1,12 +1,19 @@
+// Generated by common/genMessages.py from common/messages.def, do not edit.
+#pragma once
+
+#include <stddef.h>
+
 #define DEFAULT_IP "localhost:10000"
-#define MAX_PACKET_LENGTH 8192 // arbitrary 
-#define MAX_STRING_LENGTH 128  // also arbitrary
+#define MAX_PACKET_LENGTH 8192 // arbitrary
+#define MAX_STRING_LENGTH 128 // also arbitrary
+#define MAX_OBJECT_HANDLES 65536 // handles are dense, from 0 to MAX_OBJECT_HANDLES-1
+#define MAX_STREAM_CONTACTS 64 // contacts listed in one HAPTIC_DATA_STREAM_V2 message
+#define MAX_FRAME_SAMPLES 64 // samples in one HAPTIC_DATA_FRAME message
 
-// Test Packet 
+// Test Packet
 #define TEST_PACKET 9000
 
-// Experiment Control Messages 1-500 
-// Sometimes 0 is poorly parsed as a truncation signal
+// Experiment Control Messages 1-500 (not 0, which is sometimes parsed as a truncation signal)
 #define SESSION_START 1
 #define SESSION_END 2
 #define TRIAL_START 3
@@ -18,10 +25,17 @@
 #define PAUSE_RECORDING 9
 #define RESUME_RECORDING 10
 #define RESET_WORLD 11
+#define OBJECT_HANDLE_REGISTER 12
+#define REMOVE_OBJECT_BY_HANDLE 13
+#define STREAM_FORMAT 14
+#define SCENE_BEGIN 15
+#define SCENE_COMMIT 16
+#define OBJECT_READY 17
+#define MODULE_READY 18
 
 // Combined/Complex Object Messages 500-1000
 #define CST_CREATE 500
-#define CST_DESTRUCT 501 
+#define CST_DESTRUCT 501
 #define CST_START 502
 #define CST_STOP 503
 #define CST_SET_VISUAL 504
@@ -32,30 +46,40 @@
 #define CUPS_DESTRUCT 509
 #define CUPS_START 510
 #define CUPS_STOP 511
-#define CUPS_DATA 512 
+#define CUPS_DATA 512
 
 // Haptics Messages 1000-2000
 #define HAPTIC_DATA_STREAM 1000
 #define HAPTICS_SET_ENABLED 1001
 #define HAPTICS_SET_ENABLED_WORLD 1002
+#define HAPTIC_DATA_STREAM_V2 1003
+#define HAPTIC_DATA_FRAME 1004
 #define HAPTICS_SET_STIFFNESS 1008
-#define HAPTICS_BOUNDING_PLANE 1009 
+#define HAPTICS_BOUNDING_PLANE 1009
 #define HAPTICS_CONSTANT_FORCE_FIELD 1010
 #define HAPTICS_VISCOSITY_FIELD 1011
 #define HAPTICS_FREEZE_EFFECT 1012
 #define HAPTICS_REMOVE_WORLD_EFFECT 1013
+#define HAPTICS_SET_ENABLED_BY_HANDLE 1014
+#define HAPTICS_SET_ENABLED_WORLD_BY_HANDLE 1015
+#define HAPTICS_SET_STIFFNESS_BY_HANDLE 1016
+#define HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE 1017
 
-// Graphics Messages are 2000-3000 
+// Graphics Messages are 2000-3000
 #define GRAPHICS_SET_ENABLED 2000
 #define GRAPHICS_CHANGE_BG_COLOR 2001
 #define GRAPHICS_PIPE 2002
 #define GRAPHICS_ARROW 2003
 #define GRAPHICS_CHANGE_OBJECT_COLOR 2004
+#define GRAPHICS_SET_ENABLED_BY_HANDLE 2005
+#define GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE 2006
 #define GRAPHICS_MOVING_DOTS 2014
 #define GRAPHICS_SHAPE_BOX 2046
 #define GRAPHICS_SHAPE_SPHERE 2050
 #define GRAPHICS_SHAPE_TORUS 2051
 
+#pragma pack(push, 1)
+
 /**
  * MSG_HEADER is included in all messages that are sent. It contains metadata about the time and
  * type of message
@@ -64,9 +88,18 @@ typedef struct {
   int serial_no; /**< Serial Number of message, received from MessageHandler.*/
   int msg_type; /**< Type of message should correspond to one of the integers listed in messageDefinitions.h.*/
   double reserved; /**< Reserved for now */
-  double timestamp; /**< Time MessageHandler made the message.*/ 
+  double timestamp; /**< Time MessageHandler made the message.*/
 } MSG_HEADER;
 
+/**
+ * MSG_INGEST_PREFIX goes in front of a message that is sent straight to the MessageHandler ingest
+ * port instead of through the sendMessage RPC. It is stripped before the message is routed.
+ */
+typedef struct {
+  int moduleID; /**< ID of the module sending the message */
+  int reserved; /**< Keeps the message that follows 8-byte aligned */
+} MSG_INGEST_PREFIX;
+
 /**
  * M_TEST_PACKET is used for testing to ensure that message sending is working.
  */
@@ -87,6 +120,7 @@ typedef struct {
 typedef struct {
   MSG_HEADER header;
   int trialNum;
+  char pad0[4]; /**< Padding a C compiler would add */
 } M_TRIAL_START;
 
 typedef struct {
@@ -124,6 +158,75 @@ typedef struct {
   MSG_HEADER header;
 } M_RESET_WORLD;
 
+/**
+ * M_OBJECT_HANDLE_REGISTER binds an object or world effect name to a handle chosen by the sender.
+ * Messages ending in _BY_HANDLE then refer to the object by its handle instead of its name. Handles
+ * should be small and dense, since the receiver keeps them in an array. A name does not have to
+ * exist yet when its handle is registered, and registering a handle again rebinds it.
+ */
+typedef struct {
+  MSG_HEADER header;
+  int handle; /**< From 0 to MAX_OBJECT_HANDLES-1 */
+  char objectName[MAX_STRING_LENGTH];
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_OBJECT_HANDLE_REGISTER;
+
+typedef struct {
+  MSG_HEADER header;
+  int handle;
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_REMOVE_OBJECT_BY_HANDLE;
+
+/**
+ * M_STREAM_FORMAT selects the message the streamer sends: 1 for HAPTIC_DATA_STREAM (the default),
+ * 2 for HAPTIC_DATA_STREAM_V2, 3 for HAPTIC_DATA_FRAME. It applies until the next M_STREAM_FORMAT.
+ * A frame is sent once it holds frameSamples samples, or once its first sample is frameMicros old.
+ * Values of 0 or less keep the current setting.
+ */
+typedef struct {
+  MSG_HEADER header;
+  int version;
+  int frameSamples; /**< Version 3 only, at most MAX_FRAME_SAMPLES */
+  int frameMicros; /**< Version 3 only */
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_STREAM_FORMAT;
+
+/**
+ * Scene messages sent between M_SCENE_BEGIN and M_SCENE_COMMIT are applied together, in a single
+ * haptic tick, when M_SCENE_COMMIT arrives. Objects are built as their messages arrive, but only
+ * added to the world at the commit, so a half-built scene is never seen or felt.
+ */
+typedef struct {
+  MSG_HEADER header;
+} M_SCENE_BEGIN;
+
+typedef struct {
+  MSG_HEADER header;
+} M_SCENE_COMMIT;
+
+/**
+ * Sent by the haptics module once an object from a create message (shape, pipe, arrow, moving dots,
+ * bounding plane) has been built in the background and added to the world.
+ */
+typedef struct {
+  MSG_HEADER header;
+  int msgType; /**< Type of the message that created the object */
+  int serialNo; /**< serial_no of the message that created the object */
+  double buildSeconds; /**< Time spent building the object */
+  double readySeconds; /**< Time from receiving the message to adding the object to the world */
+  char objectName[MAX_STRING_LENGTH];
+} M_OBJECT_READY;
+
+/**
+ * Sent by MessageHandler to a module whose subscribeTo call was deferred because the module it
+ * subscribed to had not been added yet. The subscription is in place by the time this arrives.
+ */
+typedef struct {
+  MSG_HEADER header;
+  int moduleID; /**< ID of the module that was just added */
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_MODULE_READY;
+
 typedef struct {
   MSG_HEADER header;
   char cstName[MAX_STRING_LENGTH];
@@ -152,12 +255,14 @@ typedef struct {
   MSG_HEADER header;
   char cstName[MAX_STRING_LENGTH];
   int visionEnabled;
+  char pad0[4]; /**< Padding a C compiler would add */
 } M_CST_SET_VISUAL;
 
 typedef struct {
   MSG_HEADER header;
   char cstName[MAX_STRING_LENGTH];
   int hapticEnabled;
+  char pad0[4]; /**< Padding a C compiler would add */
 } M_CST_SET_HAPTIC;
 
 typedef struct {
@@ -182,7 +287,7 @@ typedef struct {
   double cartMass;
 } M_CUPS_CREATE;
 
-typedef struct  {
+typedef struct {
   MSG_HEADER header;
   char cupsName[MAX_STRING_LENGTH];
 } M_CUPS_DESTRUCT;
@@ -217,16 +322,65 @@ typedef struct {
   char collisions[4][MAX_STRING_LENGTH]; // 4 object collisions at a time
 } M_HAPTIC_DATA_STREAM;
 
+/**
+ * Compact version of M_HAPTIC_DATA_STREAM. Kinematics are floats, and contacts are listed as object
+ * handles (see M_OBJECT_HANDLE_REGISTER). Only the first numContacts entries of contacts are sent,
+ * so a packet is HAPTIC_STREAM_V2_SIZE(numContacts) bytes long: 68 bytes without contacts, against
+ * 608 for M_HAPTIC_DATA_STREAM.
+ */
+typedef struct {
+  MSG_HEADER header;
+  unsigned int deviceTick; /**< Haptic loop iterations since the start, wraps around */
+  unsigned short numContacts; /**< Entries used in contacts */
+  unsigned short unnamedContacts; /**< Contacts with objects that have no handle, or beyond MAX_STREAM_CONTACTS */
+  float pos[3];
+  float vel[3];
+  float force[3];
+  int contacts[MAX_STREAM_CONTACTS];
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_HAPTIC_DATA_STREAM_V2;
+
+#define HAPTIC_STREAM_V2_SIZE(numContacts) (offsetof(M_HAPTIC_DATA_STREAM_V2, contacts) + (numContacts) * 4)
+
+/**
+ * One kinematic sample in a M_HAPTIC_DATA_FRAME.
+ */
+typedef struct {
+  unsigned int deviceTick; /**< Haptic loop iterations since the start, as in M_HAPTIC_DATA_STREAM_V2 */
+  float timeOffset; /**< Seconds from the frame's header timestamp to this sample */
+  float pos[3];
+  float vel[3];
+  float force[3];
+} STREAM_SAMPLE;
+
+/**
+ * Several consecutive samples of the haptic data stream in one message. The header timestamp is
+ * the time of the first sample. Only the first numSamples entries of samples are sent, so a packet
+ * is HAPTIC_FRAME_SIZE(numSamples) bytes long. Frames do not list contacts. See streamFrame.h for
+ * unpacking a frame into M_HAPTIC_DATA_STREAM_V2 samples.
+ */
+typedef struct {
+  MSG_HEADER header;
+  unsigned short numSamples; /**< Entries used in samples */
+  unsigned short reserved;
+  unsigned int reserved2;
+  STREAM_SAMPLE samples[MAX_FRAME_SAMPLES];
+} M_HAPTIC_DATA_FRAME;
+
+#define HAPTIC_FRAME_SIZE(numSamples) (offsetof(M_HAPTIC_DATA_FRAME, samples) + (numSamples) * 44)
+
 typedef struct {
   MSG_HEADER header;
   char objectName[MAX_STRING_LENGTH];
   int enabled;
+  char pad0[4]; /**< Padding a C compiler would add */
 } M_HAPTICS_SET_ENABLED;
 
 typedef struct {
   MSG_HEADER header;
   char effectName[MAX_STRING_LENGTH];
   int enabled;
+  char pad0[4]; /**< Padding a C compiler would add */
 } M_HAPTICS_SET_ENABLED_WORLD;
 
 typedef struct {
@@ -235,6 +389,25 @@ typedef struct {
   double stiffness;
 } M_HAPTICS_SET_STIFFNESS;
 
+typedef struct {
+  MSG_HEADER header;
+  int handle;
+  int enabled;
+} M_HAPTICS_SET_ENABLED_BY_HANDLE;
+
+typedef struct {
+  MSG_HEADER header;
+  int handle;
+  int enabled;
+} M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE;
+
+typedef struct {
+  MSG_HEADER header;
+  int handle;
+  char pad0[4]; /**< Padding a C compiler would add */
+  double stiffness;
+} M_HAPTICS_SET_STIFFNESS_BY_HANDLE;
+
 typedef struct {
   MSG_HEADER header;
   double bWidth;
@@ -264,15 +437,28 @@ typedef struct {
   char effectName[MAX_STRING_LENGTH];
 } M_HAPTICS_REMOVE_WORLD_EFFECT;
 
+typedef struct {
+  MSG_HEADER header;
+  int handle;
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE;
+
 typedef struct {
   MSG_HEADER header;
   char objectName[MAX_STRING_LENGTH];
   int enabled;
+  char pad0[4]; /**< Padding a C compiler would add */
 } M_GRAPHICS_SET_ENABLED;
 
 typedef struct {
   MSG_HEADER header;
-  float color[4]; 
+  int handle;
+  int enabled;
+} M_GRAPHICS_SET_ENABLED_BY_HANDLE;
+
+typedef struct {
+  MSG_HEADER header;
+  float color[4];
 } M_GRAPHICS_CHANGE_BG_COLOR;
 
 typedef struct {
@@ -285,7 +471,7 @@ typedef struct {
   unsigned int numHeightSegments;
   double position[3];
   double rotation[9];
-  float color[4]; 
+  float color[4];
 } M_GRAPHICS_PIPE;
 
 typedef struct {
@@ -308,10 +494,18 @@ typedef struct {
   float color[4];
 } M_GRAPHICS_CHANGE_OBJECT_COLOR;
 
+typedef struct {
+  MSG_HEADER header;
+  int handle;
+  float color[4];
+  char pad0[4]; /**< Padding a C compiler would add */
+} M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE;
+
 typedef struct {
   MSG_HEADER header;
   char objectName[MAX_STRING_LENGTH];
   int numDots;
+  char pad0[4]; /**< Padding a C compiler would add */
   double coherence;
   double direction;
   double magnitude;
@@ -343,3 +537,274 @@ typedef struct {
   double localPosition[3];
   float color[4];
 } M_GRAPHICS_SHAPE_TORUS;
+
+#pragma pack(pop)
+
+// The layouts below are what the structs had before they were packed, and what modules in other
+// languages expect.
+static_assert(sizeof(MSG_HEADER) == 24, "MSG_HEADER layout changed");
+static_assert(offsetof(MSG_HEADER, serial_no) == 0, "MSG_HEADER layout changed");
+static_assert(offsetof(MSG_HEADER, msg_type) == 4, "MSG_HEADER layout changed");
+static_assert(offsetof(MSG_HEADER, reserved) == 8, "MSG_HEADER layout changed");
+static_assert(offsetof(MSG_HEADER, timestamp) == 16, "MSG_HEADER layout changed");
+static_assert(sizeof(MSG_INGEST_PREFIX) == 8, "MSG_INGEST_PREFIX layout changed");
+static_assert(offsetof(MSG_INGEST_PREFIX, moduleID) == 0, "MSG_INGEST_PREFIX layout changed");
+static_assert(offsetof(MSG_INGEST_PREFIX, reserved) == 4, "MSG_INGEST_PREFIX layout changed");
+static_assert(sizeof(M_TEST_PACKET) == 32, "M_TEST_PACKET layout changed");
+static_assert(offsetof(M_TEST_PACKET, header) == 0, "M_TEST_PACKET layout changed");
+static_assert(offsetof(M_TEST_PACKET, a) == 24, "M_TEST_PACKET layout changed");
+static_assert(offsetof(M_TEST_PACKET, b) == 28, "M_TEST_PACKET layout changed");
+static_assert(sizeof(M_SESSION_START) == 24, "M_SESSION_START layout changed");
+static_assert(offsetof(M_SESSION_START, header) == 0, "M_SESSION_START layout changed");
+static_assert(sizeof(M_SESSION_END) == 24, "M_SESSION_END layout changed");
+static_assert(offsetof(M_SESSION_END, header) == 0, "M_SESSION_END layout changed");
+static_assert(sizeof(M_TRIAL_START) == 32, "M_TRIAL_START layout changed");
+static_assert(offsetof(M_TRIAL_START, header) == 0, "M_TRIAL_START layout changed");
+static_assert(offsetof(M_TRIAL_START, trialNum) == 24, "M_TRIAL_START layout changed");
+static_assert(sizeof(M_TRIAL_END) == 24, "M_TRIAL_END layout changed");
+static_assert(offsetof(M_TRIAL_END, header) == 0, "M_TRIAL_END layout changed");
+static_assert(sizeof(M_START_RECORDING) == 152, "M_START_RECORDING layout changed");
+static_assert(offsetof(M_START_RECORDING, header) == 0, "M_START_RECORDING layout changed");
+static_assert(offsetof(M_START_RECORDING, filename) == 24, "M_START_RECORDING layout changed");
+static_assert(sizeof(M_STOP_RECORDING) == 24, "M_STOP_RECORDING layout changed");
+static_assert(offsetof(M_STOP_RECORDING, header) == 0, "M_STOP_RECORDING layout changed");
+static_assert(sizeof(M_REMOVE_OBJECT) == 152, "M_REMOVE_OBJECT layout changed");
+static_assert(offsetof(M_REMOVE_OBJECT, header) == 0, "M_REMOVE_OBJECT layout changed");
+static_assert(offsetof(M_REMOVE_OBJECT, objectName) == 24, "M_REMOVE_OBJECT layout changed");
+static_assert(sizeof(M_KEYPRESS) == 152, "M_KEYPRESS layout changed");
+static_assert(offsetof(M_KEYPRESS, header) == 0, "M_KEYPRESS layout changed");
+static_assert(offsetof(M_KEYPRESS, keyname) == 24, "M_KEYPRESS layout changed");
+static_assert(sizeof(M_PAUSE_RECORDING) == 24, "M_PAUSE_RECORDING layout changed");
+static_assert(offsetof(M_PAUSE_RECORDING, header) == 0, "M_PAUSE_RECORDING layout changed");
+static_assert(sizeof(M_RESUME_RECORDING) == 24, "M_RESUME_RECORDING layout changed");
+static_assert(offsetof(M_RESUME_RECORDING, header) == 0, "M_RESUME_RECORDING layout changed");
+static_assert(sizeof(M_RESET_WORLD) == 24, "M_RESET_WORLD layout changed");
+static_assert(offsetof(M_RESET_WORLD, header) == 0, "M_RESET_WORLD layout changed");
+static_assert(sizeof(M_OBJECT_HANDLE_REGISTER) == 160, "M_OBJECT_HANDLE_REGISTER layout changed");
+static_assert(offsetof(M_OBJECT_HANDLE_REGISTER, header) == 0, "M_OBJECT_HANDLE_REGISTER layout changed");
+static_assert(offsetof(M_OBJECT_HANDLE_REGISTER, handle) == 24, "M_OBJECT_HANDLE_REGISTER layout changed");
+static_assert(offsetof(M_OBJECT_HANDLE_REGISTER, objectName) == 28, "M_OBJECT_HANDLE_REGISTER layout changed");
+static_assert(sizeof(M_REMOVE_OBJECT_BY_HANDLE) == 32, "M_REMOVE_OBJECT_BY_HANDLE layout changed");
+static_assert(offsetof(M_REMOVE_OBJECT_BY_HANDLE, header) == 0, "M_REMOVE_OBJECT_BY_HANDLE layout changed");
+static_assert(offsetof(M_REMOVE_OBJECT_BY_HANDLE, handle) == 24, "M_REMOVE_OBJECT_BY_HANDLE layout changed");
+static_assert(sizeof(M_STREAM_FORMAT) == 40, "M_STREAM_FORMAT layout changed");
+static_assert(offsetof(M_STREAM_FORMAT, header) == 0, "M_STREAM_FORMAT layout changed");
+static_assert(offsetof(M_STREAM_FORMAT, version) == 24, "M_STREAM_FORMAT layout changed");
+static_assert(offsetof(M_STREAM_FORMAT, frameSamples) == 28, "M_STREAM_FORMAT layout changed");
+static_assert(offsetof(M_STREAM_FORMAT, frameMicros) == 32, "M_STREAM_FORMAT layout changed");
+static_assert(sizeof(M_SCENE_BEGIN) == 24, "M_SCENE_BEGIN layout changed");
+static_assert(offsetof(M_SCENE_BEGIN, header) == 0, "M_SCENE_BEGIN layout changed");
+static_assert(sizeof(M_SCENE_COMMIT) == 24, "M_SCENE_COMMIT layout changed");
+static_assert(offsetof(M_SCENE_COMMIT, header) == 0, "M_SCENE_COMMIT layout changed");
+static_assert(sizeof(M_OBJECT_READY) == 176, "M_OBJECT_READY layout changed");
+static_assert(offsetof(M_OBJECT_READY, header) == 0, "M_OBJECT_READY layout changed");
+static_assert(offsetof(M_OBJECT_READY, msgType) == 24, "M_OBJECT_READY layout changed");
+static_assert(offsetof(M_OBJECT_READY, serialNo) == 28, "M_OBJECT_READY layout changed");
+static_assert(offsetof(M_OBJECT_READY, buildSeconds) == 32, "M_OBJECT_READY layout changed");
+static_assert(offsetof(M_OBJECT_READY, readySeconds) == 40, "M_OBJECT_READY layout changed");
+static_assert(offsetof(M_OBJECT_READY, objectName) == 48, "M_OBJECT_READY layout changed");
+static_assert(sizeof(M_MODULE_READY) == 32, "M_MODULE_READY layout changed");
+static_assert(offsetof(M_MODULE_READY, header) == 0, "M_MODULE_READY layout changed");
+static_assert(offsetof(M_MODULE_READY, moduleID) == 24, "M_MODULE_READY layout changed");
+static_assert(sizeof(M_CST_CREATE) == 176, "M_CST_CREATE layout changed");
+static_assert(offsetof(M_CST_CREATE, header) == 0, "M_CST_CREATE layout changed");
+static_assert(offsetof(M_CST_CREATE, cstName) == 24, "M_CST_CREATE layout changed");
+static_assert(offsetof(M_CST_CREATE, lambdaVal) == 152, "M_CST_CREATE layout changed");
+static_assert(offsetof(M_CST_CREATE, forceMagnitude) == 160, "M_CST_CREATE layout changed");
+static_assert(offsetof(M_CST_CREATE, visionEnabled) == 168, "M_CST_CREATE layout changed");
+static_assert(offsetof(M_CST_CREATE, hapticEnabled) == 172, "M_CST_CREATE layout changed");
+static_assert(sizeof(M_CST_DESTRUCT) == 152, "M_CST_DESTRUCT layout changed");
+static_assert(offsetof(M_CST_DESTRUCT, header) == 0, "M_CST_DESTRUCT layout changed");
+static_assert(offsetof(M_CST_DESTRUCT, cstName) == 24, "M_CST_DESTRUCT layout changed");
+static_assert(sizeof(M_CST_START) == 152, "M_CST_START layout changed");
+static_assert(offsetof(M_CST_START, header) == 0, "M_CST_START layout changed");
+static_assert(offsetof(M_CST_START, cstName) == 24, "M_CST_START layout changed");
+static_assert(sizeof(M_CST_STOP) == 152, "M_CST_STOP layout changed");
+static_assert(offsetof(M_CST_STOP, header) == 0, "M_CST_STOP layout changed");
+static_assert(offsetof(M_CST_STOP, cstName) == 24, "M_CST_STOP layout changed");
+static_assert(sizeof(M_CST_SET_VISUAL) == 160, "M_CST_SET_VISUAL layout changed");
+static_assert(offsetof(M_CST_SET_VISUAL, header) == 0, "M_CST_SET_VISUAL layout changed");
+static_assert(offsetof(M_CST_SET_VISUAL, cstName) == 24, "M_CST_SET_VISUAL layout changed");
+static_assert(offsetof(M_CST_SET_VISUAL, visionEnabled) == 152, "M_CST_SET_VISUAL layout changed");
+static_assert(sizeof(M_CST_SET_HAPTIC) == 160, "M_CST_SET_HAPTIC layout changed");
+static_assert(offsetof(M_CST_SET_HAPTIC, header) == 0, "M_CST_SET_HAPTIC layout changed");
+static_assert(offsetof(M_CST_SET_HAPTIC, cstName) == 24, "M_CST_SET_HAPTIC layout changed");
+static_assert(offsetof(M_CST_SET_HAPTIC, hapticEnabled) == 152, "M_CST_SET_HAPTIC layout changed");
+static_assert(sizeof(M_CST_SET_LAMBDA) == 160, "M_CST_SET_LAMBDA layout changed");
+static_assert(offsetof(M_CST_SET_LAMBDA, header) == 0, "M_CST_SET_LAMBDA layout changed");
+static_assert(offsetof(M_CST_SET_LAMBDA, cstName) == 24, "M_CST_SET_LAMBDA layout changed");
+static_assert(offsetof(M_CST_SET_LAMBDA, lambdaVal) == 152, "M_CST_SET_LAMBDA layout changed");
+static_assert(sizeof(M_CST_DATA) == 48, "M_CST_DATA layout changed");
+static_assert(offsetof(M_CST_DATA, header) == 0, "M_CST_DATA layout changed");
+static_assert(offsetof(M_CST_DATA, cursorX) == 24, "M_CST_DATA layout changed");
+static_assert(offsetof(M_CST_DATA, cursorY) == 32, "M_CST_DATA layout changed");
+static_assert(offsetof(M_CST_DATA, cursorZ) == 40, "M_CST_DATA layout changed");
+static_assert(sizeof(M_CUPS_CREATE) == 184, "M_CUPS_CREATE layout changed");
+static_assert(offsetof(M_CUPS_CREATE, header) == 0, "M_CUPS_CREATE layout changed");
+static_assert(offsetof(M_CUPS_CREATE, cupsName) == 24, "M_CUPS_CREATE layout changed");
+static_assert(offsetof(M_CUPS_CREATE, escapeAngle) == 152, "M_CUPS_CREATE layout changed");
+static_assert(offsetof(M_CUPS_CREATE, pendulumLength) == 160, "M_CUPS_CREATE layout changed");
+static_assert(offsetof(M_CUPS_CREATE, ballMass) == 168, "M_CUPS_CREATE layout changed");
+static_assert(offsetof(M_CUPS_CREATE, cartMass) == 176, "M_CUPS_CREATE layout changed");
+static_assert(sizeof(M_CUPS_DESTRUCT) == 152, "M_CUPS_DESTRUCT layout changed");
+static_assert(offsetof(M_CUPS_DESTRUCT, header) == 0, "M_CUPS_DESTRUCT layout changed");
+static_assert(offsetof(M_CUPS_DESTRUCT, cupsName) == 24, "M_CUPS_DESTRUCT layout changed");
+static_assert(sizeof(M_CUPS_START) == 152, "M_CUPS_START layout changed");
+static_assert(offsetof(M_CUPS_START, header) == 0, "M_CUPS_START layout changed");
+static_assert(offsetof(M_CUPS_START, cupsName) == 24, "M_CUPS_START layout changed");
+static_assert(sizeof(M_CUPS_STOP) == 152, "M_CUPS_STOP layout changed");
+static_assert(offsetof(M_CUPS_STOP, header) == 0, "M_CUPS_STOP layout changed");
+static_assert(offsetof(M_CUPS_STOP, cupsName) == 24, "M_CUPS_STOP layout changed");
+static_assert(sizeof(M_CUPS_DATA) == 40, "M_CUPS_DATA layout changed");
+static_assert(offsetof(M_CUPS_DATA, header) == 0, "M_CUPS_DATA layout changed");
+static_assert(offsetof(M_CUPS_DATA, ballPos) == 24, "M_CUPS_DATA layout changed");
+static_assert(offsetof(M_CUPS_DATA, cartPos) == 32, "M_CUPS_DATA layout changed");
+static_assert(sizeof(M_HAPTIC_DATA_STREAM) == 608, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, header) == 0, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, posX) == 24, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, posY) == 32, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, posZ) == 40, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, velX) == 48, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, velY) == 56, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, velZ) == 64, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, forceX) == 72, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, forceY) == 80, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, forceZ) == 88, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM, collisions) == 96, "M_HAPTIC_DATA_STREAM layout changed");
+static_assert(sizeof(M_HAPTIC_DATA_STREAM_V2) == 328, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, header) == 0, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, deviceTick) == 24, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, numContacts) == 28, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, unnamedContacts) == 30, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, pos) == 32, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, vel) == 44, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, force) == 56, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_STREAM_V2, contacts) == 68, "M_HAPTIC_DATA_STREAM_V2 layout changed");
+static_assert(sizeof(STREAM_SAMPLE) == 44, "STREAM_SAMPLE layout changed");
+static_assert(offsetof(STREAM_SAMPLE, deviceTick) == 0, "STREAM_SAMPLE layout changed");
+static_assert(offsetof(STREAM_SAMPLE, timeOffset) == 4, "STREAM_SAMPLE layout changed");
+static_assert(offsetof(STREAM_SAMPLE, pos) == 8, "STREAM_SAMPLE layout changed");
+static_assert(offsetof(STREAM_SAMPLE, vel) == 20, "STREAM_SAMPLE layout changed");
+static_assert(offsetof(STREAM_SAMPLE, force) == 32, "STREAM_SAMPLE layout changed");
+static_assert(sizeof(M_HAPTIC_DATA_FRAME) == 2848, "M_HAPTIC_DATA_FRAME layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_FRAME, header) == 0, "M_HAPTIC_DATA_FRAME layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_FRAME, numSamples) == 24, "M_HAPTIC_DATA_FRAME layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_FRAME, reserved) == 26, "M_HAPTIC_DATA_FRAME layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_FRAME, reserved2) == 28, "M_HAPTIC_DATA_FRAME layout changed");
+static_assert(offsetof(M_HAPTIC_DATA_FRAME, samples) == 32, "M_HAPTIC_DATA_FRAME layout changed");
+static_assert(sizeof(M_HAPTICS_SET_ENABLED) == 160, "M_HAPTICS_SET_ENABLED layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED, header) == 0, "M_HAPTICS_SET_ENABLED layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED, objectName) == 24, "M_HAPTICS_SET_ENABLED layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED, enabled) == 152, "M_HAPTICS_SET_ENABLED layout changed");
+static_assert(sizeof(M_HAPTICS_SET_ENABLED_WORLD) == 160, "M_HAPTICS_SET_ENABLED_WORLD layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_WORLD, header) == 0, "M_HAPTICS_SET_ENABLED_WORLD layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_WORLD, effectName) == 24, "M_HAPTICS_SET_ENABLED_WORLD layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_WORLD, enabled) == 152, "M_HAPTICS_SET_ENABLED_WORLD layout changed");
+static_assert(sizeof(M_HAPTICS_SET_STIFFNESS) == 160, "M_HAPTICS_SET_STIFFNESS layout changed");
+static_assert(offsetof(M_HAPTICS_SET_STIFFNESS, header) == 0, "M_HAPTICS_SET_STIFFNESS layout changed");
+static_assert(offsetof(M_HAPTICS_SET_STIFFNESS, objectName) == 24, "M_HAPTICS_SET_STIFFNESS layout changed");
+static_assert(offsetof(M_HAPTICS_SET_STIFFNESS, stiffness) == 152, "M_HAPTICS_SET_STIFFNESS layout changed");
+static_assert(sizeof(M_HAPTICS_SET_ENABLED_BY_HANDLE) == 32, "M_HAPTICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_BY_HANDLE, header) == 0, "M_HAPTICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_BY_HANDLE, handle) == 24, "M_HAPTICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_BY_HANDLE, enabled) == 28, "M_HAPTICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(sizeof(M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE) == 32, "M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE, header) == 0, "M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE, handle) == 24, "M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE, enabled) == 28, "M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE layout changed");
+static_assert(sizeof(M_HAPTICS_SET_STIFFNESS_BY_HANDLE) == 40, "M_HAPTICS_SET_STIFFNESS_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_STIFFNESS_BY_HANDLE, header) == 0, "M_HAPTICS_SET_STIFFNESS_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_STIFFNESS_BY_HANDLE, handle) == 24, "M_HAPTICS_SET_STIFFNESS_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_SET_STIFFNESS_BY_HANDLE, stiffness) == 32, "M_HAPTICS_SET_STIFFNESS_BY_HANDLE layout changed");
+static_assert(sizeof(M_HAPTICS_BOUNDING_PLANE) == 40, "M_HAPTICS_BOUNDING_PLANE layout changed");
+static_assert(offsetof(M_HAPTICS_BOUNDING_PLANE, header) == 0, "M_HAPTICS_BOUNDING_PLANE layout changed");
+static_assert(offsetof(M_HAPTICS_BOUNDING_PLANE, bWidth) == 24, "M_HAPTICS_BOUNDING_PLANE layout changed");
+static_assert(offsetof(M_HAPTICS_BOUNDING_PLANE, bHeight) == 32, "M_HAPTICS_BOUNDING_PLANE layout changed");
+static_assert(sizeof(M_HAPTICS_CONSTANT_FORCE_FIELD) == 168, "M_HAPTICS_CONSTANT_FORCE_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_CONSTANT_FORCE_FIELD, header) == 0, "M_HAPTICS_CONSTANT_FORCE_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_CONSTANT_FORCE_FIELD, effectName) == 24, "M_HAPTICS_CONSTANT_FORCE_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_CONSTANT_FORCE_FIELD, direction) == 152, "M_HAPTICS_CONSTANT_FORCE_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_CONSTANT_FORCE_FIELD, magnitude) == 160, "M_HAPTICS_CONSTANT_FORCE_FIELD layout changed");
+static_assert(sizeof(M_HAPTICS_VISCOSITY_FIELD) == 224, "M_HAPTICS_VISCOSITY_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_VISCOSITY_FIELD, header) == 0, "M_HAPTICS_VISCOSITY_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_VISCOSITY_FIELD, effectName) == 24, "M_HAPTICS_VISCOSITY_FIELD layout changed");
+static_assert(offsetof(M_HAPTICS_VISCOSITY_FIELD, viscosityMatrix) == 152, "M_HAPTICS_VISCOSITY_FIELD layout changed");
+static_assert(sizeof(M_HAPTICS_FREEZE_EFFECT) == 152, "M_HAPTICS_FREEZE_EFFECT layout changed");
+static_assert(offsetof(M_HAPTICS_FREEZE_EFFECT, header) == 0, "M_HAPTICS_FREEZE_EFFECT layout changed");
+static_assert(offsetof(M_HAPTICS_FREEZE_EFFECT, effectName) == 24, "M_HAPTICS_FREEZE_EFFECT layout changed");
+static_assert(sizeof(M_HAPTICS_REMOVE_WORLD_EFFECT) == 152, "M_HAPTICS_REMOVE_WORLD_EFFECT layout changed");
+static_assert(offsetof(M_HAPTICS_REMOVE_WORLD_EFFECT, header) == 0, "M_HAPTICS_REMOVE_WORLD_EFFECT layout changed");
+static_assert(offsetof(M_HAPTICS_REMOVE_WORLD_EFFECT, effectName) == 24, "M_HAPTICS_REMOVE_WORLD_EFFECT layout changed");
+static_assert(sizeof(M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE) == 32, "M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE, header) == 0, "M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE layout changed");
+static_assert(offsetof(M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE, handle) == 24, "M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE layout changed");
+static_assert(sizeof(M_GRAPHICS_SET_ENABLED) == 160, "M_GRAPHICS_SET_ENABLED layout changed");
+static_assert(offsetof(M_GRAPHICS_SET_ENABLED, header) == 0, "M_GRAPHICS_SET_ENABLED layout changed");
+static_assert(offsetof(M_GRAPHICS_SET_ENABLED, objectName) == 24, "M_GRAPHICS_SET_ENABLED layout changed");
+static_assert(offsetof(M_GRAPHICS_SET_ENABLED, enabled) == 152, "M_GRAPHICS_SET_ENABLED layout changed");
+static_assert(sizeof(M_GRAPHICS_SET_ENABLED_BY_HANDLE) == 32, "M_GRAPHICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(offsetof(M_GRAPHICS_SET_ENABLED_BY_HANDLE, header) == 0, "M_GRAPHICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(offsetof(M_GRAPHICS_SET_ENABLED_BY_HANDLE, handle) == 24, "M_GRAPHICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(offsetof(M_GRAPHICS_SET_ENABLED_BY_HANDLE, enabled) == 28, "M_GRAPHICS_SET_ENABLED_BY_HANDLE layout changed");
+static_assert(sizeof(M_GRAPHICS_CHANGE_BG_COLOR) == 40, "M_GRAPHICS_CHANGE_BG_COLOR layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_BG_COLOR, header) == 0, "M_GRAPHICS_CHANGE_BG_COLOR layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_BG_COLOR, color) == 24, "M_GRAPHICS_CHANGE_BG_COLOR layout changed");
+static_assert(sizeof(M_GRAPHICS_PIPE) == 296, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, header) == 0, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, objectName) == 24, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, height) == 152, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, innerRadius) == 160, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, outerRadius) == 168, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, numSides) == 176, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, numHeightSegments) == 180, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, position) == 184, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, rotation) == 208, "M_GRAPHICS_PIPE layout changed");
+static_assert(offsetof(M_GRAPHICS_PIPE, color) == 280, "M_GRAPHICS_PIPE layout changed");
+static_assert(sizeof(M_GRAPHICS_ARROW) == 256, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, header) == 0, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, objectName) == 24, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, aLength) == 152, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, shaftRadius) == 160, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, lengthTip) == 168, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, radiusTip) == 176, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, bidirectional) == 184, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, numSides) == 188, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, direction) == 192, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, position) == 216, "M_GRAPHICS_ARROW layout changed");
+static_assert(offsetof(M_GRAPHICS_ARROW, color) == 240, "M_GRAPHICS_ARROW layout changed");
+static_assert(sizeof(M_GRAPHICS_CHANGE_OBJECT_COLOR) == 168, "M_GRAPHICS_CHANGE_OBJECT_COLOR layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_OBJECT_COLOR, header) == 0, "M_GRAPHICS_CHANGE_OBJECT_COLOR layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_OBJECT_COLOR, objectName) == 24, "M_GRAPHICS_CHANGE_OBJECT_COLOR layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_OBJECT_COLOR, color) == 152, "M_GRAPHICS_CHANGE_OBJECT_COLOR layout changed");
+static_assert(sizeof(M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE) == 48, "M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE, header) == 0, "M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE, handle) == 24, "M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE layout changed");
+static_assert(offsetof(M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE, color) == 28, "M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE layout changed");
+static_assert(sizeof(M_GRAPHICS_MOVING_DOTS) == 184, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(offsetof(M_GRAPHICS_MOVING_DOTS, header) == 0, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(offsetof(M_GRAPHICS_MOVING_DOTS, objectName) == 24, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(offsetof(M_GRAPHICS_MOVING_DOTS, numDots) == 152, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(offsetof(M_GRAPHICS_MOVING_DOTS, coherence) == 160, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(offsetof(M_GRAPHICS_MOVING_DOTS, direction) == 168, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(offsetof(M_GRAPHICS_MOVING_DOTS, magnitude) == 176, "M_GRAPHICS_MOVING_DOTS layout changed");
+static_assert(sizeof(M_GRAPHICS_SHAPE_BOX) == 216, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, header) == 0, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, objectName) == 24, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, sizeX) == 152, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, sizeY) == 160, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, sizeZ) == 168, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, localPosition) == 176, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_BOX, color) == 200, "M_GRAPHICS_SHAPE_BOX layout changed");
+static_assert(sizeof(M_GRAPHICS_SHAPE_SPHERE) == 200, "M_GRAPHICS_SHAPE_SPHERE layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_SPHERE, header) == 0, "M_GRAPHICS_SHAPE_SPHERE layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_SPHERE, objectName) == 24, "M_GRAPHICS_SHAPE_SPHERE layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_SPHERE, radius) == 152, "M_GRAPHICS_SHAPE_SPHERE layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_SPHERE, localPosition) == 160, "M_GRAPHICS_SHAPE_SPHERE layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_SPHERE, color) == 184, "M_GRAPHICS_SHAPE_SPHERE layout changed");
+static_assert(sizeof(M_GRAPHICS_SHAPE_TORUS) == 208, "M_GRAPHICS_SHAPE_TORUS layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_TORUS, header) == 0, "M_GRAPHICS_SHAPE_TORUS layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_TORUS, objectName) == 24, "M_GRAPHICS_SHAPE_TORUS layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_TORUS, innerRadius) == 152, "M_GRAPHICS_SHAPE_TORUS layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_TORUS, outerRadius) == 160, "M_GRAPHICS_SHAPE_TORUS layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_TORUS, localPosition) == 168, "M_GRAPHICS_SHAPE_TORUS layout changed");
+static_assert(offsetof(M_GRAPHICS_SHAPE_TORUS, color) == 192, "M_GRAPHICS_SHAPE_TORUS layout changed");
@@ -0,0 +1,200 @@
+# Generated by common/genMessages.py from common/messages.def, do not edit.
+"""
+Message type IDs and layouts for Python modules. MESSAGE_FORMATS gives the struct module format
+of each message type and the names of the values struct.unpack returns; arrays of numbers are
+returned as that many values in a row, strings as bytes.
+"""
+
+DEFAULT_IP = "localhost:10000"
+MAX_PACKET_LENGTH = 8192
+MAX_STRING_LENGTH = 128
+MAX_OBJECT_HANDLES = 65536
+MAX_STREAM_CONTACTS = 64
+MAX_FRAME_SAMPLES = 64
+
+# Test Packet
+TEST_PACKET = 9000
+
+# Experiment Control Messages 1-500 (not 0, which is sometimes parsed as a truncation signal)
+SESSION_START = 1
+SESSION_END = 2
+TRIAL_START = 3
+TRIAL_END = 4
+START_RECORDING = 5
+STOP_RECORDING = 6
+REMOVE_OBJECT = 7
+KEYPRESS = 8
+PAUSE_RECORDING = 9
+RESUME_RECORDING = 10
+RESET_WORLD = 11
+OBJECT_HANDLE_REGISTER = 12
+REMOVE_OBJECT_BY_HANDLE = 13
+STREAM_FORMAT = 14
+SCENE_BEGIN = 15
+SCENE_COMMIT = 16
+OBJECT_READY = 17
+MODULE_READY = 18
+
+# Combined/Complex Object Messages 500-1000
+CST_CREATE = 500
+CST_DESTRUCT = 501
+CST_START = 502
+CST_STOP = 503
+CST_SET_VISUAL = 504
+CST_SET_HAPTIC = 505
+CST_SET_LAMBDA = 506
+CST_DATA = 507
+CUPS_CREATE = 508
+CUPS_DESTRUCT = 509
+CUPS_START = 510
+CUPS_STOP = 511
+CUPS_DATA = 512
+
+# Haptics Messages 1000-2000
+HAPTIC_DATA_STREAM = 1000
+HAPTICS_SET_ENABLED = 1001
+HAPTICS_SET_ENABLED_WORLD = 1002
+HAPTIC_DATA_STREAM_V2 = 1003
+HAPTIC_DATA_FRAME = 1004
+HAPTICS_SET_STIFFNESS = 1008
+HAPTICS_BOUNDING_PLANE = 1009
+HAPTICS_CONSTANT_FORCE_FIELD = 1010
+HAPTICS_VISCOSITY_FIELD = 1011
+HAPTICS_FREEZE_EFFECT = 1012
+HAPTICS_REMOVE_WORLD_EFFECT = 1013
+HAPTICS_SET_ENABLED_BY_HANDLE = 1014
+HAPTICS_SET_ENABLED_WORLD_BY_HANDLE = 1015
+HAPTICS_SET_STIFFNESS_BY_HANDLE = 1016
+HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE = 1017
+
+# Graphics Messages are 2000-3000
+GRAPHICS_SET_ENABLED = 2000
+GRAPHICS_CHANGE_BG_COLOR = 2001
+GRAPHICS_PIPE = 2002
+GRAPHICS_ARROW = 2003
+GRAPHICS_CHANGE_OBJECT_COLOR = 2004
+GRAPHICS_SET_ENABLED_BY_HANDLE = 2005
+GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE = 2006
+GRAPHICS_MOVING_DOTS = 2014
+GRAPHICS_SHAPE_BOX = 2046
+GRAPHICS_SHAPE_SPHERE = 2050
+GRAPHICS_SHAPE_TORUS = 2051
+
+MESSAGE_FORMATS = {
+  SESSION_START: ('M_SESSION_START', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  SESSION_END: ('M_SESSION_END', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  TRIAL_START: ('M_TRIAL_START', '<iiddi4x', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'trialNum']),
+  TRIAL_END: ('M_TRIAL_END', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  START_RECORDING: ('M_START_RECORDING', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'filename']),
+  STOP_RECORDING: ('M_STOP_RECORDING', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  REMOVE_OBJECT: ('M_REMOVE_OBJECT', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName']),
+  KEYPRESS: ('M_KEYPRESS', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'keyname']),
+  PAUSE_RECORDING: ('M_PAUSE_RECORDING', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  RESUME_RECORDING: ('M_RESUME_RECORDING', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  RESET_WORLD: ('M_RESET_WORLD', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  OBJECT_HANDLE_REGISTER: ('M_OBJECT_HANDLE_REGISTER', '<iiddi128s4x', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle', 'objectName']),
+  REMOVE_OBJECT_BY_HANDLE: ('M_REMOVE_OBJECT_BY_HANDLE', '<iiddi4x', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle']),
+  STREAM_FORMAT: ('M_STREAM_FORMAT', '<iiddiii4x', 40,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'version', 'frameSamples', 'frameMicros']),
+  SCENE_BEGIN: ('M_SCENE_BEGIN', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  SCENE_COMMIT: ('M_SCENE_COMMIT', '<iidd', 24,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp']),
+  OBJECT_READY: ('M_OBJECT_READY', '<iiddiidd128s', 176,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'msgType', 'serialNo', 'buildSeconds', 'readySeconds', 'objectName']),
+  MODULE_READY: ('M_MODULE_READY', '<iiddi4x', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'moduleID']),
+  CST_CREATE: ('M_CST_CREATE', '<iidd128sddii', 176,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName', 'lambdaVal', 'forceMagnitude', 'visionEnabled', 'hapticEnabled']),
+  CST_DESTRUCT: ('M_CST_DESTRUCT', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName']),
+  CST_START: ('M_CST_START', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName']),
+  CST_STOP: ('M_CST_STOP', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName']),
+  CST_SET_VISUAL: ('M_CST_SET_VISUAL', '<iidd128si4x', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName', 'visionEnabled']),
+  CST_SET_HAPTIC: ('M_CST_SET_HAPTIC', '<iidd128si4x', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName', 'hapticEnabled']),
+  CST_SET_LAMBDA: ('M_CST_SET_LAMBDA', '<iidd128sd', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cstName', 'lambdaVal']),
+  CST_DATA: ('M_CST_DATA', '<iiddddd', 48,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cursorX', 'cursorY', 'cursorZ']),
+  CUPS_CREATE: ('M_CUPS_CREATE', '<iidd128sdddd', 184,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cupsName', 'escapeAngle', 'pendulumLength', 'ballMass', 'cartMass']),
+  CUPS_DESTRUCT: ('M_CUPS_DESTRUCT', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cupsName']),
+  CUPS_START: ('M_CUPS_START', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cupsName']),
+  CUPS_STOP: ('M_CUPS_STOP', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'cupsName']),
+  CUPS_DATA: ('M_CUPS_DATA', '<iidddd', 40,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'ballPos', 'cartPos']),
+  HAPTIC_DATA_STREAM: ('M_HAPTIC_DATA_STREAM', '<iiddddddddddd128s128s128s128s', 608,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'posX', 'posY', 'posZ', 'velX', 'velY', 'velZ', 'forceX', 'forceY', 'forceZ', 'collisions[0]', 'collisions[1]', 'collisions[2]', 'collisions[3]']),
+  HAPTICS_SET_ENABLED: ('M_HAPTICS_SET_ENABLED', '<iidd128si4x', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'enabled']),
+  HAPTICS_SET_ENABLED_WORLD: ('M_HAPTICS_SET_ENABLED_WORLD', '<iidd128si4x', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'effectName', 'enabled']),
+  HAPTIC_DATA_STREAM_V2: ('M_HAPTIC_DATA_STREAM_V2', '<iiddIHH3f3f3f64i4x', 328,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'deviceTick', 'numContacts', 'unnamedContacts', 'pos', 'vel', 'force', 'contacts']),
+  HAPTIC_DATA_FRAME: ('M_HAPTIC_DATA_FRAME', '<iiddHHIIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3fIf3f3f3f', 2848,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'numSamples', 'reserved', 'reserved2', 'samples[0].deviceTick', 'samples[0].timeOffset', 'samples[0].pos', 'samples[0].vel', 'samples[0].force', 'samples[1].deviceTick', 'samples[1].timeOffset', 'samples[1].pos', 'samples[1].vel', 'samples[1].force', 'samples[2].deviceTick', 'samples[2].timeOffset', 'samples[2].pos', 'samples[2].vel', 'samples[2].force', 'samples[3].deviceTick', 'samples[3].timeOffset', 'samples[3].pos', 'samples[3].vel', 'samples[3].force', 'samples[4].deviceTick', 'samples[4].timeOffset', 'samples[4].pos', 'samples[4].vel', 'samples[4].force', 'samples[5].deviceTick', 'samples[5].timeOffset', 'samples[5].pos', 'samples[5].vel', 'samples[5].force', 'samples[6].deviceTick', 'samples[6].timeOffset', 'samples[6].pos', 'samples[6].vel', 'samples[6].force', 'samples[7].deviceTick', 'samples[7].timeOffset', 'samples[7].pos', 'samples[7].vel', 'samples[7].force', 'samples[8].deviceTick', 'samples[8].timeOffset', 'samples[8].pos', 'samples[8].vel', 'samples[8].force', 'samples[9].deviceTick', 'samples[9].timeOffset', 'samples[9].pos', 'samples[9].vel', 'samples[9].force', 'samples[10].deviceTick', 'samples[10].timeOffset', 'samples[10].pos', 'samples[10].vel', 'samples[10].force', 'samples[11].deviceTick', 'samples[11].timeOffset', 'samples[11].pos', 'samples[11].vel', 'samples[11].force', 'samples[12].deviceTick', 'samples[12].timeOffset', 'samples[12].pos', 'samples[12].vel', 'samples[12].force', 'samples[13].deviceTick', 'samples[13].timeOffset', 'samples[13].pos', 'samples[13].vel', 'samples[13].force', 'samples[14].deviceTick', 'samples[14].timeOffset', 'samples[14].pos', 'samples[14].vel', 'samples[14].force', 'samples[15].deviceTick', 'samples[15].timeOffset', 'samples[15].pos', 'samples[15].vel', 'samples[15].force', 'samples[16].deviceTick', 'samples[16].timeOffset', 'samples[16].pos', 'samples[16].vel', 'samples[16].force', 'samples[17].deviceTick', 'samples[17].timeOffset', 'samples[17].pos', 'samples[17].vel', 'samples[17].force', 'samples[18].deviceTick', 'samples[18].timeOffset', 'samples[18].pos', 'samples[18].vel', 'samples[18].force', 'samples[19].deviceTick', 'samples[19].timeOffset', 'samples[19].pos', 'samples[19].vel', 'samples[19].force', 'samples[20].deviceTick', 'samples[20].timeOffset', 'samples[20].pos', 'samples[20].vel', 'samples[20].force', 'samples[21].deviceTick', 'samples[21].timeOffset', 'samples[21].pos', 'samples[21].vel', 'samples[21].force', 'samples[22].deviceTick', 'samples[22].timeOffset', 'samples[22].pos', 'samples[22].vel', 'samples[22].force', 'samples[23].deviceTick', 'samples[23].timeOffset', 'samples[23].pos', 'samples[23].vel', 'samples[23].force', 'samples[24].deviceTick', 'samples[24].timeOffset', 'samples[24].pos', 'samples[24].vel', 'samples[24].force', 'samples[25].deviceTick', 'samples[25].timeOffset', 'samples[25].pos', 'samples[25].vel', 'samples[25].force', 'samples[26].deviceTick', 'samples[26].timeOffset', 'samples[26].pos', 'samples[26].vel', 'samples[26].force', 'samples[27].deviceTick', 'samples[27].timeOffset', 'samples[27].pos', 'samples[27].vel', 'samples[27].force', 'samples[28].deviceTick', 'samples[28].timeOffset', 'samples[28].pos', 'samples[28].vel', 'samples[28].force', 'samples[29].deviceTick', 'samples[29].timeOffset', 'samples[29].pos', 'samples[29].vel', 'samples[29].force', 'samples[30].deviceTick', 'samples[30].timeOffset', 'samples[30].pos', 'samples[30].vel', 'samples[30].force', 'samples[31].deviceTick', 'samples[31].timeOffset', 'samples[31].pos', 'samples[31].vel', 'samples[31].force', 'samples[32].deviceTick', 'samples[32].timeOffset', 'samples[32].pos', 'samples[32].vel', 'samples[32].force', 'samples[33].deviceTick', 'samples[33].timeOffset', 'samples[33].pos', 'samples[33].vel', 'samples[33].force', 'samples[34].deviceTick', 'samples[34].timeOffset', 'samples[34].pos', 'samples[34].vel', 'samples[34].force', 'samples[35].deviceTick', 'samples[35].timeOffset', 'samples[35].pos', 'samples[35].vel', 'samples[35].force', 'samples[36].deviceTick', 'samples[36].timeOffset', 'samples[36].pos', 'samples[36].vel', 'samples[36].force', 'samples[37].deviceTick', 'samples[37].timeOffset', 'samples[37].pos', 'samples[37].vel', 'samples[37].force', 'samples[38].deviceTick', 'samples[38].timeOffset', 'samples[38].pos', 'samples[38].vel', 'samples[38].force', 'samples[39].deviceTick', 'samples[39].timeOffset', 'samples[39].pos', 'samples[39].vel', 'samples[39].force', 'samples[40].deviceTick', 'samples[40].timeOffset', 'samples[40].pos', 'samples[40].vel', 'samples[40].force', 'samples[41].deviceTick', 'samples[41].timeOffset', 'samples[41].pos', 'samples[41].vel', 'samples[41].force', 'samples[42].deviceTick', 'samples[42].timeOffset', 'samples[42].pos', 'samples[42].vel', 'samples[42].force', 'samples[43].deviceTick', 'samples[43].timeOffset', 'samples[43].pos', 'samples[43].vel', 'samples[43].force', 'samples[44].deviceTick', 'samples[44].timeOffset', 'samples[44].pos', 'samples[44].vel', 'samples[44].force', 'samples[45].deviceTick', 'samples[45].timeOffset', 'samples[45].pos', 'samples[45].vel', 'samples[45].force', 'samples[46].deviceTick', 'samples[46].timeOffset', 'samples[46].pos', 'samples[46].vel', 'samples[46].force', 'samples[47].deviceTick', 'samples[47].timeOffset', 'samples[47].pos', 'samples[47].vel', 'samples[47].force', 'samples[48].deviceTick', 'samples[48].timeOffset', 'samples[48].pos', 'samples[48].vel', 'samples[48].force', 'samples[49].deviceTick', 'samples[49].timeOffset', 'samples[49].pos', 'samples[49].vel', 'samples[49].force', 'samples[50].deviceTick', 'samples[50].timeOffset', 'samples[50].pos', 'samples[50].vel', 'samples[50].force', 'samples[51].deviceTick', 'samples[51].timeOffset', 'samples[51].pos', 'samples[51].vel', 'samples[51].force', 'samples[52].deviceTick', 'samples[52].timeOffset', 'samples[52].pos', 'samples[52].vel', 'samples[52].force', 'samples[53].deviceTick', 'samples[53].timeOffset', 'samples[53].pos', 'samples[53].vel', 'samples[53].force', 'samples[54].deviceTick', 'samples[54].timeOffset', 'samples[54].pos', 'samples[54].vel', 'samples[54].force', 'samples[55].deviceTick', 'samples[55].timeOffset', 'samples[55].pos', 'samples[55].vel', 'samples[55].force', 'samples[56].deviceTick', 'samples[56].timeOffset', 'samples[56].pos', 'samples[56].vel', 'samples[56].force', 'samples[57].deviceTick', 'samples[57].timeOffset', 'samples[57].pos', 'samples[57].vel', 'samples[57].force', 'samples[58].deviceTick', 'samples[58].timeOffset', 'samples[58].pos', 'samples[58].vel', 'samples[58].force', 'samples[59].deviceTick', 'samples[59].timeOffset', 'samples[59].pos', 'samples[59].vel', 'samples[59].force', 'samples[60].deviceTick', 'samples[60].timeOffset', 'samples[60].pos', 'samples[60].vel', 'samples[60].force', 'samples[61].deviceTick', 'samples[61].timeOffset', 'samples[61].pos', 'samples[61].vel', 'samples[61].force', 'samples[62].deviceTick', 'samples[62].timeOffset', 'samples[62].pos', 'samples[62].vel', 'samples[62].force', 'samples[63].deviceTick', 'samples[63].timeOffset', 'samples[63].pos', 'samples[63].vel', 'samples[63].force']),
+  HAPTICS_SET_STIFFNESS: ('M_HAPTICS_SET_STIFFNESS', '<iidd128sd', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'stiffness']),
+  HAPTICS_BOUNDING_PLANE: ('M_HAPTICS_BOUNDING_PLANE', '<iidddd', 40,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'bWidth', 'bHeight']),
+  HAPTICS_CONSTANT_FORCE_FIELD: ('M_HAPTICS_CONSTANT_FORCE_FIELD', '<iidd128sdd', 168,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'effectName', 'direction', 'magnitude']),
+  HAPTICS_VISCOSITY_FIELD: ('M_HAPTICS_VISCOSITY_FIELD', '<iidd128s9d', 224,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'effectName', 'viscosityMatrix']),
+  HAPTICS_FREEZE_EFFECT: ('M_HAPTICS_FREEZE_EFFECT', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'effectName']),
+  HAPTICS_REMOVE_WORLD_EFFECT: ('M_HAPTICS_REMOVE_WORLD_EFFECT', '<iidd128s', 152,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'effectName']),
+  HAPTICS_SET_ENABLED_BY_HANDLE: ('M_HAPTICS_SET_ENABLED_BY_HANDLE', '<iiddii', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle', 'enabled']),
+  HAPTICS_SET_ENABLED_WORLD_BY_HANDLE: ('M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE', '<iiddii', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle', 'enabled']),
+  HAPTICS_SET_STIFFNESS_BY_HANDLE: ('M_HAPTICS_SET_STIFFNESS_BY_HANDLE', '<iiddi4xd', 40,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle', 'stiffness']),
+  HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE: ('M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE', '<iiddi4x', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle']),
+  GRAPHICS_SET_ENABLED: ('M_GRAPHICS_SET_ENABLED', '<iidd128si4x', 160,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'enabled']),
+  GRAPHICS_CHANGE_BG_COLOR: ('M_GRAPHICS_CHANGE_BG_COLOR', '<iidd4f', 40,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'color']),
+  GRAPHICS_PIPE: ('M_GRAPHICS_PIPE', '<iidd128sdddII3d9d4f', 296,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'height', 'innerRadius', 'outerRadius', 'numSides', 'numHeightSegments', 'position', 'rotation', 'color']),
+  GRAPHICS_ARROW: ('M_GRAPHICS_ARROW', '<iidd128sddddiI3d3d4f', 256,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'aLength', 'shaftRadius', 'lengthTip', 'radiusTip', 'bidirectional', 'numSides', 'direction', 'position', 'color']),
+  GRAPHICS_CHANGE_OBJECT_COLOR: ('M_GRAPHICS_CHANGE_OBJECT_COLOR', '<iidd128s4f', 168,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'color']),
+  GRAPHICS_SET_ENABLED_BY_HANDLE: ('M_GRAPHICS_SET_ENABLED_BY_HANDLE', '<iiddii', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle', 'enabled']),
+  GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE: ('M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE', '<iiddi4f4x', 48,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'handle', 'color']),
+  GRAPHICS_MOVING_DOTS: ('M_GRAPHICS_MOVING_DOTS', '<iidd128si4xddd', 184,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'numDots', 'coherence', 'direction', 'magnitude']),
+  GRAPHICS_SHAPE_BOX: ('M_GRAPHICS_SHAPE_BOX', '<iidd128sddd3d4f', 216,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'sizeX', 'sizeY', 'sizeZ', 'localPosition', 'color']),
+  GRAPHICS_SHAPE_SPHERE: ('M_GRAPHICS_SHAPE_SPHERE', '<iidd128sd3d4f', 200,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'radius', 'localPosition', 'color']),
+  GRAPHICS_SHAPE_TORUS: ('M_GRAPHICS_SHAPE_TORUS', '<iidd128sdd3d4f', 208,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'objectName', 'innerRadius', 'outerRadius', 'localPosition', 'color']),
+  TEST_PACKET: ('M_TEST_PACKET', '<iiddii', 32,
+    ['header.serial_no', 'header.msg_type', 'header.reserved', 'header.timestamp', 'a', 'b']),
+}
@@ -0,0 +1,1039 @@
+// Generated by common/genMessages.py from common/messages.def, do not edit.
+#pragma once
+
+#ifndef _MESSAGEDISPATCH_H_
+#define _MESSAGEDISPATCH_H_
+
+#include <string.h>
+#include "messageDefinitions.h"
+
+/**
+ * @file messageDispatch.h
+ * @brief Message type table, zero-copy views and dispatch.
+ *
+ * The message structs are packed, so a view is just the packet cast to the struct, after
+ * checking its type and length. dispatchMessage calls visitor(message, length) with the view of
+ * a packet of any known type.
+ */
+
+typedef struct {
+  int type;
+  const char* name;
+  int size; /**< sizeof the struct */
+  int minSize; /**< Shortest valid packet, less than size for messages with a variable-length array */
+} MESSAGE_INFO;
+
+#define NUM_MESSAGE_TYPES 58
+
+/** All message types, sorted by type */
+static const MESSAGE_INFO MESSAGE_TABLE[NUM_MESSAGE_TYPES] = {
+  {SESSION_START, "SESSION_START", sizeof(M_SESSION_START), 24},
+  {SESSION_END, "SESSION_END", sizeof(M_SESSION_END), 24},
+  {TRIAL_START, "TRIAL_START", sizeof(M_TRIAL_START), 32},
+  {TRIAL_END, "TRIAL_END", sizeof(M_TRIAL_END), 24},
+  {START_RECORDING, "START_RECORDING", sizeof(M_START_RECORDING), 152},
+  {STOP_RECORDING, "STOP_RECORDING", sizeof(M_STOP_RECORDING), 24},
+  {REMOVE_OBJECT, "REMOVE_OBJECT", sizeof(M_REMOVE_OBJECT), 152},
+  {KEYPRESS, "KEYPRESS", sizeof(M_KEYPRESS), 152},
+  {PAUSE_RECORDING, "PAUSE_RECORDING", sizeof(M_PAUSE_RECORDING), 24},
+  {RESUME_RECORDING, "RESUME_RECORDING", sizeof(M_RESUME_RECORDING), 24},
+  {RESET_WORLD, "RESET_WORLD", sizeof(M_RESET_WORLD), 24},
+  {OBJECT_HANDLE_REGISTER, "OBJECT_HANDLE_REGISTER", sizeof(M_OBJECT_HANDLE_REGISTER), 160},
+  {REMOVE_OBJECT_BY_HANDLE, "REMOVE_OBJECT_BY_HANDLE", sizeof(M_REMOVE_OBJECT_BY_HANDLE), 32},
+  {STREAM_FORMAT, "STREAM_FORMAT", sizeof(M_STREAM_FORMAT), 40},
+  {SCENE_BEGIN, "SCENE_BEGIN", sizeof(M_SCENE_BEGIN), 24},
+  {SCENE_COMMIT, "SCENE_COMMIT", sizeof(M_SCENE_COMMIT), 24},
+  {OBJECT_READY, "OBJECT_READY", sizeof(M_OBJECT_READY), 176},
+  {MODULE_READY, "MODULE_READY", sizeof(M_MODULE_READY), 32},
+  {CST_CREATE, "CST_CREATE", sizeof(M_CST_CREATE), 176},
+  {CST_DESTRUCT, "CST_DESTRUCT", sizeof(M_CST_DESTRUCT), 152},
+  {CST_START, "CST_START", sizeof(M_CST_START), 152},
+  {CST_STOP, "CST_STOP", sizeof(M_CST_STOP), 152},
+  {CST_SET_VISUAL, "CST_SET_VISUAL", sizeof(M_CST_SET_VISUAL), 160},
+  {CST_SET_HAPTIC, "CST_SET_HAPTIC", sizeof(M_CST_SET_HAPTIC), 160},
+  {CST_SET_LAMBDA, "CST_SET_LAMBDA", sizeof(M_CST_SET_LAMBDA), 160},
+  {CST_DATA, "CST_DATA", sizeof(M_CST_DATA), 48},
+  {CUPS_CREATE, "CUPS_CREATE", sizeof(M_CUPS_CREATE), 184},
+  {CUPS_DESTRUCT, "CUPS_DESTRUCT", sizeof(M_CUPS_DESTRUCT), 152},
+  {CUPS_START, "CUPS_START", sizeof(M_CUPS_START), 152},
+  {CUPS_STOP, "CUPS_STOP", sizeof(M_CUPS_STOP), 152},
+  {CUPS_DATA, "CUPS_DATA", sizeof(M_CUPS_DATA), 40},
+  {HAPTIC_DATA_STREAM, "HAPTIC_DATA_STREAM", sizeof(M_HAPTIC_DATA_STREAM), 608},
+  {HAPTICS_SET_ENABLED, "HAPTICS_SET_ENABLED", sizeof(M_HAPTICS_SET_ENABLED), 160},
+  {HAPTICS_SET_ENABLED_WORLD, "HAPTICS_SET_ENABLED_WORLD", sizeof(M_HAPTICS_SET_ENABLED_WORLD), 160},
+  {HAPTIC_DATA_STREAM_V2, "HAPTIC_DATA_STREAM_V2", sizeof(M_HAPTIC_DATA_STREAM_V2), 68},
+  {HAPTIC_DATA_FRAME, "HAPTIC_DATA_FRAME", sizeof(M_HAPTIC_DATA_FRAME), 32},
+  {HAPTICS_SET_STIFFNESS, "HAPTICS_SET_STIFFNESS", sizeof(M_HAPTICS_SET_STIFFNESS), 160},
+  {HAPTICS_BOUNDING_PLANE, "HAPTICS_BOUNDING_PLANE", sizeof(M_HAPTICS_BOUNDING_PLANE), 40},
+  {HAPTICS_CONSTANT_FORCE_FIELD, "HAPTICS_CONSTANT_FORCE_FIELD", sizeof(M_HAPTICS_CONSTANT_FORCE_FIELD), 168},
+  {HAPTICS_VISCOSITY_FIELD, "HAPTICS_VISCOSITY_FIELD", sizeof(M_HAPTICS_VISCOSITY_FIELD), 224},
+  {HAPTICS_FREEZE_EFFECT, "HAPTICS_FREEZE_EFFECT", sizeof(M_HAPTICS_FREEZE_EFFECT), 152},
+  {HAPTICS_REMOVE_WORLD_EFFECT, "HAPTICS_REMOVE_WORLD_EFFECT", sizeof(M_HAPTICS_REMOVE_WORLD_EFFECT), 152},
+  {HAPTICS_SET_ENABLED_BY_HANDLE, "HAPTICS_SET_ENABLED_BY_HANDLE", sizeof(M_HAPTICS_SET_ENABLED_BY_HANDLE), 32},
+  {HAPTICS_SET_ENABLED_WORLD_BY_HANDLE, "HAPTICS_SET_ENABLED_WORLD_BY_HANDLE", sizeof(M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE), 32},
+  {HAPTICS_SET_STIFFNESS_BY_HANDLE, "HAPTICS_SET_STIFFNESS_BY_HANDLE", sizeof(M_HAPTICS_SET_STIFFNESS_BY_HANDLE), 40},
+  {HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE, "HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE", sizeof(M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE), 32},
+  {GRAPHICS_SET_ENABLED, "GRAPHICS_SET_ENABLED", sizeof(M_GRAPHICS_SET_ENABLED), 160},
+  {GRAPHICS_CHANGE_BG_COLOR, "GRAPHICS_CHANGE_BG_COLOR", sizeof(M_GRAPHICS_CHANGE_BG_COLOR), 40},
+  {GRAPHICS_PIPE, "GRAPHICS_PIPE", sizeof(M_GRAPHICS_PIPE), 296},
+  {GRAPHICS_ARROW, "GRAPHICS_ARROW", sizeof(M_GRAPHICS_ARROW), 256},
+  {GRAPHICS_CHANGE_OBJECT_COLOR, "GRAPHICS_CHANGE_OBJECT_COLOR", sizeof(M_GRAPHICS_CHANGE_OBJECT_COLOR), 168},
+  {GRAPHICS_SET_ENABLED_BY_HANDLE, "GRAPHICS_SET_ENABLED_BY_HANDLE", sizeof(M_GRAPHICS_SET_ENABLED_BY_HANDLE), 32},
+  {GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE, "GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE", sizeof(M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE), 48},
+  {GRAPHICS_MOVING_DOTS, "GRAPHICS_MOVING_DOTS", sizeof(M_GRAPHICS_MOVING_DOTS), 184},
+  {GRAPHICS_SHAPE_BOX, "GRAPHICS_SHAPE_BOX", sizeof(M_GRAPHICS_SHAPE_BOX), 216},
+  {GRAPHICS_SHAPE_SPHERE, "GRAPHICS_SHAPE_SPHERE", sizeof(M_GRAPHICS_SHAPE_SPHERE), 200},
+  {GRAPHICS_SHAPE_TORUS, "GRAPHICS_SHAPE_TORUS", sizeof(M_GRAPHICS_SHAPE_TORUS), 208},
+  {TEST_PACKET, "TEST_PACKET", sizeof(M_TEST_PACKET), 32},
+};
+
+/**
+ * @return Table entry of a message type, NULL if the type is unknown
+ */
+inline const MESSAGE_INFO* findMessageInfo(int type)
+{
+  int low = 0;
+  int high = NUM_MESSAGE_TYPES;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (MESSAGE_TABLE[mid].type < type) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return (low < NUM_MESSAGE_TYPES && MESSAGE_TABLE[low].type == type) ? &MESSAGE_TABLE[low] : NULL;
+}
+
+inline const char* messageName(int type)
+{
+  const MESSAGE_INFO* info = findMessageInfo(type);
+  return (info == NULL) ? "UNKNOWN" : info->name;
+}
+
+/**
+ * Message type of a packet, -1 if it is too short to have a MSG_HEADER.
+ */
+inline int packetMsgType(const char* packet, int length)
+{
+  if (length < (int) sizeof(MSG_HEADER)) {
+    return -1;
+  }
+  int msgType;
+  memcpy(&msgType, packet + offsetof(MSG_HEADER, msg_type), sizeof(msgType));
+  return msgType;
+}
+
+/**
+ * Message type and packet checks of each message struct. complete() checks that a packet is
+ * long enough for the entries its variable-length array says it has.
+ */
+template<typename T> struct MessageTraits;
+
+template<> struct MessageTraits<M_SESSION_START>
+{
+  enum { type = SESSION_START, minSize = 24 };
+  static bool complete(const M_SESSION_START*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_SESSION_END>
+{
+  enum { type = SESSION_END, minSize = 24 };
+  static bool complete(const M_SESSION_END*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_TRIAL_START>
+{
+  enum { type = TRIAL_START, minSize = 32 };
+  static bool complete(const M_TRIAL_START*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_TRIAL_END>
+{
+  enum { type = TRIAL_END, minSize = 24 };
+  static bool complete(const M_TRIAL_END*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_START_RECORDING>
+{
+  enum { type = START_RECORDING, minSize = 152 };
+  static bool complete(const M_START_RECORDING*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_STOP_RECORDING>
+{
+  enum { type = STOP_RECORDING, minSize = 24 };
+  static bool complete(const M_STOP_RECORDING*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_REMOVE_OBJECT>
+{
+  enum { type = REMOVE_OBJECT, minSize = 152 };
+  static bool complete(const M_REMOVE_OBJECT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_KEYPRESS>
+{
+  enum { type = KEYPRESS, minSize = 152 };
+  static bool complete(const M_KEYPRESS*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_PAUSE_RECORDING>
+{
+  enum { type = PAUSE_RECORDING, minSize = 24 };
+  static bool complete(const M_PAUSE_RECORDING*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_RESUME_RECORDING>
+{
+  enum { type = RESUME_RECORDING, minSize = 24 };
+  static bool complete(const M_RESUME_RECORDING*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_RESET_WORLD>
+{
+  enum { type = RESET_WORLD, minSize = 24 };
+  static bool complete(const M_RESET_WORLD*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_OBJECT_HANDLE_REGISTER>
+{
+  enum { type = OBJECT_HANDLE_REGISTER, minSize = 160 };
+  static bool complete(const M_OBJECT_HANDLE_REGISTER*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_REMOVE_OBJECT_BY_HANDLE>
+{
+  enum { type = REMOVE_OBJECT_BY_HANDLE, minSize = 32 };
+  static bool complete(const M_REMOVE_OBJECT_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_STREAM_FORMAT>
+{
+  enum { type = STREAM_FORMAT, minSize = 40 };
+  static bool complete(const M_STREAM_FORMAT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_SCENE_BEGIN>
+{
+  enum { type = SCENE_BEGIN, minSize = 24 };
+  static bool complete(const M_SCENE_BEGIN*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_SCENE_COMMIT>
+{
+  enum { type = SCENE_COMMIT, minSize = 24 };
+  static bool complete(const M_SCENE_COMMIT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_OBJECT_READY>
+{
+  enum { type = OBJECT_READY, minSize = 176 };
+  static bool complete(const M_OBJECT_READY*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_MODULE_READY>
+{
+  enum { type = MODULE_READY, minSize = 32 };
+  static bool complete(const M_MODULE_READY*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_CREATE>
+{
+  enum { type = CST_CREATE, minSize = 176 };
+  static bool complete(const M_CST_CREATE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_DESTRUCT>
+{
+  enum { type = CST_DESTRUCT, minSize = 152 };
+  static bool complete(const M_CST_DESTRUCT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_START>
+{
+  enum { type = CST_START, minSize = 152 };
+  static bool complete(const M_CST_START*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_STOP>
+{
+  enum { type = CST_STOP, minSize = 152 };
+  static bool complete(const M_CST_STOP*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_SET_VISUAL>
+{
+  enum { type = CST_SET_VISUAL, minSize = 160 };
+  static bool complete(const M_CST_SET_VISUAL*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_SET_HAPTIC>
+{
+  enum { type = CST_SET_HAPTIC, minSize = 160 };
+  static bool complete(const M_CST_SET_HAPTIC*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_SET_LAMBDA>
+{
+  enum { type = CST_SET_LAMBDA, minSize = 160 };
+  static bool complete(const M_CST_SET_LAMBDA*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CST_DATA>
+{
+  enum { type = CST_DATA, minSize = 48 };
+  static bool complete(const M_CST_DATA*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CUPS_CREATE>
+{
+  enum { type = CUPS_CREATE, minSize = 184 };
+  static bool complete(const M_CUPS_CREATE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CUPS_DESTRUCT>
+{
+  enum { type = CUPS_DESTRUCT, minSize = 152 };
+  static bool complete(const M_CUPS_DESTRUCT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CUPS_START>
+{
+  enum { type = CUPS_START, minSize = 152 };
+  static bool complete(const M_CUPS_START*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CUPS_STOP>
+{
+  enum { type = CUPS_STOP, minSize = 152 };
+  static bool complete(const M_CUPS_STOP*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_CUPS_DATA>
+{
+  enum { type = CUPS_DATA, minSize = 40 };
+  static bool complete(const M_CUPS_DATA*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTIC_DATA_STREAM>
+{
+  enum { type = HAPTIC_DATA_STREAM, minSize = 608 };
+  static bool complete(const M_HAPTIC_DATA_STREAM*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_SET_ENABLED>
+{
+  enum { type = HAPTICS_SET_ENABLED, minSize = 160 };
+  static bool complete(const M_HAPTICS_SET_ENABLED*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_SET_ENABLED_WORLD>
+{
+  enum { type = HAPTICS_SET_ENABLED_WORLD, minSize = 160 };
+  static bool complete(const M_HAPTICS_SET_ENABLED_WORLD*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTIC_DATA_STREAM_V2>
+{
+  enum { type = HAPTIC_DATA_STREAM_V2, minSize = 68 };
+  static bool complete(const M_HAPTIC_DATA_STREAM_V2* message, int length)
+  {
+    return message->numContacts <= MAX_STREAM_CONTACTS && length >= (int) HAPTIC_STREAM_V2_SIZE(message->numContacts);
+  }
+};
+
+template<> struct MessageTraits<M_HAPTIC_DATA_FRAME>
+{
+  enum { type = HAPTIC_DATA_FRAME, minSize = 32 };
+  static bool complete(const M_HAPTIC_DATA_FRAME* message, int length)
+  {
+    return message->numSamples <= MAX_FRAME_SAMPLES && length >= (int) HAPTIC_FRAME_SIZE(message->numSamples);
+  }
+};
+
+template<> struct MessageTraits<M_HAPTICS_SET_STIFFNESS>
+{
+  enum { type = HAPTICS_SET_STIFFNESS, minSize = 160 };
+  static bool complete(const M_HAPTICS_SET_STIFFNESS*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_BOUNDING_PLANE>
+{
+  enum { type = HAPTICS_BOUNDING_PLANE, minSize = 40 };
+  static bool complete(const M_HAPTICS_BOUNDING_PLANE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_CONSTANT_FORCE_FIELD>
+{
+  enum { type = HAPTICS_CONSTANT_FORCE_FIELD, minSize = 168 };
+  static bool complete(const M_HAPTICS_CONSTANT_FORCE_FIELD*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_VISCOSITY_FIELD>
+{
+  enum { type = HAPTICS_VISCOSITY_FIELD, minSize = 224 };
+  static bool complete(const M_HAPTICS_VISCOSITY_FIELD*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_FREEZE_EFFECT>
+{
+  enum { type = HAPTICS_FREEZE_EFFECT, minSize = 152 };
+  static bool complete(const M_HAPTICS_FREEZE_EFFECT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_REMOVE_WORLD_EFFECT>
+{
+  enum { type = HAPTICS_REMOVE_WORLD_EFFECT, minSize = 152 };
+  static bool complete(const M_HAPTICS_REMOVE_WORLD_EFFECT*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_SET_ENABLED_BY_HANDLE>
+{
+  enum { type = HAPTICS_SET_ENABLED_BY_HANDLE, minSize = 32 };
+  static bool complete(const M_HAPTICS_SET_ENABLED_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE>
+{
+  enum { type = HAPTICS_SET_ENABLED_WORLD_BY_HANDLE, minSize = 32 };
+  static bool complete(const M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_SET_STIFFNESS_BY_HANDLE>
+{
+  enum { type = HAPTICS_SET_STIFFNESS_BY_HANDLE, minSize = 40 };
+  static bool complete(const M_HAPTICS_SET_STIFFNESS_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE>
+{
+  enum { type = HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE, minSize = 32 };
+  static bool complete(const M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_SET_ENABLED>
+{
+  enum { type = GRAPHICS_SET_ENABLED, minSize = 160 };
+  static bool complete(const M_GRAPHICS_SET_ENABLED*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_CHANGE_BG_COLOR>
+{
+  enum { type = GRAPHICS_CHANGE_BG_COLOR, minSize = 40 };
+  static bool complete(const M_GRAPHICS_CHANGE_BG_COLOR*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_PIPE>
+{
+  enum { type = GRAPHICS_PIPE, minSize = 296 };
+  static bool complete(const M_GRAPHICS_PIPE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_ARROW>
+{
+  enum { type = GRAPHICS_ARROW, minSize = 256 };
+  static bool complete(const M_GRAPHICS_ARROW*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_CHANGE_OBJECT_COLOR>
+{
+  enum { type = GRAPHICS_CHANGE_OBJECT_COLOR, minSize = 168 };
+  static bool complete(const M_GRAPHICS_CHANGE_OBJECT_COLOR*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_SET_ENABLED_BY_HANDLE>
+{
+  enum { type = GRAPHICS_SET_ENABLED_BY_HANDLE, minSize = 32 };
+  static bool complete(const M_GRAPHICS_SET_ENABLED_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE>
+{
+  enum { type = GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE, minSize = 48 };
+  static bool complete(const M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_MOVING_DOTS>
+{
+  enum { type = GRAPHICS_MOVING_DOTS, minSize = 184 };
+  static bool complete(const M_GRAPHICS_MOVING_DOTS*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_SHAPE_BOX>
+{
+  enum { type = GRAPHICS_SHAPE_BOX, minSize = 216 };
+  static bool complete(const M_GRAPHICS_SHAPE_BOX*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_SHAPE_SPHERE>
+{
+  enum { type = GRAPHICS_SHAPE_SPHERE, minSize = 200 };
+  static bool complete(const M_GRAPHICS_SHAPE_SPHERE*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_GRAPHICS_SHAPE_TORUS>
+{
+  enum { type = GRAPHICS_SHAPE_TORUS, minSize = 208 };
+  static bool complete(const M_GRAPHICS_SHAPE_TORUS*, int) { return true; }
+};
+
+template<> struct MessageTraits<M_TEST_PACKET>
+{
+  enum { type = TEST_PACKET, minSize = 32 };
+  static bool complete(const M_TEST_PACKET*, int) { return true; }
+};
+
+/**
+ * View of a packet as a message struct, without copying it.
+ * @return NULL if the packet is of another type, or too short
+ */
+template<typename T>
+inline const T* messageView(const char* packet, int length)
+{
+  if (length < (int) MessageTraits<T>::minSize || packetMsgType(packet, length) != (int) MessageTraits<T>::type) {
+    return NULL;
+  }
+  const T* message = reinterpret_cast<const T*>(packet);
+  return MessageTraits<T>::complete(message, length) ? message : NULL;
+}
+
+/**
+ * Calls visitor(view, length) with the view of a packet. The visitor needs an overload for every
+ * message type, or a template catch-all.
+ * @return 1 if the visitor was called, 0 if the type is unknown or the packet is too short
+ */
+template<typename Visitor>
+inline int dispatchMessage(const char* packet, int length, Visitor& visitor)
+{
+  switch (packetMsgType(packet, length))
+  {
+    case SESSION_START:
+    {
+      const M_SESSION_START* message = messageView<M_SESSION_START>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case SESSION_END:
+    {
+      const M_SESSION_END* message = messageView<M_SESSION_END>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case TRIAL_START:
+    {
+      const M_TRIAL_START* message = messageView<M_TRIAL_START>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case TRIAL_END:
+    {
+      const M_TRIAL_END* message = messageView<M_TRIAL_END>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case START_RECORDING:
+    {
+      const M_START_RECORDING* message = messageView<M_START_RECORDING>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case STOP_RECORDING:
+    {
+      const M_STOP_RECORDING* message = messageView<M_STOP_RECORDING>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case REMOVE_OBJECT:
+    {
+      const M_REMOVE_OBJECT* message = messageView<M_REMOVE_OBJECT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case KEYPRESS:
+    {
+      const M_KEYPRESS* message = messageView<M_KEYPRESS>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case PAUSE_RECORDING:
+    {
+      const M_PAUSE_RECORDING* message = messageView<M_PAUSE_RECORDING>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case RESUME_RECORDING:
+    {
+      const M_RESUME_RECORDING* message = messageView<M_RESUME_RECORDING>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case RESET_WORLD:
+    {
+      const M_RESET_WORLD* message = messageView<M_RESET_WORLD>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case OBJECT_HANDLE_REGISTER:
+    {
+      const M_OBJECT_HANDLE_REGISTER* message = messageView<M_OBJECT_HANDLE_REGISTER>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case REMOVE_OBJECT_BY_HANDLE:
+    {
+      const M_REMOVE_OBJECT_BY_HANDLE* message = messageView<M_REMOVE_OBJECT_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case STREAM_FORMAT:
+    {
+      const M_STREAM_FORMAT* message = messageView<M_STREAM_FORMAT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case SCENE_BEGIN:
+    {
+      const M_SCENE_BEGIN* message = messageView<M_SCENE_BEGIN>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case SCENE_COMMIT:
+    {
+      const M_SCENE_COMMIT* message = messageView<M_SCENE_COMMIT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case OBJECT_READY:
+    {
+      const M_OBJECT_READY* message = messageView<M_OBJECT_READY>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case MODULE_READY:
+    {
+      const M_MODULE_READY* message = messageView<M_MODULE_READY>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_CREATE:
+    {
+      const M_CST_CREATE* message = messageView<M_CST_CREATE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_DESTRUCT:
+    {
+      const M_CST_DESTRUCT* message = messageView<M_CST_DESTRUCT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_START:
+    {
+      const M_CST_START* message = messageView<M_CST_START>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_STOP:
+    {
+      const M_CST_STOP* message = messageView<M_CST_STOP>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_SET_VISUAL:
+    {
+      const M_CST_SET_VISUAL* message = messageView<M_CST_SET_VISUAL>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_SET_HAPTIC:
+    {
+      const M_CST_SET_HAPTIC* message = messageView<M_CST_SET_HAPTIC>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_SET_LAMBDA:
+    {
+      const M_CST_SET_LAMBDA* message = messageView<M_CST_SET_LAMBDA>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CST_DATA:
+    {
+      const M_CST_DATA* message = messageView<M_CST_DATA>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CUPS_CREATE:
+    {
+      const M_CUPS_CREATE* message = messageView<M_CUPS_CREATE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CUPS_DESTRUCT:
+    {
+      const M_CUPS_DESTRUCT* message = messageView<M_CUPS_DESTRUCT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CUPS_START:
+    {
+      const M_CUPS_START* message = messageView<M_CUPS_START>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CUPS_STOP:
+    {
+      const M_CUPS_STOP* message = messageView<M_CUPS_STOP>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case CUPS_DATA:
+    {
+      const M_CUPS_DATA* message = messageView<M_CUPS_DATA>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTIC_DATA_STREAM:
+    {
+      const M_HAPTIC_DATA_STREAM* message = messageView<M_HAPTIC_DATA_STREAM>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_SET_ENABLED:
+    {
+      const M_HAPTICS_SET_ENABLED* message = messageView<M_HAPTICS_SET_ENABLED>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_SET_ENABLED_WORLD:
+    {
+      const M_HAPTICS_SET_ENABLED_WORLD* message = messageView<M_HAPTICS_SET_ENABLED_WORLD>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTIC_DATA_STREAM_V2:
+    {
+      const M_HAPTIC_DATA_STREAM_V2* message = messageView<M_HAPTIC_DATA_STREAM_V2>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTIC_DATA_FRAME:
+    {
+      const M_HAPTIC_DATA_FRAME* message = messageView<M_HAPTIC_DATA_FRAME>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_SET_STIFFNESS:
+    {
+      const M_HAPTICS_SET_STIFFNESS* message = messageView<M_HAPTICS_SET_STIFFNESS>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_BOUNDING_PLANE:
+    {
+      const M_HAPTICS_BOUNDING_PLANE* message = messageView<M_HAPTICS_BOUNDING_PLANE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_CONSTANT_FORCE_FIELD:
+    {
+      const M_HAPTICS_CONSTANT_FORCE_FIELD* message = messageView<M_HAPTICS_CONSTANT_FORCE_FIELD>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_VISCOSITY_FIELD:
+    {
+      const M_HAPTICS_VISCOSITY_FIELD* message = messageView<M_HAPTICS_VISCOSITY_FIELD>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_FREEZE_EFFECT:
+    {
+      const M_HAPTICS_FREEZE_EFFECT* message = messageView<M_HAPTICS_FREEZE_EFFECT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_REMOVE_WORLD_EFFECT:
+    {
+      const M_HAPTICS_REMOVE_WORLD_EFFECT* message = messageView<M_HAPTICS_REMOVE_WORLD_EFFECT>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_SET_ENABLED_BY_HANDLE:
+    {
+      const M_HAPTICS_SET_ENABLED_BY_HANDLE* message = messageView<M_HAPTICS_SET_ENABLED_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_SET_ENABLED_WORLD_BY_HANDLE:
+    {
+      const M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE* message = messageView<M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_SET_STIFFNESS_BY_HANDLE:
+    {
+      const M_HAPTICS_SET_STIFFNESS_BY_HANDLE* message = messageView<M_HAPTICS_SET_STIFFNESS_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE:
+    {
+      const M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE* message = messageView<M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_SET_ENABLED:
+    {
+      const M_GRAPHICS_SET_ENABLED* message = messageView<M_GRAPHICS_SET_ENABLED>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_CHANGE_BG_COLOR:
+    {
+      const M_GRAPHICS_CHANGE_BG_COLOR* message = messageView<M_GRAPHICS_CHANGE_BG_COLOR>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_PIPE:
+    {
+      const M_GRAPHICS_PIPE* message = messageView<M_GRAPHICS_PIPE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_ARROW:
+    {
+      const M_GRAPHICS_ARROW* message = messageView<M_GRAPHICS_ARROW>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_CHANGE_OBJECT_COLOR:
+    {
+      const M_GRAPHICS_CHANGE_OBJECT_COLOR* message = messageView<M_GRAPHICS_CHANGE_OBJECT_COLOR>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_SET_ENABLED_BY_HANDLE:
+    {
+      const M_GRAPHICS_SET_ENABLED_BY_HANDLE* message = messageView<M_GRAPHICS_SET_ENABLED_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE:
+    {
+      const M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE* message = messageView<M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_MOVING_DOTS:
+    {
+      const M_GRAPHICS_MOVING_DOTS* message = messageView<M_GRAPHICS_MOVING_DOTS>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_SHAPE_BOX:
+    {
+      const M_GRAPHICS_SHAPE_BOX* message = messageView<M_GRAPHICS_SHAPE_BOX>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_SHAPE_SPHERE:
+    {
+      const M_GRAPHICS_SHAPE_SPHERE* message = messageView<M_GRAPHICS_SHAPE_SPHERE>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case GRAPHICS_SHAPE_TORUS:
+    {
+      const M_GRAPHICS_SHAPE_TORUS* message = messageView<M_GRAPHICS_SHAPE_TORUS>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    case TEST_PACKET:
+    {
+      const M_TEST_PACKET* message = messageView<M_TEST_PACKET>(packet, length);
+      if (message == NULL) {
+        return 0;
+      }
+      visitor(*message, length);
+      return 1;
+    }
+    default:
+      return 0;
+  }
+}
+
+#endif
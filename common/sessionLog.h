@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef _SESSIONLOG_H_
+#define _SESSIONLOG_H_
+
+#include <stdint.h>
+#include <algorithm>
+
+/**
+ * @file sessionLog.h
+ * @brief File format of the session recordings made by MessageHandler.
+ *
+ * A recording is two files. The log (NAME.log) is a SESSION_LOG_HEADER followed by one record per
+ * routed packet, in the order MessageHandler routed them. Each record is a SESSION_LOG_RECORD
+ * followed by the packet, exactly as it was sent, padded to a multiple of 8 bytes.
+ *
+ * The index (NAME.idx) is a SESSION_LOG_HEADER followed by one SESSION_INDEX_ENTRY per record. While
+ * recording, entries are appended in the same order as the log. When the recording is stopped, the
+ * entries are sorted by message type, then timestamp, then serial number, and the header's sorted
+ * flag is set. findIndexRange then finds all entries of one type in a time range with a binary
+ * search, e.g. all CST_DATA between two TRIAL_START messages.
+ */
+
+#define SESSION_LOG_MAGIC 0x474f4c53 // "SLOG"
+#define SESSION_INDEX_MAGIC 0x58444953 // "SIDX"
+#define SESSION_LOG_VERSION 1
+
+typedef struct {
+  uint32_t magic; /**< SESSION_LOG_MAGIC or SESSION_INDEX_MAGIC */
+  uint32_t version; /**< SESSION_LOG_VERSION */
+  uint32_t sorted; /**< Index only: 1 once the entries are sorted, see findIndexRange */
+  uint32_t reserved;
+  int64_t startNs; /**< MessageHandler time when the recording started, in nanoseconds */
+  uint64_t count; /**< Number of records, updated when the recording is stopped */
+} SESSION_LOG_HEADER;
+
+typedef struct {
+  int64_t routedNs; /**< MessageHandler time when the packet was routed, in nanoseconds */
+  int32_t sendingModule; /**< ID of the module that sent the packet */
+  uint32_t length; /**< Length of the packet that follows, without padding */
+} SESSION_LOG_RECORD;
+
+typedef struct {
+  int32_t msg_type; /**< From the packet's MSG_HEADER, -1 if the packet was too short to have one */
+  int32_t serial_no; /**< From the packet's MSG_HEADER */
+  double timestamp; /**< From the packet's MSG_HEADER */
+  uint64_t offset; /**< Offset of the SESSION_LOG_RECORD in the log file */
+  int32_t sendingModule;
+  uint32_t length; /**< Length of the packet */
+} SESSION_INDEX_ENTRY;
+
+/**
+ * Ordering of a sorted index.
+ */
+inline bool indexEntryLess(const SESSION_INDEX_ENTRY& a, const SESSION_INDEX_ENTRY& b)
+{
+  if (a.msg_type != b.msg_type) {
+    return a.msg_type < b.msg_type;
+  }
+  if (a.timestamp != b.timestamp) {
+    return a.timestamp < b.timestamp;
+  }
+  return a.serial_no < b.serial_no;
+}
+
+/**
+ * Size of a record in the log, including the packet and padding.
+ */
+inline uint64_t sessionRecordSize(uint32_t length)
+{
+  return sizeof(SESSION_LOG_RECORD) + ((length + 7) & ~((uint64_t) 7));
+}
+
+/**
+ * Finds the entries of a sorted index with a given message type and a timestamp in [startTime,
+ * endTime).
+ * @param entries Entries of a sorted index
+ * @param numEntries Number of entries
+ * @param first Set to the first matching entry
+ * @return Number of matching entries, which follow first
+ */
+inline uint64_t findIndexRange(const SESSION_INDEX_ENTRY* entries, uint64_t numEntries, int msgType,
+                               double startTime, double endTime, const SESSION_INDEX_ENTRY** first)
+{
+  SESSION_INDEX_ENTRY key = {};
+  key.msg_type = msgType;
+  key.timestamp = startTime;
+  key.serial_no = INT32_MIN;
+  const SESSION_INDEX_ENTRY* lower = std::lower_bound(entries, entries + numEntries, key, indexEntryLess);
+  key.timestamp = endTime;
+  const SESSION_INDEX_ENTRY* upper = std::lower_bound(lower, entries + numEntries, key, indexEntryLess);
+  *first = lower;
+  return upper - lower;
+}
+
+#endif
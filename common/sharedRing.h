@@ -0,0 +1,208 @@
+#pragma once
+
+#ifndef _SHAREDRING_H_
+#define _SHAREDRING_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "messageDefinitions.h"
+
+/**
+ * @file sharedRing.h
+ * @brief Shared-memory packet ring for modules running on the same machine.
+ *
+ * Each publishing module gets one ring in POSIX shared memory, named SHARED_RING_PREFIX followed by
+ * the module ID. There is exactly one writer per ring (either the module itself or MessageHandler on
+ * its behalf) and any number of readers. Packets are stored with their MSG_HEADER framing unchanged,
+ * one packet per slot. Readers keep their own cursor, so a slow reader never blocks the writer; if a
+ * reader falls more than SHARED_RING_SLOTS packets behind, it skips ahead and the skipped packets are
+ * counted as lost.
+ *
+ * Each slot has a sequence number that is odd while the slot is being written, and 2*(index+1) once
+ * the packet with that index is complete. Readers check the sequence before and after copying a
+ * packet out, and discard the copy if the slot was overwritten in the meantime.
+ */
+
+#define SHARED_RING_PREFIX "/hapticEnvironment_ring_"
+#define SHARED_RING_SLOTS 1024
+#define SHARED_RING_MAGIC 0x52494e47 // "RING"
+
+struct SharedRingSlot
+{
+  std::atomic<uint64_t> sequence;
+  uint32_t length;
+  char data[MAX_PACKET_LENGTH];
+};
+
+struct SharedRingHeader
+{
+  uint32_t magic;
+  uint32_t numSlots;
+  std::atomic<uint64_t> writeIndex; /**< Index of the next packet to be written */
+  std::atomic<uint32_t> wakeCount; /**< Incremented after every write, can be waited on */
+};
+
+class SharedRing
+{
+  private:
+    SharedRingHeader* header;
+    SharedRingSlot* slots;
+    size_t mapLength;
+    uint64_t lostPackets;
+
+    SharedRing(void* mem, size_t len)
+    {
+      header = (SharedRingHeader*) mem;
+      slots = (SharedRingSlot*) ((char*) mem + sizeof(SharedRingHeader));
+      mapLength = len;
+      lostPackets = 0;
+    }
+
+    static void* mapRing(const char* name, int flags, size_t len)
+    {
+      int fd = shm_open(name, flags, 0666);
+      if (fd < 0) {
+        return NULL;
+      }
+      if ((flags & O_CREAT) && ftruncate(fd, len) < 0) {
+        ::close(fd);
+        return NULL;
+      }
+      void* mem = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      return (mem == MAP_FAILED) ? NULL : mem;
+    }
+
+  public:
+    static size_t ringLength()
+    {
+      return sizeof(SharedRingHeader) + SHARED_RING_SLOTS * sizeof(SharedRingSlot);
+    }
+
+    /**
+     * Creates (or recreates) a ring. Any existing ring with the same name is discarded.
+     * @return The ring, or NULL if the shared memory could not be created
+     */
+    static SharedRing* create(const char* name)
+    {
+      shm_unlink(name);
+      void* mem = mapRing(name, O_CREAT | O_RDWR, ringLength());
+      if (mem == NULL) {
+        return NULL;
+      }
+      SharedRing* ring = new SharedRing(mem, ringLength());
+      ring->header->numSlots = SHARED_RING_SLOTS;
+      ring->header->writeIndex.store(0);
+      ring->header->wakeCount.store(0);
+      for (int i = 0; i < SHARED_RING_SLOTS; i++) {
+        ring->slots[i].sequence.store(0);
+      }
+      ring->header->magic = SHARED_RING_MAGIC;
+      return ring;
+    }
+
+    /**
+     * Maps an existing ring that was made with create.
+     * @return The ring, or NULL if it does not exist or was not made by this version of the code
+     */
+    static SharedRing* attach(const char* name)
+    {
+      void* mem = mapRing(name, O_RDWR, ringLength());
+      if (mem == NULL) {
+        return NULL;
+      }
+      SharedRing* ring = new SharedRing(mem, ringLength());
+      if (ring->header->magic != SHARED_RING_MAGIC || ring->header->numSlots != SHARED_RING_SLOTS) {
+        delete ring;
+        return NULL;
+      }
+      return ring;
+    }
+
+    ~SharedRing()
+    {
+      munmap(header, mapLength);
+    }
+
+    /**
+     * Appends a packet to the ring. Must only be called by the single writer of this ring.
+     * @return 1 if the packet was written, 0 if it is too long for a slot
+     */
+    int write(const char* packet, uint32_t length)
+    {
+      if (length > MAX_PACKET_LENGTH) {
+        return 0;
+      }
+      uint64_t index = header->writeIndex.load(std::memory_order_relaxed);
+      SharedRingSlot* slot = &slots[index % SHARED_RING_SLOTS];
+      slot->sequence.store(2*index + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      slot->length = length;
+      memcpy(slot->data, packet, length);
+      slot->sequence.store(2*index + 2, std::memory_order_release);
+      header->writeIndex.store(index + 1, std::memory_order_release);
+      header->wakeCount.fetch_add(1, std::memory_order_release);
+      return 1;
+    }
+
+    /**
+     * Index of the next packet that will be written. New readers start their cursor here.
+     */
+    uint64_t writeIndex()
+    {
+      return header->writeIndex.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Copies the packet at a reader's cursor and advances the cursor.
+     * @param cursor The reader's position in the ring
+     * @param packet Buffer of at least MAX_PACKET_LENGTH bytes
+     * @return Number of bytes copied, or 0 if there is no new packet
+     */
+    int read(uint64_t* cursor, char* packet)
+    {
+      while (true) {
+        uint64_t writeIdx = header->writeIndex.load(std::memory_order_acquire);
+        if (*cursor >= writeIdx) {
+          return 0;
+        }
+        if (writeIdx - *cursor > SHARED_RING_SLOTS) {
+          lostPackets += writeIdx - SHARED_RING_SLOTS - *cursor;
+          *cursor = writeIdx - SHARED_RING_SLOTS;
+        }
+        SharedRingSlot* slot = &slots[*cursor % SHARED_RING_SLOTS];
+        uint64_t seqBefore = slot->sequence.load(std::memory_order_acquire);
+        if (seqBefore != 2*(*cursor) + 2) {
+          // Overwritten by a newer packet before we got to it
+          lostPackets++;
+          (*cursor)++;
+          continue;
+        }
+        uint32_t length = slot->length;
+        if (length > MAX_PACKET_LENGTH) {
+          length = MAX_PACKET_LENGTH;
+        }
+        memcpy(packet, slot->data, length);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t seqAfter = slot->sequence.load(std::memory_order_relaxed);
+        (*cursor)++;
+        if (seqAfter != seqBefore) {
+          lostPackets++;
+          continue;
+        }
+        return length;
+      }
+    }
+
+    uint64_t getLostPackets()
+    {
+      return lostPackets;
+    }
+};
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef _STREAMFRAME_H_
+#define _STREAMFRAME_H_
+
+#include <string.h>
+#include "messageDispatch.h"
+
+/**
+ * @file streamFrame.h
+ * @brief Unpacking of HAPTIC_DATA_FRAME messages.
+ *
+ * Subscribers of the haptic data stream can turn each sample of a frame back into a
+ * M_HAPTIC_DATA_STREAM_V2 message without contacts, and handle it like any other V2 sample.
+ */
+
+/**
+ * Number of samples in a frame, after checking that the packet is long enough to hold them.
+ * @return The number of samples, 0 if the packet is not a complete HAPTIC_DATA_FRAME
+ */
+inline int frameSampleCount(const char* packet, int length)
+{
+  const M_HAPTIC_DATA_FRAME* frame = messageView<M_HAPTIC_DATA_FRAME>(packet, length);
+  return (frame == NULL) ? 0 : frame->numSamples;
+}
+
+/**
+ * Copies one sample of a frame into a M_HAPTIC_DATA_STREAM_V2. The sample gets the frame's serial
+ * number and its own timestamp.
+ * @return 1 on success, 0 if index is not a sample of the frame
+ */
+inline int unpackStreamFrame(const char* packet, int length, int index, M_HAPTIC_DATA_STREAM_V2* sample)
+{
+  if (index < 0 || index >= frameSampleCount(packet, length)) {
+    return 0;
+  }
+  const M_HAPTIC_DATA_FRAME* frame = messageView<M_HAPTIC_DATA_FRAME>(packet, length);
+  const STREAM_SAMPLE& frameSample = frame->samples[index];
+  memset(sample, 0, HAPTIC_STREAM_V2_SIZE(0));
+  sample->header = frame->header;
+  sample->header.msg_type = HAPTIC_DATA_STREAM_V2;
+  sample->header.timestamp = frame->header.timestamp + frameSample.timeOffset;
+  sample->deviceTick = frameSample.deviceTick;
+  memcpy(sample->pos, frameSample.pos, sizeof(sample->pos));
+  memcpy(sample->vel, frameSample.vel, sizeof(sample->vel));
+  memcpy(sample->force, frameSample.force, sizeof(sample->force));
+  return 1;
+}
+
+#endif
@@ -0,0 +1,336 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+/**
+ * @file Benchmark.h
+ * @file Benchmark.cpp
+ * @brief Load generator and latency benchmark for MessageHandler.
+ *
+ * Starts a number of fake modules in one process, on loopback. Every fake module registers with
+ * MessageHandler, subscribes to all the others, publishes a mix of messages at fixed rates, and
+ * receives everyone else's messages. At the end, publish-to-receive latency percentiles and lost
+ * messages (by sequence number) are printed. Since every module runs on the same machine, send and
+ * receive times come from the same CLOCK_MONOTONIC.
+ */
+
+int64_t monotonicNs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * Opens the module's listening socket and adds it to MessageHandler.
+ * @return 1 on success, 0 on failure
+ */
+int setupModule(FakeModule* module, const BenchOptions& options)
+{
+  module->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  struct sockaddr_in sockStruct;
+  memset((char*) &sockStruct, 0, sizeof(sockStruct));
+  sockStruct.sin_family = AF_INET;
+  sockStruct.sin_port = htons(module->port);
+  sockStruct.sin_addr.s_addr = inet_addr("127.0.0.1");
+  int rcvBuf = 4 * 1024 * 1024;
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = BENCH_RECV_TIMEOUT_US;
+  setsockopt(module->sock, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+  setsockopt(module->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  if (module->sock < 0 || bind(module->sock, (struct sockaddr*) &sockStruct, sizeof(sockStruct)) < 0) {
+    cout << "Could not bind port " << module->port << " for module " << module->moduleID << endl;
+    return 0;
+  }
+
+  module->client = new rpc::client(options.mhIP, options.mhPort);
+  if (module->client->call("addModule", module->moduleID, string("127.0.0.1"), module->port).as<int>() != 1) {
+    cout << "Could not add module " << module->moduleID << endl;
+    return 0;
+  }
+  module->ingestSocket = -1;
+  if (options.useIngest == true) {
+    int ingestPort = module->client->call("getIngestPort").as<int>();
+    if (ingestPort <= 0) {
+      cout << "MessageHandler has no ingest port, using sendMessage" << endl;
+    }
+    else {
+      module->ingestSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      memset((char*) &(module->ingestStruct), 0, sizeof(module->ingestStruct));
+      module->ingestStruct.sin_family = AF_INET;
+      module->ingestStruct.sin_port = htons(ingestPort);
+      module->ingestStruct.sin_addr.s_addr = inet_addr(options.mhIP);
+    }
+  }
+  module->seen.resize(options.numModules);
+  module->received = 0;
+  module->duplicates = 0;
+  return 1;
+}
+
+/**
+ * Publishing thread of a fake module. Each message in the mix has its own schedule, and the thread
+ * sleeps until the next message on any of them is due.
+ */
+void publish(FakeModule* module, const BenchOptions& options, atomic<bool>* publishing)
+{
+  vector<char> packet(MAX_PACKET_LENGTH, 0);
+  vector<int64_t> nextSend(options.mix.size(), monotonicNs());
+  while (publishing->load()) {
+    size_t next = min_element(nextSend.begin(), nextSend.end()) - nextSend.begin();
+    struct timespec wake;
+    wake.tv_sec = nextSend[next] / 1000000000;
+    wake.tv_nsec = nextSend[next] % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {}
+    nextSend[next] += int64_t(1e9 / options.mix[next].rate);
+
+    const BenchMessage& message = options.mix[next];
+    int length = max(message.size, (int) (sizeof(MSG_HEADER) + sizeof(BENCH_PAYLOAD)));
+    length = min(length, MAX_PACKET_LENGTH);
+    MSG_HEADER header;
+    header.serial_no = module->sent.load();
+    header.msg_type = message.msgType;
+    header.reserved = 0;
+    header.timestamp = monotonicNs() / 1e9;
+    BENCH_PAYLOAD payload;
+    payload.publisher = module->index;
+    payload.reserved = 0;
+    memcpy(&packet[0], &header, sizeof(header));
+    memcpy(&packet[sizeof(header)], &payload, sizeof(payload));
+
+    int success;
+    if (module->ingestSocket >= 0) {
+      MSG_INGEST_PREFIX prefix;
+      prefix.moduleID = module->moduleID;
+      prefix.reserved = 0;
+      struct iovec iov[2];
+      iov[0].iov_base = &prefix;
+      iov[0].iov_len = sizeof(prefix);
+      iov[1].iov_base = &packet[0];
+      iov[1].iov_len = length;
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_name = &(module->ingestStruct);
+      msg.msg_namelen = sizeof(module->ingestStruct);
+      msg.msg_iov = iov;
+      msg.msg_iovlen = 2;
+      success = (sendmsg(module->ingestSocket, &msg, 0) < 0) ? 0 : 1;
+    }
+    else {
+      vector<char> packetData(packet.begin(), packet.begin() + length);
+      success = module->client->call("sendMessage", packetData, length, module->moduleID).as<int>();
+    }
+    if (success == 0) {
+      module->sendErrors++;
+    }
+    module->sent++;
+  }
+}
+
+/**
+ * Receiving thread of a fake module. Records the latency of every message and which sequence
+ * numbers arrived from each publisher.
+ */
+void receive(FakeModule* module, int numModules, atomic<bool>* receiving)
+{
+  vector<char> buffers(BENCH_RECV_BATCH * MAX_PACKET_LENGTH);
+  struct iovec iovecs[BENCH_RECV_BATCH];
+  struct mmsghdr msgs[BENCH_RECV_BATCH];
+  for (int i = 0; i < BENCH_RECV_BATCH; i++) {
+    iovecs[i].iov_base = &buffers[i * MAX_PACKET_LENGTH];
+    iovecs[i].iov_len = MAX_PACKET_LENGTH;
+  }
+  while (receiving->load()) {
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < BENCH_RECV_BATCH; i++) {
+      msgs[i].msg_hdr.msg_iov = &iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int numReceived = recvmmsg(module->sock, msgs, BENCH_RECV_BATCH, MSG_WAITFORONE, NULL);
+    int64_t now = monotonicNs();
+    for (int i = 0; i < numReceived; i++) {
+      if (msgs[i].msg_len < sizeof(MSG_HEADER) + sizeof(BENCH_PAYLOAD)) {
+        continue;
+      }
+      MSG_HEADER header;
+      BENCH_PAYLOAD payload;
+      memcpy(&header, iovecs[i].iov_base, sizeof(header));
+      memcpy(&payload, (char*) iovecs[i].iov_base + sizeof(header), sizeof(payload));
+      if (payload.publisher < 0 || payload.publisher >= numModules || header.serial_no < 0) {
+        continue;
+      }
+      vector<bool>& seen = module->seen[payload.publisher];
+      if (header.serial_no >= (int) seen.size()) {
+        seen.resize(max((size_t) header.serial_no + 1, seen.size() * 2), false);
+      }
+      if (seen[header.serial_no] == true) {
+        module->duplicates++;
+        continue;
+      }
+      seen[header.serial_no] = true;
+      module->received++;
+      module->latencies.push_back(now - int64_t(header.timestamp * 1e9));
+    }
+  }
+}
+
+/**
+ * Prints latency percentiles over all received messages, and what was lost.
+ */
+void report(vector<FakeModule*>& modules, const BenchOptions& options)
+{
+  vector<int64_t> latencies;
+  uint64_t sent = 0, expected = 0, received = 0, duplicates = 0, sendErrors = 0;
+  for (size_t i = 0; i < modules.size(); i++) {
+    sent += modules[i]->sent.load();
+    sendErrors += modules[i]->sendErrors.load();
+    received += modules[i]->received;
+    duplicates += modules[i]->duplicates;
+    latencies.insert(latencies.end(), modules[i]->latencies.begin(), modules[i]->latencies.end());
+    // Every module receives every other module's messages
+    expected += uint64_t(modules.size() - 1) * modules[i]->sent.load();
+  }
+  cout << modules.size() << " modules, " << options.duration << " s, "
+       << (options.useIngest ? "ingest port" : "sendMessage") << endl;
+  cout << "Published " << sent << " messages (" << sent / options.duration << "/s), "
+       << sendErrors << " send errors" << endl;
+  cout << "Received " << received << " of " << expected << " expected, "
+       << expected - min(expected, received) << " lost, " << duplicates << " duplicates" << endl;
+  for (size_t i = 0; i < modules.size(); i++) {
+    for (size_t j = 0; j < modules.size(); j++) {
+      if (i == j) {
+        continue;
+      }
+      const vector<bool>& seen = modules[j]->seen[i];
+      int publisherSent = modules[i]->sent.load();
+      int missing = 0;
+      for (int k = 0; k < publisherSent; k++) {
+        missing += (k >= (int) seen.size() || seen[k] == false);
+      }
+      if (missing > 0) {
+        cout << "  module " << modules[i]->moduleID << " -> " << modules[j]->moduleID << ": "
+             << missing << " of " << publisherSent << " lost" << endl;
+      }
+    }
+  }
+  if (latencies.empty()) {
+    return;
+  }
+  sort(latencies.begin(), latencies.end());
+  double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+  cout << "Latency (us):";
+  for (int i = 0; i < 4; i++) {
+    cout << " p" << percentiles[i] * 100 << " " << latencies[size_t(percentiles[i] * (latencies.size() - 1))] / 1e3;
+  }
+  cout << " max " << latencies.back() / 1e3 << endl;
+}
+
+/**
+ * Parses TYPE:RATE[:SIZE]. SIZE defaults to the size of a HAPTIC_DATA_STREAM message.
+ */
+static BenchMessage parseMix(const char* spec)
+{
+  BenchMessage message;
+  message.msgType = HAPTIC_DATA_STREAM;
+  message.rate = 1000;
+  message.size = sizeof(M_HAPTIC_DATA_STREAM);
+  sscanf(spec, "%d:%lf:%d", &message.msgType, &message.rate, &message.size);
+  if (message.rate <= 0) {
+    message.rate = 1;
+  }
+  return message;
+}
+
+int main(int argc, char* argv[])
+{
+  BenchOptions options;
+  options.mhIP = "127.0.0.1";
+  options.mhPort = 8080;
+  options.numModules = 3;
+  options.duration = 10;
+  options.useIngest = false;
+  options.baseID = 100;
+  options.basePort = 20000;
+  int i = 1;
+  if (argc > 2 && strncmp(argv[1], "--", 2) != 0) {
+    options.mhIP = argv[1];
+    options.mhPort = atoi(argv[2]);
+    i = 3;
+  }
+  for (; i < argc; i++) {
+    if (strcmp(argv[i], "--modules") == 0 && i+1 < argc) {
+      options.numModules = max(2, atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "--duration") == 0 && i+1 < argc) {
+      options.duration = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--mix") == 0 && i+1 < argc) {
+      options.mix.push_back(parseMix(argv[++i]));
+    }
+    else if (strcmp(argv[i], "--ingest") == 0) {
+      options.useIngest = true;
+    }
+    else if (strcmp(argv[i], "--base-id") == 0 && i+1 < argc) {
+      options.baseID = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--base-port") == 0 && i+1 < argc) {
+      options.basePort = atoi(argv[++i]);
+    }
+    else {
+      cout << "Usage: benchmark [MH_IP MH_PORT] [--modules N] [--duration S] [--mix TYPE:RATE[:SIZE]]... "
+           << "[--ingest] [--base-id ID] [--base-port PORT]" << endl;
+      return 1;
+    }
+  }
+  if (options.mix.empty()) {
+    // A haptics stream and occasional trial control messages
+    options.mix.push_back(parseMix("1000:1000"));
+    BenchMessage control = {TRIAL_START, 10, (int) sizeof(M_TRIAL_START)};
+    options.mix.push_back(control);
+  }
+
+  vector<FakeModule*> modules;
+  for (int m = 0; m < options.numModules; m++) {
+    FakeModule* module = new FakeModule();
+    module->index = m;
+    module->moduleID = options.baseID + m;
+    module->port = options.basePort + m;
+    if (setupModule(module, options) == 0) {
+      return 1;
+    }
+    modules.push_back(module);
+  }
+  for (int m = 0; m < options.numModules; m++) {
+    for (int n = 0; n < options.numModules; n++) {
+      if (m != n) {
+        modules[m]->client->call("subscribeTo", modules[m]->moduleID, modules[n]->moduleID);
+      }
+    }
+  }
+
+  atomic<bool> publishing{true};
+  atomic<bool> receiving{true};
+  vector<thread*> threads;
+  for (int m = 0; m < options.numModules; m++) {
+    threads.push_back(new thread(receive, modules[m], options.numModules, &receiving));
+  }
+  for (int m = 0; m < options.numModules; m++) {
+    threads.push_back(new thread(publish, modules[m], options, &publishing));
+  }
+  usleep(int(options.duration * 1e6));
+  publishing = false;
+  sleep(BENCH_DRAIN_SECONDS);
+  receiving = false;
+  for (size_t t = 0; t < threads.size(); t++) {
+    threads[t]->join();
+    delete threads[t];
+  }
+  report(modules, options);
+  cout << "MessageHandler stats: " << modules[0]->client->call("getStats").as<string>() << endl;
+  return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <stdint.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "rpc/client.h"
+#include "messageDefinitions.h"
+
+#define BENCH_RECV_BATCH 64 // datagrams per recvmmsg call
+#define BENCH_RECV_TIMEOUT_US 100000 // receivers check for the end of the run this often
+#define BENCH_DRAIN_SECONDS 1 // receivers keep going this long after the senders stop
+
+using namespace std;
+
+/**
+ * One kind of message a fake module publishes.
+ */
+struct BenchMessage
+{
+  int msgType;
+  double rate; // messages per second
+  int size; // bytes, including the MSG_HEADER and BENCH_PAYLOAD
+};
+
+/**
+ * Body of every benchmark message, after the MSG_HEADER. MSG_HEADER.serial_no is a sequence
+ * number per publisher and MSG_HEADER.timestamp is the CLOCK_MONOTONIC send time in seconds.
+ */
+typedef struct {
+  int publisher; /**< Index of the fake module that sent the message */
+  int reserved;
+} BENCH_PAYLOAD;
+
+struct BenchOptions
+{
+  const char* mhIP;
+  int mhPort;
+  int numModules;
+  double duration; // seconds of publishing
+  vector<BenchMessage> mix;
+  bool useIngest;
+  int baseID; // fake modules get IDs baseID, baseID+1, ...
+  int basePort; // and listen on basePort, basePort+1, ...
+};
+
+/**
+ * State of one fake module. Counters are written by the module's own threads and read once the
+ * run is over.
+ */
+struct FakeModule
+{
+  int index;
+  int moduleID;
+  int port;
+  int sock;
+  rpc::client* client;
+  int ingestSocket;
+  struct sockaddr_in ingestStruct;
+  atomic<int> sent{0}; // messages published, also the next sequence number
+  atomic<uint64_t> sendErrors{0};
+  vector<vector<bool>> seen; // seen[publisher][sequence], filled by the receiving thread
+  uint64_t received;
+  uint64_t duplicates;
+  vector<int64_t> latencies; // publish to receive, in nanoseconds
+};
+
+int64_t monotonicNs();
+int setupModule(FakeModule* module, const BenchOptions& options);
+void publish(FakeModule* module, const BenchOptions& options, atomic<bool>* publishing);
+void receive(FakeModule* module, int numModules, atomic<bool>* receiving);
+void report(vector<FakeModule*>& modules, const BenchOptions& options);
+
+#endif
@@ -0,0 +1,226 @@
+#include "BrokerStats.h"
+#include "messageDispatch.h"
+#include <sstream>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+
+/**
+ * @file BrokerStats.h
+ * @file BrokerStats.cpp
+ * @brief Per-module and per-message-type traffic counters of MessageHandler.
+ */
+
+int DelayHistogram::bucketFor(int64_t ns)
+{
+  if (ns < STATS_SUB_BUCKETS) {
+    return (ns < 0) ? 0 : ns;
+  }
+  int msb = 63 - __builtin_clzll((uint64_t) ns);
+  int sub = (ns >> (msb - 2)) & (STATS_SUB_BUCKETS - 1);
+  return (msb - 1) * STATS_SUB_BUCKETS + sub;
+}
+
+/**
+ * Smallest value that goes in a bucket.
+ */
+int64_t DelayHistogram::bucketStart(int bucket)
+{
+  if (bucket < STATS_SUB_BUCKETS) {
+    return bucket;
+  }
+  int msb = bucket / STATS_SUB_BUCKETS + 1;
+  int sub = bucket % STATS_SUB_BUCKETS;
+  return (int64_t) (STATS_SUB_BUCKETS + sub) << (msb - 2);
+}
+
+void DelayHistogram::record(int64_t ns)
+{
+  counts[bucketFor(ns)].fetch_add(1, memory_order_relaxed);
+  int64_t currentMax = maxNs.load(memory_order_relaxed);
+  while (ns > currentMax && !maxNs.compare_exchange_weak(currentMax, ns, memory_order_relaxed)) {}
+}
+
+uint64_t DelayHistogram::total() const
+{
+  uint64_t sum = 0;
+  for (int i = 0; i < STATS_BUCKETS; i++) {
+    sum += counts[i].load(memory_order_relaxed);
+  }
+  return sum;
+}
+
+/**
+ * Approximate value below which a fraction of the recorded values fall.
+ * @return The start of the bucket holding that value, 0 if nothing was recorded
+ */
+int64_t DelayHistogram::percentile(double fraction) const
+{
+  uint64_t target = (uint64_t) (fraction * total());
+  uint64_t sum = 0;
+  for (int i = 0; i < STATS_BUCKETS; i++) {
+    sum += counts[i].load(memory_order_relaxed);
+    if (sum > target) {
+      return bucketStart(i);
+    }
+  }
+  return 0;
+}
+
+BrokerStats::BrokerStats()
+{
+  // Atomics in arrays are not zeroed by default construction
+  for (int i = 0; i <= STATS_MAX_MODULES; i++) {
+    modules[i].packetsIn = 0;
+    modules[i].bytesIn = 0;
+    modules[i].packetsOut = 0;
+    modules[i].bytesOut = 0;
+    modules[i].sendErrors = 0;
+    modules[i].dropped = 0;
+    for (int j = 0; j < STATS_BUCKETS; j++) {
+      modules[i].queueDelay.counts[j] = 0;
+    }
+    modules[i].queueDelay.maxNs = 0;
+  }
+  for (int i = 0; i <= STATS_MAX_MSG_TYPE; i++) {
+    types[i].packets = 0;
+    types[i].bytes = 0;
+    types[i].sendErrors = 0;
+  }
+}
+
+int BrokerStats::moduleIndex(int moduleID)
+{
+  return (moduleID >= 0 && moduleID < STATS_MAX_MODULES) ? moduleID : STATS_MAX_MODULES;
+}
+
+int BrokerStats::typeIndex(int msgType)
+{
+  return (msgType >= 0 && msgType < STATS_MAX_MSG_TYPE) ? msgType : STATS_MAX_MSG_TYPE;
+}
+
+/**
+ * Message type from a packet's MSG_HEADER, or -1 if the packet is too short to have one.
+ */
+int BrokerStats::packetType(const char* packet, int length)
+{
+  return packetMsgType(packet, length);
+}
+
+/**
+ * Counts a packet MessageHandler received from a module.
+ */
+void BrokerStats::countIn(int sendingModule, int msgType, int length)
+{
+  ModuleStats& module = modules[moduleIndex(sendingModule)];
+  module.packetsIn.fetch_add(1, memory_order_relaxed);
+  module.bytesIn.fetch_add(length, memory_order_relaxed);
+  TypeStats& type = types[typeIndex(msgType)];
+  type.packets.fetch_add(1, memory_order_relaxed);
+  type.bytes.fetch_add(length, memory_order_relaxed);
+}
+
+/**
+ * Counts a packet delivered to a subscriber, by UDP or through a ring.
+ */
+void BrokerStats::countOut(int receivingModule, int length)
+{
+  ModuleStats& receiver = modules[moduleIndex(receivingModule)];
+  receiver.packetsOut.fetch_add(1, memory_order_relaxed);
+  receiver.bytesOut.fetch_add(length, memory_order_relaxed);
+}
+
+/**
+ * Records the time from MessageHandler receiving a packet to handing it to sendto.
+ */
+void BrokerStats::countDelay(int sendingModule, int64_t queueDelayNs)
+{
+  modules[moduleIndex(sendingModule)].queueDelay.record(queueDelayNs);
+}
+
+void BrokerStats::countError(int sendingModule, int msgType)
+{
+  modules[moduleIndex(sendingModule)].sendErrors.fetch_add(1, memory_order_relaxed);
+  types[typeIndex(msgType)].sendErrors.fetch_add(1, memory_order_relaxed);
+}
+
+void BrokerStats::countDropped(int sendingModule)
+{
+  modules[moduleIndex(sendingModule)].dropped.fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * Packets of a module that were queued but failed to send or were dropped from a full lane.
+ */
+uint64_t BrokerStats::failures(int sendingModule)
+{
+  const ModuleStats& module = modules[moduleIndex(sendingModule)];
+  return module.sendErrors.load(memory_order_relaxed) + module.dropped.load(memory_order_relaxed);
+}
+
+/**
+ * All counters as a JSON object. Modules and message types without any traffic are left out, and
+ * the ones above STATS_MAX_MODULES or STATS_MAX_MSG_TYPE are listed as "other". Delays are in
+ * microseconds.
+ */
+string BrokerStats::toJson(double uptime)
+{
+  ostringstream json;
+  json << "{\"uptime\": " << uptime << ", \"modules\": {";
+  bool first = true;
+  for (int i = 0; i <= STATS_MAX_MODULES; i++) {
+    ModuleStats& module = modules[i];
+    uint64_t packetsIn = module.packetsIn.load(memory_order_relaxed);
+    uint64_t packetsOut = module.packetsOut.load(memory_order_relaxed);
+    if (packetsIn == 0 && packetsOut == 0) {
+      continue;
+    }
+    json << (first ? "" : ", ") << "\"" << (i == STATS_MAX_MODULES ? string("other") : to_string(i)) << "\": {"
+         << "\"packetsIn\": " << packetsIn
+         << ", \"bytesIn\": " << module.bytesIn.load(memory_order_relaxed)
+         << ", \"packetsOut\": " << packetsOut
+         << ", \"bytesOut\": " << module.bytesOut.load(memory_order_relaxed)
+         << ", \"sendErrors\": " << module.sendErrors.load(memory_order_relaxed)
+         << ", \"dropped\": " << module.dropped.load(memory_order_relaxed)
+         << ", \"queueDelayUs\": {\"p50\": " << module.queueDelay.percentile(0.5) / 1e3
+         << ", \"p99\": " << module.queueDelay.percentile(0.99) / 1e3
+         << ", \"p999\": " << module.queueDelay.percentile(0.999) / 1e3
+         << ", \"max\": " << module.queueDelay.maxNs.load(memory_order_relaxed) / 1e3 << "}}";
+    first = false;
+  }
+  json << "}, \"types\": {";
+  first = true;
+  for (int i = 0; i <= STATS_MAX_MSG_TYPE; i++) {
+    TypeStats& type = types[i];
+    uint64_t packets = type.packets.load(memory_order_relaxed);
+    if (packets == 0) {
+      continue;
+    }
+    json << (first ? "" : ", ") << "\"" << (i == STATS_MAX_MSG_TYPE ? string("other") : to_string(i)) << "\": {"
+         << "\"name\": \"" << (i == STATS_MAX_MSG_TYPE ? "OTHER" : messageName(i)) << "\""
+         << ", \"packets\": " << packets
+         << ", \"bytes\": " << type.bytes.load(memory_order_relaxed)
+         << ", \"sendErrors\": " << type.sendErrors.load(memory_order_relaxed) << "}";
+    first = false;
+  }
+  json << "}}";
+  return json.str();
+}
+
+/**
+ * Writes the counters to a file. The file is replaced in one step, so readers never see half of it.
+ * @return 1 on success, 0 on failure
+ */
+int BrokerStats::writeFile(const string& path, double uptime)
+{
+  string tmpPath = path + ".tmp";
+  {
+    ofstream statsFile(tmpPath.c_str(), ios::trunc);
+    if (!statsFile) {
+      return 0;
+    }
+    statsFile << toJson(uptime) << '\n';
+  }
+  return (rename(tmpPath.c_str(), path.c_str()) == 0) ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef _BROKERSTATS_H_
+#define _BROKERSTATS_H_
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+#define STATS_MAX_MODULES 64 // modules with an ID at or above this are counted together
+#define STATS_MAX_MSG_TYPE 10000 // message types at or above this are counted together
+#define STATS_SUB_BUCKETS 4 // histogram buckets per power of two
+#define STATS_BUCKETS (64 * STATS_SUB_BUCKETS)
+
+using namespace std;
+
+/**
+ * Histogram of delays in nanoseconds. Each power of two is split into STATS_SUB_BUCKETS buckets,
+ * so every value is counted with less than 25% error, from nanoseconds to hours.
+ */
+struct DelayHistogram
+{
+  atomic<uint64_t> counts[STATS_BUCKETS];
+  atomic<int64_t> maxNs;
+
+  static int bucketFor(int64_t ns);
+  static int64_t bucketStart(int bucket);
+  void record(int64_t ns);
+  int64_t percentile(double fraction) const;
+  uint64_t total() const;
+};
+
+struct ModuleStats
+{
+  atomic<uint64_t> packetsIn; /**< Packets sent by this module */
+  atomic<uint64_t> bytesIn;
+  atomic<uint64_t> packetsOut; /**< Packets delivered to this module */
+  atomic<uint64_t> bytesOut;
+  atomic<uint64_t> sendErrors; /**< Packets from this module that failed to send */
+  atomic<uint64_t> dropped; /**< Packets from this module dropped from a full lane */
+  DelayHistogram queueDelay; /**< Time from receiving a packet of this module to sending it */
+};
+
+struct TypeStats
+{
+  atomic<uint64_t> packets;
+  atomic<uint64_t> bytes;
+  atomic<uint64_t> sendErrors;
+};
+
+/**
+ * Traffic counters of MessageHandler. Counters are only ever incremented with relaxed atomics, so
+ * routing threads never wait on each other to count. Readers may see counters of a packet that is
+ * being routed half updated, which is fine for monitoring.
+ */
+class BrokerStats
+{
+  private:
+    ModuleStats modules[STATS_MAX_MODULES + 1];
+    TypeStats types[STATS_MAX_MSG_TYPE + 1];
+    static int moduleIndex(int moduleID);
+    static int typeIndex(int msgType);
+
+  public:
+    BrokerStats();
+    static int packetType(const char* packet, int length);
+    void countIn(int sendingModule, int msgType, int length);
+    void countOut(int receivingModule, int length);
+    void countDelay(int sendingModule, int64_t queueDelayNs);
+    void countError(int sendingModule, int msgType);
+    void countDropped(int sendingModule);
+    uint64_t failures(int sendingModule);
+    string toJson(double uptime);
+    int writeFile(const string& path, double uptime);
+};
+
+#endif
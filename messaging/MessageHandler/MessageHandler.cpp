@@ -1,12 +1,103 @@
 #include "MessageHandler.h"
 #include <typeinfo>
 #include <fcntl.h>
+#include <errno.h>
 #include <string>
 
-MessageHandler::MessageHandler(const char* address, int port)
+MessageHandler::MessageHandler(const char* address, int port, bool useSharedMemory, int iIngestPort,
+                               const char* multicastGroup, int iMulticastPort, const char* statsFile)
 {
   srv = new rpc::server(address, port);
   startTime = high_resolution_clock::now();
+  atomic_store(&routes, shared_ptr<const RoutingTable>(make_shared<RoutingTable>()));
+  recorder = new SessionRecorder(startTime);
+  stats = new BrokerStats();
+  statsThread = NULL;
+  if (statsFile != NULL) {
+    statsPath = statsFile;
+    statsThread = new thread(&MessageHandler::writeStats, this);
+  }
+  multicastEnabled = false;
+  multicastBase = 0;
+  multicastPort = 0;
+  interfaceAddress = inet_addr(address);
+  if (multicastGroup != NULL) {
+    in_addr_t group = inet_addr(multicastGroup);
+    if (group == INADDR_NONE || !IN_MULTICAST(ntohl(group)) || iMulticastPort <= 0) {
+      cout << "Invalid multicast group " << multicastGroup << ":" << iMulticastPort << ", multicast is disabled." << endl;
+    }
+    else {
+      multicastEnabled = true;
+      multicastBase = ntohl(group);
+      multicastPort = iMulticastPort;
+      cout << "Sending each module's packets to multicast group " << multicastGroup << " + moduleID, port " << multicastPort << endl;
+    }
+  }
+  const char* laneNames[NUM_LANES] = {"command", "stream"};
+  for (int i = 0; i < NUM_LANES; i++) {
+    lanes[i].name = laneNames[i];
+    lanes[i].perPublisher = (i == LANE_COMMAND);
+    lanes[i].queued = 0;
+    lanes[i].queueLimit = (i == LANE_STREAM) ? STREAM_LANE_QUEUE_LIMIT : 0;
+    lanes[i].dropped = 0;
+    lanes[i].sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    int opt = 1;
+    if (lanes[i].sock < 0 || setsockopt(lanes[i].sock, SOL_SOCKET, SO_BROADCAST, &opt, sizeof(opt)) < 0) {
+      cout << "Opening socket for " << lanes[i].name << " lane failed." << endl;
+    }
+    enableMulticast(lanes[i].sock);
+    lanes[i].sender = new thread(&MessageHandler::runLane, this, i);
+  }
+  shmEnabled = useSharedMemory;
+  ringPump = NULL;
+  if (shmEnabled == true) {
+    ringPump = new thread(&MessageHandler::pumpRings, this);
+  }
+
+  ingestSocket = -1;
+  ingestPort = 0;
+  ingestThread = NULL;
+  if (iIngestPort > 0) {
+    struct sockaddr_in ingestStruct;
+    memset((char *) &ingestStruct, 0, sizeof(ingestStruct));
+    ingestStruct.sin_family = AF_INET;
+    ingestStruct.sin_port = htons(iIngestPort);
+    ingestStruct.sin_addr.s_addr = inet_addr(address);
+    ingestSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    int rcvBuf = 4 * 1024 * 1024;
+    setsockopt(ingestSocket, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    if (ingestSocket < 0 || bind(ingestSocket, (struct sockaddr*) &ingestStruct, sizeof(ingestStruct)) < 0) {
+      cout << "Could not bind ingest port " << iIngestPort << ", only sendMessage will be available." << endl;
+    }
+    else {
+      ingestPort = iIngestPort;
+      ingestThread = new thread(&MessageHandler::runIngest, this);
+      cout << "Listening for packets on ingest port " << ingestPort << endl;
+    }
+  }
+}
+
+/**
+ * Current routing table. The table stays valid for as long as the caller holds on to it, even if a
+ * newer one is published in the meantime.
+ */
+shared_ptr<const RoutingTable> MessageHandler::loadRoutes()
+{
+  return atomic_load(&routes);
+}
+
+/**
+ * Copy of the current routing table, to be changed and then published with storeRoutes. Callers
+ * must hold routingMutex from copyRoutes until storeRoutes, so that changes are not lost.
+ */
+shared_ptr<RoutingTable> MessageHandler::copyRoutes()
+{
+  return make_shared<RoutingTable>(*loadRoutes());
+}
+
+void MessageHandler::storeRoutes(shared_ptr<RoutingTable> table)
+{
+  atomic_store(&routes, shared_ptr<const RoutingTable>(table));
 }
 
 rpc::server* MessageHandler::getServer()
@@ -19,6 +110,20 @@ int MessageHandler::getMsgNum()
   return msgNum++;
 }
 
+/**
+ * Reserves a contiguous block of serial numbers for a module, so that it can stamp MSG_HEADER
+ * serial numbers locally instead of calling getMsgNum for every message.
+ * @param count Number of serial numbers to reserve
+ * @return The first serial number of the block. The module owns [first, first + count).
+ */
+int MessageHandler::getMsgNumBlock(int count)
+{
+  if (count < 1) {
+    count = 1;
+  }
+  return msgNum.fetch_add(count);
+}
+
 double MessageHandler::getTimestamp()
 {
   high_resolution_clock::time_point currTime = high_resolution_clock::now();
@@ -26,6 +131,16 @@ double MessageHandler::getTimestamp()
   return timeNow.count();
 }
 
+/**
+ * Time since MessageHandler started, in nanoseconds. Modules sample this to estimate the offset and
+ * drift between their local clock and the MessageHandler timebase.
+ */
+int64_t MessageHandler::getTimestampNs()
+{
+  high_resolution_clock::time_point currTime = high_resolution_clock::now();
+  return duration_cast<nanoseconds>(currTime-startTime).count();
+}
+
 int MessageHandler::addModule(int moduleID, string ipAddr, int port) //, const int subscriberList[10])
 {
   cout << "Adding module " << moduleID << " with IP " << ipAddr << ":" << port << endl;
@@ -49,6 +164,7 @@ int MessageHandler::addModule(int moduleID, string ipAddr, int port) //, const i
     cout << "Failed to set socket options for module " << moduleID << "." << endl;
     return 0;
   }
+  enableMulticast(sock);
 
   /*int bind_sock = bind(sock, (struct sockaddr*) &sockStruct, sockLen);
   if (bind_sock < 0) {
@@ -56,30 +172,234 @@ int MessageHandler::addModule(int moduleID, string ipAddr, int port) //, const i
     return 0;
   }*/
 
-  moduleSubscribers[moduleID] = {};
-  moduleSockets[moduleID] = sock;
-  socketStructs[sock] = sockStruct;
+  shared_ptr<ModuleRing> ring;
+  if (shmEnabled == true) {
+    string ringName = SHARED_RING_PREFIX + to_string(moduleID);
+    SharedRing* sharedRing = SharedRing::create(ringName.c_str());
+    if (sharedRing == NULL) {
+      cout << "Could not create shared memory ring " << ringName << " for module " << moduleID << "." << endl;
+    }
+    else {
+      ring = make_shared<ModuleRing>(sharedRing);
+    }
+  }
+
+  lock_guard<mutex> lock(routingMutex);
+  shared_ptr<RoutingTable> table = copyRoutes();
+  table->moduleSubscribers[moduleID] = {};
+  table->moduleSockets[moduleID] = sock;
+  table->socketStructs[sock] = sockStruct;
+  table->moduleRings.erase(moduleID);
+  if (ring) {
+    table->moduleRings[moduleID] = ring;
+  }
+  table->ringPublishers.erase(moduleID);
+  table->ringSubscribers.erase(moduleID);
+  // A module added again starts without subscriptions: membership and filters go together, since
+  // membership without filters means every message is delivered
+  for (map<int, set<int>>::iterator subIt = table->moduleSubscribers.begin(); subIt != table->moduleSubscribers.end(); ++subIt) {
+    subIt->second.erase(moduleID);
+  }
+  map<pair<int, int>, vector<shared_ptr<const SubscriptionFilter>>>::iterator filterIt = table->subscriptionFilters.begin();
+  while (filterIt != table->subscriptionFilters.end()) {
+    if (filterIt->first.first == moduleID || filterIt->first.second == moduleID) {
+      filterIt = table->subscriptionFilters.erase(filterIt);
+    }
+    else {
+      ++filterIt;
+    }
+  }
+  if (multicastEnabled == true) {
+    table->multicastGroups[moduleID] = groupAddress(moduleID);
+  }
+  set<int> waiting;
+  map<int, set<int>>::iterator pendingIt = pendingSubscriptions.find(moduleID);
+  if (pendingIt != pendingSubscriptions.end()) {
+    waiting.swap(pendingIt->second);
+    pendingSubscriptions.erase(pendingIt);
+  }
+  table->moduleSubscribers[moduleID].insert(waiting.begin(), waiting.end());
+  storeRoutes(table);
   cout << "Added module " << moduleID << ":\t" << inet_ntoa(sockStruct.sin_addr) << ":" << ntohs(sockStruct.sin_port) << endl;
+  for (set<int>::iterator waitIt = waiting.begin(); waitIt != waiting.end(); ++waitIt) {
+    notifyModuleReady(*table, moduleID, *waitIt);
+  }
   return 1;
 }
 
+/**
+ * Sends MODULE_READY to a module whose subscription to moduleID was deferred, see subscribeTo.
+ */
+void MessageHandler::notifyModuleReady(const RoutingTable& table, int moduleID, int waitingID)
+{
+  map<int, int>::const_iterator sockIt = table.moduleSockets.find(waitingID);
+  if (sockIt == table.moduleSockets.end()) {
+    return;
+  }
+  M_MODULE_READY ready;
+  memset(&ready, 0, sizeof(ready));
+  ready.header.serial_no = getMsgNum();
+  ready.header.msg_type = MODULE_READY;
+  ready.header.timestamp = getTimestamp();
+  ready.moduleID = moduleID;
+  const struct sockaddr_in& dest = table.socketStructs.at(sockIt->second);
+  if (sendto(sockIt->second, &ready, sizeof(ready), 0, (const struct sockaddr*) &dest, sizeof(dest)) < 0) {
+    cout << "Could not tell module " << waitingID << " that module " << moduleID << " was added." << endl;
+    return;
+  }
+  cout << "Subscribed module " << waitingID << " to module " << moduleID << endl;
+}
+
+/**
+ * Subscribes to every message of one module. If that module has not been added yet, the
+ * subscription is deferred: it is made when the module is added, and the subscriber is then sent
+ * MODULE_READY, so it does not need to poll.
+ * @param myID ID of the subscribing module
+ * @param subscribeID ID of the module to subscribe to, or 999 for all modules added so far
+ * @return 1 if subscribed, 2 if deferred
+ */
 int MessageHandler::subscribeTo(int myID, int subscribeID) 
 {
+  lock_guard<mutex> lock(routingMutex);
+  shared_ptr<RoutingTable> table = copyRoutes();
+  map<int, set<int>>& moduleSubscribers = table->moduleSubscribers;
   map<int, set<int>>::iterator it = moduleSubscribers.find(subscribeID);
   if (it == moduleSubscribers.end() and subscribeID != 999) {
-    cout << "Could not find module ID " << subscribeID << "." << endl;
-    return 0;
+    pendingSubscriptions[subscribeID].insert(myID);
+    cout << "Module " << subscribeID << " not added yet, module " << myID << " will be subscribed when it is." << endl;
+    return 2;
   }
   if (subscribeID == 999) {
     for (map<int, set<int>>::iterator modIt = moduleSubscribers.begin(); modIt != moduleSubscribers.end(); ++modIt) {
       moduleSubscribers[modIt->first].insert(myID);
+      table->subscriptionFilters.erase(make_pair(modIt->first, myID));
     }
+    storeRoutes(table);
     return 1;
   }
   moduleSubscribers[subscribeID].insert(myID);
+  table->subscriptionFilters.erase(make_pair(subscribeID, myID));
+  storeRoutes(table);
+  return 1;
+}
+
+/**
+ * Subscribes to the messages of one module that have a type in [minType, maxType]. Calling this
+ * again adds another range; calling subscribeTo removes all ranges and subscribes to everything.
+ * @param myID ID of the subscribing module 
+ * @param subscribeID ID of the module to subscribe to, or 999 for all modules
+ * @param minType Smallest message type to receive
+ * @param maxType Largest message type to receive
+ * @param decimation Deliver only every decimation-th matching message, 1 to deliver all of them
+ */
+int MessageHandler::subscribeToTypes(int myID, int subscribeID, int minType, int maxType, int decimation)
+{
+  shared_ptr<SubscriptionFilter> filter = make_shared<SubscriptionFilter>();
+  filter->typeRanges.push_back(make_pair(minType, maxType));
+  filter->decimation = decimation;
+  return addSubscriptionFilter(myID, subscribeID, filter);
+}
+
+/**
+ * Same as subscribeToTypes, for a list of message types rather than a range.
+ */
+int MessageHandler::subscribeToTypeSet(int myID, int subscribeID, vector<int> types, int decimation)
+{
+  shared_ptr<SubscriptionFilter> filter = make_shared<SubscriptionFilter>();
+  filter->types.insert(types.begin(), types.end());
+  filter->decimation = decimation;
+  return addSubscriptionFilter(myID, subscribeID, filter);
+}
+
+int MessageHandler::addSubscriptionFilter(int myID, int subscribeID, shared_ptr<SubscriptionFilter> filter)
+{
+  lock_guard<mutex> lock(routingMutex);
+  shared_ptr<RoutingTable> table = copyRoutes();
+  vector<int> publishers;
+  if (subscribeID == 999) {
+    for (map<int, set<int>>::iterator modIt = table->moduleSubscribers.begin(); modIt != table->moduleSubscribers.end(); ++modIt) {
+      publishers.push_back(modIt->first);
+    }
+  }
+  else if (table->moduleSubscribers.count(subscribeID) == 0) {
+    cout << "Could not find module ID " << subscribeID << "." << endl;
+    return 0;
+  }
+  else {
+    publishers.push_back(subscribeID);
+  }
+  for (size_t i = 0; i < publishers.size(); i++) {
+    pair<int, int> key = make_pair(publishers[i], myID);
+    // An existing subscription without filters already receives everything
+    if (table->moduleSubscribers[publishers[i]].count(myID) > 0 && table->subscriptionFilters.count(key) == 0) {
+      continue;
+    }
+    table->moduleSubscribers[publishers[i]].insert(myID);
+    table->subscriptionFilters[key].push_back(filter);
+  }
+  storeRoutes(table);
   return 1;
 }
 
+/**
+ * Removes a subscription, along with any message type filters on it.
+ */
+int MessageHandler::unsubscribeFrom(int myID, int subscribeID)
+{
+  lock_guard<mutex> lock(routingMutex);
+  shared_ptr<RoutingTable> table = copyRoutes();
+  for (map<int, set<int>>::iterator modIt = table->moduleSubscribers.begin(); modIt != table->moduleSubscribers.end(); ++modIt) {
+    if (subscribeID == 999 || modIt->first == subscribeID) {
+      modIt->second.erase(myID);
+      table->subscriptionFilters.erase(make_pair(modIt->first, myID));
+    }
+  }
+  storeRoutes(table);
+  return 1;
+}
+
+/**
+ * True if a packet should be delivered to a subscriber, given the filters on that subscription.
+ * Packets too short to have a MSG_HEADER are only delivered on unfiltered subscriptions.
+ */
+bool MessageHandler::subscriberWants(const RoutingTable& table, int sendingModule, int receivingModule, const char* packet, int length)
+{
+  map<pair<int, int>, vector<shared_ptr<const SubscriptionFilter>>>::const_iterator it = 
+    table.subscriptionFilters.find(make_pair(sendingModule, receivingModule));
+  if (it == table.subscriptionFilters.end()) {
+    return true;
+  }
+  if (length < (int) sizeof(MSG_HEADER)) {
+    return false;
+  }
+  int msgType;
+  memcpy(&msgType, packet + offsetof(MSG_HEADER, msg_type), sizeof(msgType));
+  bool wanted = false;
+  for (size_t i = 0; i < it->second.size(); i++) {
+    // Every filter is asked, so that each one counts the packet for its own decimation
+    wanted = it->second[i]->accepts(msgType) || wanted;
+  }
+  return wanted;
+}
+
+/**
+ * Lock held while a sendMessage or sendMessages call from a module queues its packets. With several
+ * RPC threads, calls from one module can run at the same time; the lock keeps the packets of each
+ * call together and queues the calls in the order they reach MessageHandler. A module that waits
+ * for each call to return before making the next, as rpc::client::call does, therefore keeps its
+ * order on any number of threads.
+ */
+mutex& MessageHandler::publisherLock(int sendingModule)
+{
+  return publisherLocks[(unsigned int) sendingModule % PUBLISHER_LOCKS];
+}
+
+/**
+ * Queues a packet to be sent to every subscriber of the sending module. The packet goes in the
+ * lane for its message type, and is sent by that lane's thread after this returns.
+ * @return 1 if the packet was queued, 0 if the sending module is unknown. A queued packet can still
+ * fail to send or be dropped from a full lane; getSendFailures counts those.
+ */
 int MessageHandler::sendMessage(vector<char> packet, uint16_t lengthPacket, int sendingModule)
 { 
   /*MSG_HEADER header;
@@ -87,25 +407,559 @@ int MessageHandler::sendMessage(vector<char> packet, uint16_t lengthPacket, int
   if (header.msg_type == CST_CREATE) {
     cout << "RECEIVED CST_CREATE MESSAGE" << endl;
   }*/
-  map<int, set<int>>::iterator it = moduleSubscribers.find(sendingModule);
-  set<int> receivingModules;
-  if (it != moduleSubscribers.end()) {
-    receivingModules = moduleSubscribers[sendingModule];
-    for (set<int>::iterator setIt = receivingModules.begin(); setIt != receivingModules.end(); ++setIt) {
-      int socketNum = moduleSockets[*setIt];
-      struct sockaddr_in sockStruct = socketStructs[socketNum];
-      int socketLen = sizeof(sockStruct);
-      if (sendto(socketNum, &packet[0], lengthPacket, 0, (struct sockaddr*) &(socketStructs[socketNum]), socketLen) < 0) {
-        cout << "Data sending error for module " << sendingModule << " sending to module " << *setIt << "." << endl;
-        return 0;
+  if (loadRoutes()->moduleSubscribers.count(sendingModule) == 0) {
+    cout << "Could not find module" << endl;
+    return 0;
+  }
+  int length = min((int) lengthPacket, (int) packet.size());
+  lock_guard<mutex> lock(publisherLock(sendingModule));
+  enqueuePacket(&packet[0], length, sendingModule);
+  return 1; 
+}
+
+/**
+ * Batched version of sendMessage. Each packet is queued in the lane for its message type, so the
+ * whole batch costs one RPC, and the lanes send it with one sendmmsg call per batch.
+ * @param packets Packets to send, in order. Each packet is sent with its full length.
+ * @param sendingModule ID of the module the packets are from
+ * @return Status of each packet: 1 if it was queued, 0 otherwise. As with sendMessage, sending
+ * happens later, and its failures are counted by getSendFailures.
+ */
+vector<int> MessageHandler::sendMessages(const vector<vector<char>>& packets, int sendingModule)
+{
+  int numPackets = packets.size();
+  vector<int> status(numPackets, 0);
+  if (loadRoutes()->moduleSubscribers.count(sendingModule) == 0) {
+    cout << "Could not find module" << endl;
+    return status;
+  }
+  lock_guard<mutex> lock(publisherLock(sendingModule));
+  for (int i = 0; i < numPackets; i++) {
+    enqueuePacket(packets[i].data(), packets[i].size(), sendingModule);
+    status[i] = 1;
+  }
+  return status;
+}
+
+/**
+ * Starts recording every routed packet to NAME.log, with an index in NAME.idx. See sessionLog.h.
+ * @return 1 if recording started, 0 otherwise
+ */
+int MessageHandler::startSessionRecording(string name)
+{
+  return recorder->start(name);
+}
+
+/**
+ * Stops the session recording and sorts its index.
+ * @return 1 if a recording was stopped, 0 if there was none
+ */
+int MessageHandler::stopSessionRecording()
+{
+  return recorder->stop();
+}
+
+/**
+ * Multicast group that a module's packets are sent to, when multicast is enabled.
+ */
+struct sockaddr_in MessageHandler::groupAddress(int moduleID)
+{
+  struct sockaddr_in group;
+  memset((char *) &group, 0, sizeof(group));
+  group.sin_family = AF_INET;
+  group.sin_port = htons(multicastPort);
+  group.sin_addr.s_addr = htonl(multicastBase + moduleID);
+  return group;
+}
+
+/**
+ * Sets up a sending socket for multicast: packets stay on the local network, go out of the interface
+ * MessageHandler was started on, and loop back to modules on this machine.
+ */
+void MessageHandler::enableMulticast(int sock)
+{
+  if (multicastEnabled == false || sock < 0) {
+    return;
+  }
+  unsigned char ttl = 1;
+  unsigned char loop = 1;
+  struct in_addr interface;
+  interface.s_addr = interfaceAddress;
+  if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+      setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0 ||
+      setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) < 0) {
+    cout << "Failed to set multicast socket options." << endl;
+  }
+}
+
+/**
+ * Multicast group and port that a module's packets are sent to, so that subscribers can join it.
+ * @return The group as "IP:PORT", or an empty string if multicast is disabled
+ */
+string MessageHandler::getMulticastGroup(int moduleID)
+{
+  if (multicastEnabled == false) {
+    return "";
+  }
+  struct sockaddr_in group = groupAddress(moduleID);
+  return string(inet_ntoa(group.sin_addr)) + ":" + to_string(multicastPort);
+}
+
+/**
+ * Tells MessageHandler that a module has joined the multicast group of another module. From then
+ * on, packets from publisherID reach myID through one send to the group instead of a send of their
+ * own. Every packet sent to the group reaches every member, so subscription filters do not apply
+ * to members. 
+ * @return 1 if multicast is enabled, 0 otherwise
+ */
+int MessageHandler::joinMulticast(int myID, int publisherID)
+{
+  if (multicastEnabled == false) {
+    return 0;
+  }
+  lock_guard<mutex> lock(routingMutex);
+  shared_ptr<RoutingTable> table = copyRoutes();
+  table->multicastMembers[publisherID].insert(myID);
+  storeRoutes(table);
+  cout << "Module " << myID << " joined the multicast group of module " << publisherID << endl;
+  return 1;
+}
+
+/**
+ * True if a packet from sendingModule reaches receivingModule through sendingModule's multicast
+ * group.
+ */
+bool MessageHandler::multicastDelivers(const RoutingTable& table, int sendingModule, int receivingModule)
+{
+  if (multicastEnabled == false || table.multicastGroups.count(sendingModule) == 0) {
+    return false;
+  }
+  map<int, set<int>>::const_iterator it = table.multicastMembers.find(sendingModule);
+  return (it != table.multicastMembers.end() && it->second.count(receivingModule) > 0);
+}
+
+/**
+ * Lane of a packet. The periodic data messages (HAPTIC_DATA_STREAM, its V2 and frames, CST_DATA,
+ * CUPS_DATA) and packets without a known type go in the stream lane, so that commands like
+ * HAPTICS_FREEZE_EFFECT never wait behind them. All other messages go in the command lane, which
+ * keeps them in order: Trial Control relies on e.g. a create message, then OBJECT_HANDLE_REGISTER,
+ * then a _BY_HANDLE message arriving in that order, and on SCENE_BEGIN and SCENE_COMMIT bracketing
+ * the messages sent between them.
+ */
+int MessageHandler::laneFor(const char* packet, int length)
+{
+  if (length < (int) sizeof(MSG_HEADER)) {
+    return LANE_STREAM;
+  }
+  int msgType;
+  memcpy(&msgType, packet + offsetof(MSG_HEADER, msg_type), sizeof(msgType));
+  if (msgType == HAPTIC_DATA_STREAM || msgType == HAPTIC_DATA_STREAM_V2 ||
+      msgType == HAPTIC_DATA_FRAME || msgType == CST_DATA || msgType == CUPS_DATA) {
+    return LANE_STREAM;
+  }
+  if (msgType > 0 && msgType < 3000) {
+    return LANE_COMMAND;
+  }
+  return LANE_STREAM;
+}
+
+void MessageHandler::enqueuePacket(const char* packet, int length, int sendingModule)
+{
+  MessageLane& lane = lanes[laneFor(packet, length)];
+  OutgoingPacket outgoing;
+  outgoing.data.assign(packet, packet + length);
+  outgoing.sendingModule = sendingModule;
+  outgoing.ingressNs = getTimestampNs();
+  int msgType = BrokerStats::packetType(packet, length);
+  outgoing.control = (msgType > 0 && msgType < 500);
+  {
+    lock_guard<mutex> lock(lane.queueMutex);
+    if (lane.perPublisher) {
+      lane.publisherQueues[sendingModule].push_back(move(outgoing));
+    }
+    else {
+      if (lane.queueLimit > 0 && lane.queue.size() >= lane.queueLimit) {
+        stats->countDropped(lane.queue.front().sendingModule);
+        lane.queue.pop_front();
+        lane.queued--;
+        if (lane.dropped++ % 1000 == 0) {
+          cout << "The " << lane.name << " lane is full, " << lane.dropped << " packets dropped so far." << endl;
+        }
       }
+      lane.queue.push_back(move(outgoing));
+    }
+    lane.queued++;
+  }
+  lane.queueReady.notify_one();
+}
+
+/**
+ * Moves up to LANE_BATCH_SIZE queued packets of a lane into batch. For the command lane, the
+ * publishers whose next packet is an experiment control message go first, and send all their
+ * control messages up to their next other message; then the other publishers take turns, one
+ * packet at a time. A publisher's packets are always taken oldest first, so control messages go
+ * ahead of other publishers' traffic but never ahead of an earlier packet of their own publisher.
+ * Must be called with the lane's queueMutex held.
+ */
+void MessageHandler::takeBatch(MessageLane& lane, vector<OutgoingPacket>& batch)
+{
+  if (!lane.perPublisher) {
+    while (!lane.queue.empty() && batch.size() < LANE_BATCH_SIZE) {
+      batch.push_back(move(lane.queue.front()));
+      lane.queue.pop_front();
+      lane.queued--;
+    }
+    return;
+  }
+  map<int, deque<OutgoingPacket>>::iterator it;
+  for (it = lane.publisherQueues.begin(); it != lane.publisherQueues.end(); ++it) {
+    while (!it->second.empty() && it->second.front().control && batch.size() < LANE_BATCH_SIZE) {
+      batch.push_back(move(it->second.front()));
+      it->second.pop_front();
+      lane.queued--;
+    }
+  }
+  bool tookAny = true;
+  while (tookAny && batch.size() < LANE_BATCH_SIZE) {
+    tookAny = false;
+    for (it = lane.publisherQueues.begin(); it != lane.publisherQueues.end() && batch.size() < LANE_BATCH_SIZE; ++it) {
+      if (!it->second.empty()) {
+        batch.push_back(move(it->second.front()));
+        it->second.pop_front();
+        lane.queued--;
+        tookAny = true;
+      }
+    }
+  }
+  it = lane.publisherQueues.begin();
+  while (it != lane.publisherQueues.end()) {
+    it = it->second.empty() ? lane.publisherQueues.erase(it) : next(it);
+  }
+}
+
+/**
+ * Sender thread of a lane. Takes up to LANE_BATCH_SIZE queued packets at a time and routes them
+ * through the lane's socket, in the order takeBatch put them in.
+ */
+void MessageHandler::runLane(int laneNum)
+{
+  MessageLane& lane = lanes[laneNum];
+  vector<OutgoingPacket> batch;
+  vector<PacketRef> refs;
+  RouteScratch scratch;
+  while (true) {
+    {
+      unique_lock<mutex> lock(lane.queueMutex);
+      lane.queueReady.wait(lock, [&lane]{return lane.queued > 0;});
+      takeBatch(lane, batch);
+    }
+    refs.clear();
+    for (size_t i = 0; i < batch.size(); i++) {
+      PacketRef ref = {batch[i].data.data(), (int) batch[i].data.size(), batch[i].sendingModule, batch[i].ingressNs};
+      refs.push_back(ref);
+    }
+    shared_ptr<const RoutingTable> table = loadRoutes();
+    routePackets(*table, refs, lane.sock, scratch);
+    batch.clear();
+  }
+}
+
+/**
+ * Sends each packet to every subscriber of its sending module that wants it, with as few sendmmsg
+ * calls on sock as possible, and writes it to the sending module's ring if a subscriber reads that
+ * ring. The packets and the table must stay valid until this returns.
+ */
+void MessageHandler::routePackets(const RoutingTable& table, const vector<PacketRef>& packets, int sock, RouteScratch& scratch)
+{
+  vector<struct iovec>& iovecs = scratch.iovecs;
+  vector<struct mmsghdr>& msgs = scratch.msgs;
+  iovecs.clear();
+  msgs.clear();
+  scratch.msgPackets.clear();
+  for (size_t i = 0; i < packets.size(); i++) {
+    const PacketRef& packet = packets[i];
+    map<int, set<int>>::const_iterator it = table.moduleSubscribers.find(packet.sendingModule);
+    if (it == table.moduleSubscribers.end()) {
+      cout << "Could not find module " << packet.sendingModule << endl;
+      continue;
+    }
+    stats->countIn(packet.sendingModule, BrokerStats::packetType(packet.data, packet.length), packet.length);
+    recorder->record(packet.data, packet.length, packet.sendingModule);
+    bool writeRing = false;
+    bool sendGroup = false;
+    for (set<int>::const_iterator setIt = it->second.begin(); setIt != it->second.end(); ++setIt) {
+      const struct sockaddr_in* destination;
+      if (ringDelivers(table, packet.sendingModule, *setIt)) {
+        stats->countOut(*setIt, packet.length);
+        writeRing = true;
+        continue;
+      }
+      if (multicastDelivers(table, packet.sendingModule, *setIt)) {
+        stats->countOut(*setIt, packet.length);
+        if (sendGroup == true) {
+          continue;
+        }
+        sendGroup = true;
+        destination = &(table.multicastGroups.at(packet.sendingModule));
+      }
+      else if (!subscriberWants(table, packet.sendingModule, *setIt, packet.data, packet.length)) {
+        continue;
+      }
+      else {
+        stats->countOut(*setIt, packet.length);
+        destination = &(table.socketStructs.at(table.moduleSockets.at(*setIt)));
+      }
+      struct iovec iov;
+      iov.iov_base = (void*) packet.data;
+      iov.iov_len = packet.length;
+      iovecs.push_back(iov);
+      struct mmsghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_hdr.msg_name = (void*) destination;
+      msg.msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      msgs.push_back(msg);
+      scratch.msgPackets.push_back(i);
+    }
+    if (writeRing == true) {
+      table.moduleRings.at(packet.sendingModule)->write(packet.data, packet.length);
+    }
+  }
+  // iovecs are linked only now, since iovecs may reallocate while it is being filled
+  for (size_t i = 0; i < msgs.size(); i++) {
+    msgs[i].msg_hdr.msg_iov = &iovecs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  int64_t sendNs = getTimestampNs();
+  for (size_t i = 0; i < packets.size(); i++) {
+    stats->countDelay(packets[i].sendingModule, sendNs - packets[i].ingressNs);
+  }
+  size_t sent = 0;
+  while (sent < msgs.size()) {
+    int res = sendmmsg(sock, &msgs[sent], msgs.size() - sent, 0);
+    if (res < 0) {
+      // Only the first message failed, skip it and carry on with the rest
+      const PacketRef& packet = packets[scratch.msgPackets[sent]];
+      stats->countError(packet.sendingModule, BrokerStats::packetType(packet.data, packet.length));
+      cout << "Data sending error for module " << packet.sendingModule << " sending to " 
+           << inet_ntoa(((struct sockaddr_in*) msgs[sent].msg_hdr.msg_name)->sin_addr) << "." << endl;
+      res = 1;
+    }
+    sent += res;
+  }
+}
+
+/**
+ * Packets queued by sendMessage, sendMessages or the ingest port that were never sent, because
+ * sendto or sendmmsg failed or the lane was full. Modules compare it between calls to notice losses.
+ * Modules with an ID of STATS_MAX_MODULES or more share one counter.
+ */
+uint64_t MessageHandler::getSendFailures(int moduleID)
+{
+  return stats->failures(moduleID);
+}
+
+/**
+ * All traffic counters as a JSON object, see BrokerStats::toJson.
+ */
+string MessageHandler::getStats()
+{
+  return stats->toJson(getTimestamp());
+}
+
+/**
+ * Stats thread. Rewrites the stats file every STATS_INTERVAL seconds.
+ */
+void MessageHandler::writeStats()
+{
+  while (true) {
+    sleep(STATS_INTERVAL);
+    if (stats->writeFile(statsPath, getTimestamp()) == 0) {
+      cout << "Could not write stats file " << statsPath << endl;
+    }
+  }
+}
+
+/**
+ * Name of the shared memory ring that holds packets sent by a module.
+ * @return The ring name, or an empty string if shared memory is disabled or the module has no ring
+ */
+string MessageHandler::getRingName(int moduleID)
+{
+  if (loadRoutes()->moduleRings.count(moduleID) == 0) {
+    return "";
+  }
+  return SHARED_RING_PREFIX + to_string(moduleID);
+}
+
+/**
+ * Switches a module to the shared memory transport. 
+ * @param moduleID ID of the module, which must already have been added
+ * @param publish If 1, the module writes its own packets into its ring instead of calling
+ * sendMessage. MessageHandler forwards them from the ring to any subscribers that use UDP. 
+ * @param subscribe If 1, the module reads packets from the rings of the modules it subscribes to,
+ * and MessageHandler stops sending it UDP copies of packets that are in a ring.
+ * @return 1 on success, 0 if shared memory is disabled or the module has no ring
+ */
+int MessageHandler::useSharedRing(int moduleID, int publish, int subscribe)
+{
+  lock_guard<mutex> lock(routingMutex);
+  shared_ptr<RoutingTable> table = copyRoutes();
+  if (table->moduleRings.count(moduleID) == 0) {
+    cout << "Shared memory is not available for module " << moduleID << "." << endl;
+    return 0;
+  }
+  if (publish == 1) {
+    table->ringPublishers.insert(moduleID);
+  }
+  else {
+    table->ringPublishers.erase(moduleID);
+  }
+  if (subscribe == 1) {
+    table->ringSubscribers.insert(moduleID);
+  }
+  else {
+    table->ringSubscribers.erase(moduleID);
+  }
+  storeRoutes(table);
+  cout << "Module " << moduleID << " uses shared memory to publish: " << publish << ", subscribe: " << subscribe << endl;
+  return 1;
+}
+
+/**
+ * True if a packet from sendingModule reaches receivingModule through sendingModule's ring. This is
+ * only done when MessageHandler is the writer of that ring; packets that a ring publisher sends
+ * through sendMessage anyway go out over UDP.
+ */
+bool MessageHandler::ringDelivers(const RoutingTable& table, int sendingModule, int receivingModule)
+{
+  return (shmEnabled == true && table.ringSubscribers.count(receivingModule) > 0 &&
+          table.moduleRings.count(sendingModule) > 0 && table.ringPublishers.count(sendingModule) == 0);
+}
+
+/**
+ * Port that modules can send packets to directly, each preceded by a MSG_INGEST_PREFIX.
+ * @return The port number, or 0 if the ingest port is disabled
+ */
+int MessageHandler::getIngestPort()
+{
+  return ingestPort;
+}
+
+/**
+ * Ingest thread. Receives batches of packets on the ingest port with recvmmsg and queues each one
+ * in the lane for its message type, like sendMessage, so commands sent to the ingest port do not
+ * wait behind stream data either. Packets from modules that were not added are dropped.
+ */
+void MessageHandler::runIngest()
+{
+  const int prefixLen = sizeof(MSG_INGEST_PREFIX);
+  vector<char> buffers(INGEST_BATCH_SIZE * (MAX_PACKET_LENGTH + prefixLen));
+  struct iovec recvIovecs[INGEST_BATCH_SIZE];
+  struct mmsghdr recvMsgs[INGEST_BATCH_SIZE];
+  for (int i = 0; i < INGEST_BATCH_SIZE; i++) {
+    recvIovecs[i].iov_base = &buffers[i * (MAX_PACKET_LENGTH + prefixLen)];
+    recvIovecs[i].iov_len = MAX_PACKET_LENGTH + prefixLen;
+  }
+
+  while (true) {
+    memset(recvMsgs, 0, sizeof(recvMsgs));
+    for (int i = 0; i < INGEST_BATCH_SIZE; i++) {
+      recvMsgs[i].msg_hdr.msg_iov = &recvIovecs[i];
+      recvMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // Block for the first packet, then take whatever else is already queued
+    int numReceived = recvmmsg(ingestSocket, recvMsgs, INGEST_BATCH_SIZE, MSG_WAITFORONE, NULL);
+    if (numReceived < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      cout << "Error receiving on ingest port, closing it." << endl;
+      break;
+    }
+
+    shared_ptr<const RoutingTable> table = loadRoutes();
+    for (int i = 0; i < numReceived; i++) {
+      int length = recvMsgs[i].msg_len - prefixLen;
+      if (length < (int) sizeof(MSG_HEADER)) {
+        continue;
+      }
+      char* prefixPtr = (char*) recvIovecs[i].iov_base;
+      MSG_INGEST_PREFIX prefix;
+      memcpy(&prefix, prefixPtr, prefixLen);
+      if (table->moduleSubscribers.count(prefix.moduleID) == 0) {
+        continue;
+      }
+      lock_guard<mutex> lock(publisherLock(prefix.moduleID));
+      enqueuePacket(prefixPtr + prefixLen, length, prefix.moduleID);
+    }
+  }
+}
+
+/**
+ * Ring pump thread. Forwards packets that ring publishers write to their own rings to the
+ * subscribers that do not read rings. 
+ */
+void MessageHandler::pumpRings()
+{
+  char packet[MAX_PACKET_LENGTH];
+  // Read position in each publisher's ring. The ring is kept too, to notice when a module is added
+  // again and gets a new ring.
+  map<int, pair<shared_ptr<ModuleRing>, uint64_t>> cursors;
+  while (true) {
+    int forwarded = 0;
+    shared_ptr<const RoutingTable> table = loadRoutes();
+    for (set<int>::const_iterator pubIt = table->ringPublishers.begin(); pubIt != table->ringPublishers.end(); ++pubIt) {
+      const shared_ptr<ModuleRing>& ring = table->moduleRings.at(*pubIt);
+      if (cursors.count(*pubIt) == 0 || cursors[*pubIt].first != ring) {
+        cursors[*pubIt] = make_pair(ring, ring->ring->writeIndex());
+      }
+      const set<int>& receivingModules = table->moduleSubscribers.at(*pubIt);
+      int bytesRead = 0;
+      while ((bytesRead = ring->ring->read(&(cursors[*pubIt].second), packet)) > 0) {
+        forwarded++;
+        recorder->record(packet, bytesRead, *pubIt);
+        int msgType = BrokerStats::packetType(packet, bytesRead);
+        stats->countIn(*pubIt, msgType, bytesRead);
+        int64_t ingressNs = getTimestampNs(); // when the pump read it, the write time is not known
+        bool sentGroup = false;
+        for (set<int>::const_iterator setIt = receivingModules.begin(); setIt != receivingModules.end(); ++setIt) {
+          if (table->ringSubscribers.count(*setIt) > 0) {
+            continue;
+          }
+          int socketNum = table->moduleSockets.at(*setIt);
+          const struct sockaddr_in* destination = &(table->socketStructs.at(socketNum));
+          if (multicastDelivers(*table, *pubIt, *setIt)) {
+            if (sentGroup == true) {
+              stats->countOut(*setIt, bytesRead);
+              continue;
+            }
+            sentGroup = true;
+            destination = &(table->multicastGroups.at(*pubIt));
+          }
+          else if (!subscriberWants(*table, *pubIt, *setIt, packet, bytesRead)) {
+            continue;
+          }
+          stats->countOut(*setIt, bytesRead);
+          if (sendto(socketNum, packet, bytesRead, 0, (struct sockaddr*) destination, sizeof(struct sockaddr_in)) < 0) {
+            stats->countError(*pubIt, msgType);
+            cout << "Data sending error for module " << *pubIt << " sending to module " << *setIt << "." << endl;
+          }
+        }
+        stats->countDelay(*pubIt, getTimestampNs() - ingressNs);
+      }
+    }
+    for (map<int, pair<shared_ptr<ModuleRing>, uint64_t>>::iterator curIt = cursors.begin(); curIt != cursors.end(); ) {
+      if (table->ringPublishers.count(curIt->first) == 0) {
+        curIt = cursors.erase(curIt);
+      }
+      else {
+        ++curIt;
+      }
+    }
+    if (forwarded == 0) {
+      usleep(50);
     }
-    return 1; 
   }
-  
-  cout << "Could not find module" << endl;
-  return 0;
-  
 }
 
 int MessageHandler::testMessage(int val)
@@ -119,6 +973,7 @@ int main(int argc, char *argv[])
   //TODO: Read Ports and IP address from config file
   const char* IP;
   int PORT;
+  bool useSharedMemory = false;
   if (argc <= 2) {
     IP = "127.0.0.1";
     PORT = 8080;
@@ -127,13 +982,67 @@ int main(int argc, char *argv[])
     IP = argv[1];
     PORT = atoi(argv[2]);
   }
-  MessageHandler* mh = new MessageHandler(IP, PORT);
+  int ingestPort = 0;
+  int numThreads = 1;
+  const char* recordingName = NULL;
+  const char* statsFile = NULL;
+  const char* multicastGroup = NULL;
+  int multicastPort = 0;
+  for (int i = 3; i < argc; i++) {
+    if (strcmp(argv[i], "--shm") == 0) {
+      useSharedMemory = true;
+    }
+    else if (strcmp(argv[i], "--ingest") == 0 && i+1 < argc) {
+      ingestPort = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) {
+      numThreads = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--stats") == 0 && i+1 < argc) {
+      statsFile = argv[++i];
+    }
+    else if (strcmp(argv[i], "--record") == 0 && i+1 < argc) {
+      recordingName = argv[++i];
+    }
+    else if (strcmp(argv[i], "--multicast") == 0 && i+2 < argc) {
+      multicastGroup = argv[++i];
+      multicastPort = atoi(argv[++i]);
+    }
+  }
+  MessageHandler* mh = new MessageHandler(IP, PORT, useSharedMemory, ingestPort, multicastGroup, multicastPort, statsFile);
   cout << "Made Message Handler with IP " << IP << " and PORT " << PORT << endl;
   mh->getServer()->bind("getMsgNum", [&mh](){return mh->getMsgNum();});
+  mh->getServer()->bind("getMsgNumBlock", [&mh](int count){return mh->getMsgNumBlock(count);});
   mh->getServer()->bind("getTimestamp", [&mh](){return mh->getTimestamp();});
+  mh->getServer()->bind("getTimestampNs", [&mh](){return mh->getTimestampNs();});
   mh->getServer()->bind("addModule", [&mh](int moduleID, string ipAddr, int port){return mh->addModule(moduleID, ipAddr, port);});
   mh->getServer()->bind("subscribeTo", [&mh](int myID, int subscribeID){return mh->subscribeTo(myID, subscribeID);});
+  mh->getServer()->bind("subscribeToTypes", [&mh](int myID, int subscribeID, int minType, int maxType, int decimation){return mh->subscribeToTypes(myID, subscribeID, minType, maxType, decimation);});
+  mh->getServer()->bind("subscribeToTypeSet", [&mh](int myID, int subscribeID, vector<int> types, int decimation){return mh->subscribeToTypeSet(myID, subscribeID, types, decimation);});
+  mh->getServer()->bind("unsubscribeFrom", [&mh](int myID, int subscribeID){return mh->unsubscribeFrom(myID, subscribeID);});
   mh->getServer()->bind("sendMessage", [&mh](vector<char> packet, uint16_t lengthPacket, int sendingModule){return mh->sendMessage(packet, lengthPacket, sendingModule);});
+  mh->getServer()->bind("sendMessages", [&mh](vector<vector<char>> packets, int sendingModule){return mh->sendMessages(packets, sendingModule);});
+  mh->getServer()->bind("getRingName", [&mh](int moduleID){return mh->getRingName(moduleID);});
+  mh->getServer()->bind("useSharedRing", [&mh](int moduleID, int publish, int subscribe){return mh->useSharedRing(moduleID, publish, subscribe);});
+  mh->getServer()->bind("getIngestPort", [&mh](){return mh->getIngestPort();});
+  mh->getServer()->bind("getMulticastGroup", [&mh](int moduleID){return mh->getMulticastGroup(moduleID);});
+  mh->getServer()->bind("joinMulticast", [&mh](int myID, int publisherID){return mh->joinMulticast(myID, publisherID);});
+  mh->getServer()->bind("startSessionRecording", [&mh](string name){return mh->startSessionRecording(name);});
+  mh->getServer()->bind("stopSessionRecording", [&mh](){return mh->stopSessionRecording();});
+  mh->getServer()->bind("getStats", [&mh](){return mh->getStats();});
+  mh->getServer()->bind("getSendFailures", [&mh](int moduleID){return mh->getSendFailures(moduleID);});
   mh->getServer()->bind("testMessage", [&mh](int val){return mh->testMessage(val);});
+  if (recordingName != NULL) {
+    mh->startSessionRecording(recordingName);
+  }
+  if (numThreads > 1) {
+    // Every RPC handler only reads an immutable routing table, so they can run on several threads.
+    // Calls from one module are kept in order by publisherLock.
+    cout << "Running with " << numThreads << " RPC threads" << endl;
+    mh->getServer()->async_run(numThreads);
+    while (true) {
+      pause();
+    }
+  }
   mh->getServer()->run(); 
 }
@@ -11,35 +11,237 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/ioctl.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include "messageDefinitions.h"
+#include "sharedRing.h"
+#include "SessionRecorder.h"
+#include "BrokerStats.h"
+
+#define INGEST_BATCH_SIZE 64 // datagrams received per recvmmsg call on the ingest port
+#define LANE_BATCH_SIZE 64 // packets a lane sends per sendmmsg call
+#define STREAM_LANE_QUEUE_LIMIT 4096 // packets queued on the stream lane before the oldest are dropped
+
+// Lanes, see laneFor
+#define LANE_COMMAND 0 // control, combined, haptics and graphics messages, in order per publisher
+#define LANE_STREAM 1 // periodic data, may be dropped
+#define NUM_LANES 2
+#define PUBLISHER_LOCKS 64 // locks that keep each module's sendMessage calls whole, shared by moduleID modulo this
+
+#define STATS_INTERVAL 1 // seconds between writes of the stats file
 
 using namespace std::chrono;
 using namespace std;
 
+/**
+ * The shared memory ring of one module, as seen by MessageHandler. MessageHandler may write a
+ * module's ring from several threads, so writes are serialized here to keep a single writer.
+ */
+struct ModuleRing
+{
+  SharedRing* ring;
+  mutex writeMutex;
+
+  ModuleRing(SharedRing* r) : ring(r) {}
+  ~ModuleRing() { delete ring; }
+  int write(const char* packet, uint32_t length)
+  {
+    lock_guard<mutex> lock(writeMutex);
+    return ring->write(packet, length);
+  }
+};
+
+/**
+ * Restricts a subscription to some message types. A packet matches if its msg_type is in one of
+ * the ranges or in the set of types. If decimation is more than 1, only every decimation-th
+ * matching packet is delivered. The count of matching packets is shared by every routing table
+ * that holds this filter, so publishing a new routing table does not reset it.
+ */
+struct SubscriptionFilter
+{
+  vector<pair<int, int>> typeRanges; // inclusive ranges of message types
+  set<int> types;
+  int decimation;
+  mutable atomic<unsigned long> matched{0};
+
+  bool accepts(int msgType) const
+  {
+    bool typeMatch = (types.count(msgType) > 0);
+    for (size_t i = 0; i < typeRanges.size() && !typeMatch; i++) {
+      typeMatch = (msgType >= typeRanges[i].first && msgType <= typeRanges[i].second);
+    }
+    if (typeMatch == false) {
+      return false;
+    }
+    return (decimation <= 1 || matched.fetch_add(1, memory_order_relaxed) % decimation == 0);
+  }
+};
+
+/**
+ * Everything needed to route a packet. The routing table is never modified once it is published:
+ * addModule, subscribeTo and useSharedRing copy the current table, change the copy, and swap it in.
+ * Threads that are routing packets keep using the table they loaded until they are done with it, so
+ * they never wait for, or see half of, a change.
+ */
+struct RoutingTable
+{
+  map<int, set<int>> moduleSubscribers; // map of moduleID to IDs of modules that subscribe to that module
+  map<int, int> moduleSockets; // map of moduleID to socket number 
+  map<int, struct sockaddr_in> socketStructs; //map of socket number to the socket struct
+  map<int, shared_ptr<ModuleRing>> moduleRings; // map of moduleID to the ring that module's packets go in
+  set<int> ringPublishers; // modules that write their own ring instead of calling sendMessage
+  set<int> ringSubscribers; // modules that read rings instead of receiving UDP packets
+  // map of (sending moduleID, receiving moduleID) to the filters on that subscription. A
+  // subscription without filters receives every packet, otherwise a packet is delivered if any
+  // filter accepts it.
+  map<pair<int, int>, vector<shared_ptr<const SubscriptionFilter>>> subscriptionFilters;
+  map<int, struct sockaddr_in> multicastGroups; // map of moduleID to the group its packets go to
+  map<int, set<int>> multicastMembers; // map of moduleID to IDs of modules that joined its group
+};
+
+/**
+ * A packet waiting in a lane to be routed.
+ */
+struct OutgoingPacket
+{
+  vector<char> data;
+  int sendingModule;
+  int64_t ingressNs; // when MessageHandler received the packet, see getTimestampNs
+  bool control; // experiment control message (types 1-499), sent before other publishers' packets
+};
+
+/**
+ * Location of a packet to be routed, without owning it.
+ */
+struct PacketRef
+{
+  const char* data;
+  int length;
+  int sendingModule;
+  int64_t ingressNs;
+};
+
+/**
+ * Buffers used by routePackets. Each routing thread keeps its own, so that they are not
+ * reallocated for every batch.
+ */
+struct RouteScratch
+{
+  vector<struct iovec> iovecs;
+  vector<struct mmsghdr> msgs;
+  vector<int> msgPackets; // index of the packet each message sends
+};
+
+/**
+ * One lane. Packets in a lane are sent by the lane's own thread and socket, so a flood of packets
+ * in one lane never delays the packets of another. The command lane keeps a queue per publisher, so
+ * that each publisher's packets are sent in the order they arrived; see takeBatch. The stream lane
+ * has a single queue.
+ */
+struct MessageLane
+{
+  const char* name;
+  bool perPublisher; // packets are queued in publisherQueues rather than queue
+  deque<OutgoingPacket> queue; // oldest first
+  map<int, deque<OutgoingPacket>> publisherQueues; // sending module to its packets, oldest first
+  size_t queued; // packets in queue and publisherQueues
+  mutex queueMutex;
+  condition_variable queueReady;
+  size_t queueLimit; // 0 for no limit
+  unsigned long dropped;
+  int sock;
+  thread* sender;
+};
+
 class MessageHandler 
 {
   private:
     rpc::server* srv;
     atomic_int msgNum{0};
+    map<int, set<int>> pendingSubscriptions; // moduleID to modules waiting for it, only accessed with routingMutex held
+    void notifyModuleReady(const RoutingTable& table, int moduleID, int waitingID);
     high_resolution_clock::time_point startTime;
-    char msg[MAX_PACKET_LENGTH]; 
-    map<int, set<int>> moduleSubscribers; // map of moduleID to IDs of modules that subscribe to that module
-    map<int, int> moduleSockets; // map of moduleID to socket number 
-    map<int, struct sockaddr_in> socketStructs; //map of socket number to the socket struct
+    shared_ptr<const RoutingTable> routes; // only accessed with atomic_load and atomic_store
+    mutex routingMutex; // serializes changes to the routing table, never taken to route packets
+    shared_ptr<const RoutingTable> loadRoutes();
+    shared_ptr<RoutingTable> copyRoutes();
+    void storeRoutes(shared_ptr<RoutingTable> table);
+    
+    // Shared-memory transport for modules on the same machine, see sharedRing.h
+    bool shmEnabled;
+    thread* ringPump;
+    void pumpRings();
+    bool ringDelivers(const RoutingTable& table, int sendingModule, int receivingModule);
+    bool subscriberWants(const RoutingTable& table, int sendingModule, int receivingModule, const char* packet, int length);
+    int addSubscriptionFilter(int myID, int subscribeID, shared_ptr<SubscriptionFilter> filter);
+
+    // Raw UDP ingest port for the data plane
+    int ingestSocket;
+    int ingestPort;
+    thread* ingestThread;
+    void runIngest();
+
+    // Multicast fan-out, every module's packets go to its own group
+    bool multicastEnabled;
+    in_addr_t multicastBase; // group of module 0, in host byte order
+    int multicastPort;
+    in_addr_t interfaceAddress; // address MessageHandler was started on, multicast is sent from there
+    struct sockaddr_in groupAddress(int moduleID);
+    bool multicastDelivers(const RoutingTable& table, int sendingModule, int receivingModule);
+    void enableMulticast(int sock);
+
+    SessionRecorder* recorder;
+
+    // Lanes for packets from sendMessage and sendMessages
+    MessageLane lanes[NUM_LANES];
+    mutex publisherLocks[PUBLISHER_LOCKS]; // see publisherLock
+    mutex& publisherLock(int sendingModule);
+    static int laneFor(const char* packet, int length);
+    static void takeBatch(MessageLane& lane, vector<OutgoingPacket>& batch);
+    void enqueuePacket(const char* packet, int length, int sendingModule);
+    void runLane(int lane);
+    void routePackets(const RoutingTable& table, const vector<PacketRef>& packets, int sock, RouteScratch& scratch);
+
+    // Traffic counters
+    BrokerStats* stats;
+    string statsPath;
+    thread* statsThread;
+    void writeStats();
 
   public:
-    MessageHandler(const char* address, int iPort);
+    MessageHandler(const char* address, int iPort, bool useSharedMemory, int iIngestPort,
+                   const char* multicastGroup, int iMulticastPort, const char* statsFile);
     rpc::server* getServer();
     int getMsgNum();
+    int getMsgNumBlock(int count);
     double getTimestamp();
+    int64_t getTimestampNs();
     int addModule(int moduleID, string ipAddr, int port); //, const int subscriberList[10]);
     int subscribeTo(int myID, int subscribeID);
+    int subscribeToTypes(int myID, int subscribeID, int minType, int maxType, int decimation);
+    int subscribeToTypeSet(int myID, int subscribeID, vector<int> types, int decimation);
+    int unsubscribeFrom(int myID, int subscribeID);
+    string getRingName(int moduleID);
+    int useSharedRing(int moduleID, int publish, int subscribe);
+    int getIngestPort();
+    int startSessionRecording(string name);
+    int stopSessionRecording();
+    string getStats();
+    uint64_t getSendFailures(int moduleID);
+    string getMulticastGroup(int moduleID);
+    int joinMulticast(int myID, int publisherID);
     int sendMessage(vector<char> packet, uint16_t lengthPacket, int module);
+    vector<int> sendMessages(const vector<vector<char>>& packets, int sendingModule);
     int testMessage(int val);
 };
 
@@ -0,0 +1,317 @@
+#include "SessionRecorder.h"
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/**
+ * @file SessionRecorder.h
+ * @file SessionRecorder.cpp
+ * @brief Broker-side recording of every routed packet.
+ */
+
+MappedFile::MappedFile()
+{
+  fd = -1;
+  data = NULL;
+  capacity = 0;
+  used = 0;
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+/**
+ * Creates the file, replacing any file with the same name, and maps its first chunk.
+ * @return 1 on success, 0 on failure
+ */
+int MappedFile::open(const string& path)
+{
+  close();
+  fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+  if (fd < 0) {
+    cout << "Could not open " << path << " for recording." << endl;
+    return 0;
+  }
+  if (reserve(SESSION_FILE_CHUNK) == 0) {
+    close();
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Makes sure there is room for length more bytes, growing the file and its mapping if needed.
+ */
+int MappedFile::reserve(uint64_t length)
+{
+  if (used + length <= capacity) {
+    return 1;
+  }
+  uint64_t newCapacity = capacity + max((uint64_t) SESSION_FILE_CHUNK, used + length - capacity);
+  if (ftruncate(fd, newCapacity) < 0) {
+    cout << "Could not grow recording file." << endl;
+    return 0;
+  }
+  void* mem;
+  if (data == NULL) {
+    mem = mmap(NULL, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  else {
+    mem = mremap(data, capacity, newCapacity, MREMAP_MAYMOVE);
+  }
+  if (mem == MAP_FAILED) {
+    cout << "Could not map recording file." << endl;
+    return 0;
+  }
+  data = (char*) mem;
+  capacity = newCapacity;
+  return 1;
+}
+
+/**
+ * Appends bytes at the end of the file.
+ * @return 1 on success, 0 if the file could not grow
+ */
+int MappedFile::append(const void* bytes, uint64_t length)
+{
+  if (reserve(length) == 0) {
+    return 0;
+  }
+  memcpy(data + used, bytes, length);
+  used += length;
+  return 1;
+}
+
+/**
+ * Address of a byte that was already appended. Only valid until the next append.
+ */
+char* MappedFile::at(uint64_t offset)
+{
+  return data + offset;
+}
+
+uint64_t MappedFile::size()
+{
+  return used;
+}
+
+/**
+ * Unmaps the file and truncates it to the bytes that were appended.
+ */
+void MappedFile::close()
+{
+  if (data != NULL) {
+    msync(data, used, MS_SYNC);
+    munmap(data, capacity);
+    data = NULL;
+  }
+  if (fd >= 0) {
+    if (ftruncate(fd, used) < 0) {
+      cout << "Could not truncate recording file." << endl;
+    }
+    ::close(fd);
+    fd = -1;
+  }
+  capacity = 0;
+  used = 0;
+}
+
+SessionRecorder::SessionRecorder(high_resolution_clock::time_point clockStart)
+{
+  startTime = clockStart;
+  stopping = false;
+  writer = NULL;
+}
+
+SessionRecorder::~SessionRecorder()
+{
+  stop();
+}
+
+/**
+ * Starts recording to NAME.log and NAME.idx. A recording that is already running is stopped first.
+ * @param name Path of the recording, without extension
+ * @return 1 if recording started, 0 if the files could not be created
+ */
+int SessionRecorder::start(const string& name)
+{
+  lock_guard<mutex> lock(controlMutex);
+  stopLocked();
+  if (logFile.open(name + ".log") == 0 || indexFile.open(name + ".idx") == 0) {
+    logFile.close();
+    indexFile.close();
+    return 0;
+  }
+  SESSION_LOG_HEADER header;
+  memset(&header, 0, sizeof(header));
+  header.version = SESSION_LOG_VERSION;
+  header.startNs = duration_cast<nanoseconds>(high_resolution_clock::now() - startTime).count();
+  header.magic = SESSION_LOG_MAGIC;
+  logFile.append(&header, sizeof(header));
+  header.magic = SESSION_INDEX_MAGIC;
+  indexFile.append(&header, sizeof(header));
+
+  recorded = 0;
+  dropped = 0;
+  {
+    lock_guard<mutex> queueLock(queueMutex);
+    queue.clear(); // late packets from the previous recording
+    stopping = false;
+  }
+  writer = new thread(&SessionRecorder::runWriter, this);
+  recording = true;
+  cout << "Recording session to " << name << ".log" << endl;
+  return 1;
+}
+
+/**
+ * Stops recording once every queued packet is written, then sorts the index.
+ * @return 1 if a recording was stopped, 0 if there was none
+ */
+int SessionRecorder::stop()
+{
+  lock_guard<mutex> lock(controlMutex);
+  return stopLocked();
+}
+
+/**
+ * Does the work of stop. The caller holds controlMutex, so that start can stop the previous
+ * recording and begin the next one without another start or stop getting in between.
+ */
+int SessionRecorder::stopLocked()
+{
+  if (writer == NULL) {
+    return 0;
+  }
+  recording = false;
+  {
+    lock_guard<mutex> queueLock(queueMutex);
+    stopping = true;
+  }
+  queueReady.notify_one();
+  writer->join();
+  delete writer;
+  writer = NULL;
+
+  uint64_t count = recorded.load();
+  SESSION_LOG_HEADER* logHeader = (SESSION_LOG_HEADER*) logFile.at(0);
+  logHeader->count = count;
+  SESSION_LOG_HEADER* indexHeader = (SESSION_LOG_HEADER*) indexFile.at(0);
+  indexHeader->count = count;
+  SESSION_INDEX_ENTRY* entries = (SESSION_INDEX_ENTRY*) indexFile.at(sizeof(SESSION_LOG_HEADER));
+  stable_sort(entries, entries + count, indexEntryLess);
+  indexHeader->sorted = 1;
+  logFile.close();
+  indexFile.close();
+  cout << "Recorded " << count << " packets, " << dropped.load() << " dropped." << endl;
+  return 1;
+}
+
+bool SessionRecorder::isRecording()
+{
+  return recording.load(memory_order_relaxed);
+}
+
+/**
+ * Queues a routed packet to be recorded. Called by the routing threads, and does nothing if there
+ * is no recording.
+ */
+void SessionRecorder::record(const char* packet, int length, int sendingModule)
+{
+  if (recording.load(memory_order_relaxed) == false) {
+    return;
+  }
+  int64_t routedNs = duration_cast<nanoseconds>(high_resolution_clock::now() - startTime).count();
+  {
+    lock_guard<mutex> lock(queueMutex);
+    if (queue.size() >= SESSION_QUEUE_LIMIT) {
+      dropped++;
+      return;
+    }
+    queue.push_back(RecordedPacket());
+    queue.back().data.assign(packet, packet + length);
+    queue.back().sendingModule = sendingModule;
+    queue.back().routedNs = routedNs;
+  }
+  queueReady.notify_one();
+}
+
+/**
+ * Writer thread. Takes everything that is queued at once, so that routing threads only wait for
+ * the queue lock while a swap is done.
+ */
+void SessionRecorder::runWriter()
+{
+  deque<RecordedPacket> pending;
+  while (true) {
+    bool done;
+    {
+      unique_lock<mutex> lock(queueMutex);
+      queueReady.wait(lock, [this]{return stopping || !queue.empty();});
+      pending.swap(queue);
+      done = stopping;
+    }
+    for (size_t i = 0; i < pending.size(); i++) {
+      writePacket(pending[i]);
+    }
+    pending.clear();
+    if (done == true) {
+      // Anything queued after stopping was set came in before recording was cleared
+      lock_guard<mutex> lock(queueMutex);
+      for (size_t i = 0; i < queue.size(); i++) {
+        writePacket(queue[i]);
+      }
+      queue.clear();
+      return;
+    }
+  }
+}
+
+void SessionRecorder::writePacket(const RecordedPacket& packet)
+{
+  SESSION_LOG_RECORD record;
+  record.routedNs = packet.routedNs;
+  record.sendingModule = packet.sendingModule;
+  record.length = packet.data.size();
+
+  SESSION_INDEX_ENTRY entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.msg_type = -1;
+  if (packet.data.size() >= sizeof(MSG_HEADER)) {
+    MSG_HEADER header;
+    memcpy(&header, packet.data.data(), sizeof(header));
+    entry.msg_type = header.msg_type;
+    entry.serial_no = header.serial_no;
+    entry.timestamp = header.timestamp;
+  }
+  entry.offset = logFile.size();
+  entry.sendingModule = packet.sendingModule;
+  entry.length = record.length;
+
+  const char padding[8] = {0};
+  uint64_t paddingLength = sessionRecordSize(record.length) - sizeof(record) - record.length;
+  if (logFile.append(&record, sizeof(record)) == 0 ||
+      logFile.append(packet.data.data(), record.length) == 0 ||
+      logFile.append(padding, paddingLength) == 0 ||
+      indexFile.append(&entry, sizeof(entry)) == 0) {
+    dropped++;
+    return;
+  }
+  recorded++;
+}
+
+uint64_t SessionRecorder::getRecorded()
+{
+  return recorded.load();
+}
+
+uint64_t SessionRecorder::getDropped()
+{
+  return dropped.load();
+}
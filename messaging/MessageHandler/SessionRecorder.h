@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef _SESSIONRECORDER_H_
+#define _SESSIONRECORDER_H_
+
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include "messageDefinitions.h"
+#include "sessionLog.h"
+
+#define SESSION_FILE_CHUNK (64 * 1024 * 1024) // bytes a recording file grows by when it is full
+#define SESSION_QUEUE_LIMIT 65536 // packets waiting to be written before new ones are dropped
+
+using namespace std::chrono;
+using namespace std;
+
+/**
+ * A file that is written by appending to a memory mapping. The file grows by SESSION_FILE_CHUNK at
+ * a time, and is truncated to the bytes actually written when it is closed.
+ */
+class MappedFile
+{
+  private:
+    int fd;
+    char* data;
+    uint64_t capacity;
+    uint64_t used;
+    int reserve(uint64_t length);
+
+  public:
+    MappedFile();
+    ~MappedFile();
+    int open(const string& path);
+    int append(const void* bytes, uint64_t length);
+    char* at(uint64_t offset);
+    uint64_t size();
+    void close();
+};
+
+/**
+ * A packet waiting to be written to the recording.
+ */
+struct RecordedPacket
+{
+  vector<char> data;
+  int sendingModule;
+  int64_t routedNs;
+};
+
+/**
+ * Records every packet MessageHandler routes to a log and index, see sessionLog.h. Routing threads
+ * only copy the packet into a queue; the files are written by the recorder's own thread, so the
+ * recording never slows down routing. If the writer falls more than SESSION_QUEUE_LIMIT packets
+ * behind, packets are dropped from the recording rather than making routing wait.
+ */
+class SessionRecorder
+{
+  private:
+    high_resolution_clock::time_point startTime;
+    atomic<bool> recording{false};
+    mutex controlMutex; // serializes start and stop
+    mutex queueMutex;
+    condition_variable queueReady;
+    deque<RecordedPacket> queue;
+    bool stopping;
+    thread* writer;
+    MappedFile logFile;
+    MappedFile indexFile;
+    atomic<uint64_t> recorded{0};
+    atomic<uint64_t> dropped{0};
+    void runWriter();
+    int stopLocked();
+    void writePacket(const RecordedPacket& packet);
+
+  public:
+    SessionRecorder(high_resolution_clock::time_point clockStart);
+    ~SessionRecorder();
+    int start(const string& name);
+    int stop();
+    bool isRecording();
+    void record(const char* packet, int length, int sendingModule);
+    uint64_t getRecorded();
+    uint64_t getDropped();
+};
+
+#endif
@@ -0,0 +1,294 @@
+#include "Replay.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @file Replay.h
+ * @file Replay.cpp
+ * @brief Re-sends the packets of a session recording through MessageHandler.
+ *
+ * Packets are sent as the modules that originally sent them, at the times given by their MSG_HEADER
+ * timestamps, scaled by the replay speed. Replaying as fast as possible is useful for load testing
+ * parsePacket and the graphics; replaying at 1x reproduces what happened in a session. Packets keep
+ * their original serial numbers and timestamps.
+ */
+
+ReplaySender::ReplaySender(rpc::client* c, const char* mhIP)
+{
+  client = c;
+  pendingModule = -1;
+  ingestSocket = -1;
+  int port = client->call("getIngestPort").as<int>();
+  if (port > 0) {
+    ingestSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    memset((char*) &ingestStruct, 0, sizeof(ingestStruct));
+    ingestStruct.sin_family = AF_INET;
+    ingestStruct.sin_port = htons(port);
+    ingestStruct.sin_addr.s_addr = inet_addr(mhIP);
+    cout << "Replaying through MessageHandler ingest port " << port << endl;
+  }
+}
+
+/**
+ * Sends one packet right away.
+ * @return 1 on success, 0 on failure
+ */
+int ReplaySender::send(const char* packet, int length, int sendingModule)
+{
+  if (ingestSocket >= 0) {
+    MSG_INGEST_PREFIX prefix;
+    prefix.moduleID = sendingModule;
+    prefix.reserved = 0;
+    struct iovec iov[2];
+    iov[0].iov_base = &prefix;
+    iov[0].iov_len = sizeof(prefix);
+    iov[1].iov_base = (void*) packet;
+    iov[1].iov_len = length;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &ingestStruct;
+    msg.msg_namelen = sizeof(ingestStruct);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    return (sendmsg(ingestSocket, &msg, 0) < 0) ? 0 : 1;
+  }
+  vector<char> packetData(packet, packet+length);
+  return client->call("sendMessage", packetData, length, sendingModule).as<int>();
+}
+
+/**
+ * Queues a packet to be sent with others in one sendMessages call. Packets are sent right away if
+ * the ingest port is used, since that costs no round trip.
+ * @return Number of packets that failed to send, from this or earlier queued packets
+ */
+int ReplaySender::queue(const char* packet, int length, int sendingModule)
+{
+  if (ingestSocket >= 0) {
+    return 1 - send(packet, length, sendingModule);
+  }
+  int errors = 0;
+  if (sendingModule != pendingModule || pending.size() >= REPLAY_BATCH_SIZE) {
+    errors = flush();
+  }
+  pendingModule = sendingModule;
+  pending.push_back(vector<char>(packet, packet+length));
+  return errors;
+}
+
+/**
+ * Sends the queued packets.
+ * @return Number of packets that failed to send
+ */
+int ReplaySender::flush()
+{
+  if (pending.empty()) {
+    return 0;
+  }
+  vector<int> status = client->call("sendMessages", pending, pendingModule).as<vector<int>>();
+  pending.clear();
+  int errors = 0;
+  for (size_t i = 0; i < status.size(); i++) {
+    errors += (status[i] == 0);
+  }
+  return errors;
+}
+
+int64_t monotonicNs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * Waits until a CLOCK_MONOTONIC time. Most of the wait is slept with clock_nanosleep, and the last
+ * REPLAY_SPIN_NS is spun, since waking up from a sleep can take longer than that.
+ */
+void sleepUntil(int64_t targetNs)
+{
+  int64_t sleepNs = targetNs - REPLAY_SPIN_NS;
+  if (sleepNs > monotonicNs()) {
+    struct timespec wake;
+    wake.tv_sec = sleepNs / 1000000000;
+    wake.tv_nsec = sleepNs % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {}
+  }
+  while (monotonicNs() < targetNs) {}
+}
+
+void printCounters(const ReplayCounters& counters, int64_t elapsedNs)
+{
+  double seconds = elapsedNs / 1e9;
+  if (seconds <= 0) {
+    seconds = 1e-9;
+  }
+  cout << counters.packets << " packets in " << seconds << " s ("
+       << counters.packets / seconds << " packets/s, " << counters.bytes / seconds / 1e6 << " MB/s), "
+       << counters.errors << " errors, " << counters.late << " late (max " << counters.maxLateNs / 1e6 << " ms)" << endl;
+}
+
+/**
+ * Replays a recording.
+ * @return 1 if the whole recording was replayed, 0 if it could not be read
+ */
+int replaySession(const ReplayOptions& options)
+{
+  string logPath = options.logName + ".log";
+  int fd = open(logPath.c_str(), O_RDONLY);
+  struct stat fileStat;
+  if (fd < 0 || fstat(fd, &fileStat) < 0 || fileStat.st_size < (off_t) sizeof(SESSION_LOG_HEADER)) {
+    cout << "Could not open " << logPath << endl;
+    return 0;
+  }
+  uint64_t fileSize = fileStat.st_size;
+  void* mem = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    cout << "Could not map " << logPath << endl;
+    return 0;
+  }
+  madvise(mem, fileSize, MADV_SEQUENTIAL);
+  const char* log = (const char*) mem;
+  const SESSION_LOG_HEADER* logHeader = (const SESSION_LOG_HEADER*) log;
+  if (logHeader->magic != SESSION_LOG_MAGIC || logHeader->version != SESSION_LOG_VERSION) {
+    cout << logPath << " is not a session log" << endl;
+    munmap(mem, fileSize);
+    return 0;
+  }
+
+  rpc::client* client = new rpc::client(options.mhIP, options.mhPort);
+  if (options.registerIP != NULL) {
+    set<int> modules = options.modules;
+    for (uint64_t offset = sizeof(SESSION_LOG_HEADER); modules.empty() && offset + sizeof(SESSION_LOG_RECORD) <= fileSize; ) {
+      const SESSION_LOG_RECORD* record = (const SESSION_LOG_RECORD*) (log + offset);
+      if (record->length == 0 && record->routedNs == 0) {
+        break;
+      }
+      modules.insert(record->sendingModule);
+      offset += sessionRecordSize(record->length);
+    }
+    for (set<int>::iterator it = modules.begin(); it != modules.end(); ++it) {
+      client->call("addModule", *it, string(options.registerIP), options.registerPort);
+    }
+  }
+  ReplaySender sender(client, options.mhIP);
+
+  ReplayCounters counters;
+  memset(&counters, 0, sizeof(counters));
+  bool started = false;
+  double firstTime = 0.0;
+  int64_t wallStart = 0;
+  int64_t lastTarget = 0;
+  int64_t nextReport = 0;
+  uint64_t offset = sizeof(SESSION_LOG_HEADER);
+  while (offset + sizeof(SESSION_LOG_RECORD) <= fileSize) {
+    const SESSION_LOG_RECORD* record = (const SESSION_LOG_RECORD*) (log + offset);
+    // A recording that was not stopped cleanly ends in zeros
+    if ((record->length == 0 && record->routedNs == 0) || offset + sessionRecordSize(record->length) > fileSize) {
+      break;
+    }
+    const char* packet = log + offset + sizeof(SESSION_LOG_RECORD);
+    int length = record->length;
+    offset += sessionRecordSize(record->length);
+
+    double timestamp = record->routedNs / 1e9;
+    if (length >= (int) sizeof(MSG_HEADER)) {
+      MSG_HEADER header;
+      memcpy(&header, packet, sizeof(header));
+      timestamp = header.timestamp;
+    }
+    if (timestamp < options.fromTime || timestamp >= options.toTime) {
+      continue;
+    }
+    if (!options.modules.empty() && options.modules.count(record->sendingModule) == 0) {
+      continue;
+    }
+    if (started == false) {
+      started = true;
+      firstTime = timestamp;
+      wallStart = monotonicNs();
+      lastTarget = wallStart;
+      nextReport = wallStart + REPLAY_REPORT_INTERVAL;
+    }
+
+    if (options.speed > 0) {
+      // Timestamps from different modules can be slightly out of order, never go back in time
+      int64_t target = wallStart + int64_t((timestamp - firstTime) * 1e9 / options.speed);
+      target = max(target, lastTarget);
+      lastTarget = target;
+      sleepUntil(target);
+      counters.errors += 1 - sender.send(packet, length, record->sendingModule);
+      int64_t lateNs = monotonicNs() - target;
+      if (lateNs > REPLAY_LATE_NS) {
+        counters.late++;
+      }
+      counters.maxLateNs = max(counters.maxLateNs, lateNs);
+    }
+    else {
+      counters.errors += sender.queue(packet, length, record->sendingModule);
+    }
+    counters.packets++;
+    counters.bytes += length;
+
+    int64_t now = monotonicNs();
+    if (now >= nextReport) {
+      printCounters(counters, now - wallStart);
+      nextReport += REPLAY_REPORT_INTERVAL;
+    }
+  }
+  counters.errors += sender.flush();
+  cout << "Replay finished: ";
+  printCounters(counters, monotonicNs() - wallStart);
+  munmap(mem, fileSize);
+  return 1;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    cout << "Usage: replay NAME [MH_IP MH_PORT] [--speed N] [--fast] [--module ID] [--from T] [--to T] [--register IP PORT]" << endl;
+    return 1;
+  }
+  ReplayOptions options;
+  options.logName = argv[1];
+  options.mhIP = "127.0.0.1";
+  options.mhPort = 8080;
+  options.speed = 1.0;
+  options.fromTime = -1e300;
+  options.toTime = 1e300;
+  options.registerIP = NULL;
+  options.registerPort = 0;
+  int i = 2;
+  if (argc > 3 && strncmp(argv[2], "--", 2) != 0) {
+    options.mhIP = argv[2];
+    options.mhPort = atoi(argv[3]);
+    i = 4;
+  }
+  for (; i < argc; i++) {
+    if (strcmp(argv[i], "--speed") == 0 && i+1 < argc) {
+      options.speed = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--fast") == 0) {
+      options.speed = 0;
+    }
+    else if (strcmp(argv[i], "--module") == 0 && i+1 < argc) {
+      options.modules.insert(atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "--from") == 0 && i+1 < argc) {
+      options.fromTime = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--to") == 0 && i+1 < argc) {
+      options.toTime = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--register") == 0 && i+2 < argc) {
+      options.registerIP = argv[++i];
+      options.registerPort = atoi(argv[++i]);
+    }
+  }
+  return (replaySession(options) == 1) ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <stdint.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "rpc/client.h"
+#include "messageDefinitions.h"
+#include "sessionLog.h"
+
+#define REPLAY_SPIN_NS 200000 // the last part of each wait is spun rather than slept, in nanoseconds
+#define REPLAY_LATE_NS 1000000 // a packet sent this much after its time is counted as late
+#define REPLAY_BATCH_SIZE 64 // packets per sendMessages call when replaying as fast as possible
+#define REPLAY_REPORT_INTERVAL 1000000000 // nanoseconds between throughput reports
+
+using namespace std;
+
+/**
+ * How a session log is replayed, from the command line.
+ */
+struct ReplayOptions
+{
+  string logName; // path of the recording, without extension
+  const char* mhIP;
+  int mhPort;
+  double speed; // 1 for original timing, 0 for as fast as possible
+  set<int> modules; // modules whose packets are replayed, all of them if empty
+  double fromTime; // only replay packets with a MSG_HEADER timestamp in [fromTime, toTime)
+  double toTime;
+  const char* registerIP; // if set, replayed modules are added to MessageHandler with this address
+  int registerPort;
+};
+
+/**
+ * Throughput counters of a replay.
+ */
+struct ReplayCounters
+{
+  uint64_t packets;
+  uint64_t bytes;
+  uint64_t errors;
+  uint64_t late; // packets sent more than REPLAY_LATE_NS after their time
+  int64_t maxLateNs;
+};
+
+/**
+ * Sends replayed packets to MessageHandler, through the ingest port if it has one, or through the
+ * sendMessage and sendMessages RPCs otherwise.
+ */
+class ReplaySender
+{
+  private:
+    rpc::client* client;
+    int ingestSocket;
+    struct sockaddr_in ingestStruct;
+    vector<vector<char>> pending;
+    int pendingModule;
+
+  public:
+    ReplaySender(rpc::client* c, const char* mhIP);
+    int send(const char* packet, int length, int sendingModule);
+    int queue(const char* packet, int length, int sendingModule);
+    int flush();
+};
+
+int64_t monotonicNs();
+void sleepUntil(int64_t targetNs);
+void printCounters(const ReplayCounters& counters, int64_t elapsedNs);
+int replaySession(const ReplayOptions& options);
+
+#endif
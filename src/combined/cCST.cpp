@@ -58,26 +58,14 @@ cVector3d* cCST::computeNextPosition(cVector3d toolPos)
     
     M_CST_DATA cstData;
     memset(&cstData, 0, sizeof(cstData));
-    auto packetIdx = controlData.client->async_call("getMsgNum");
-    auto timestamp = controlData.client->async_call("getTimestamp");
-    packetIdx.wait();
-    timestamp.wait();
-    int packetNum = packetIdx.get().as<int>();
-    double currTime = timestamp.get().as<double>();
-    cstData.header.serial_no = packetNum;
-    cstData.header.msg_type = CST_DATA;
-    cstData.header.timestamp = currTime;
+    stampHeader(&cstData.header, CST_DATA);
     cstData.cursorX = currPos->x();
     cstData.cursorY = currPos->y();
     cstData.cursorZ = currPos->z();
     char packet[sizeof(cstData)];
     memcpy(&packet, &cstData, sizeof(cstData));
-    vector<char> packetData(packet, packet+sizeof(packet) / sizeof(char));
-    auto cstInt = controlData.client->async_call("sendMessage", packetData, sizeof(cstData), controlData.MODULE_NUM);    
-    //sendPacket((char *) packet, sizeof(cstData), false);
+    sendPacket(packet, sizeof(cstData));
     usleep(1000);
-    cstInt.wait();
-    auto cstNum = cstInt.get().as<int>();
     return nextPos;
   }
   else {
@@ -212,5 +200,6 @@ void cCST::stopCST()
  */
 void cCST::destructCST()
 {
-  world->deleteChild(visualCursor);
+  world->removeChild(visualCursor);
+  retireObject(visualCursor);
 }
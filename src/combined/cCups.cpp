@@ -46,13 +46,14 @@ cCups::cCups(cWorld* worldPtr, double esc, double l, double bM, double cM):cGene
   ball->setEnabled(true);
   world->addChild(ball);
   
-  //Cup 
-  cupMesh = new cMesh();
-  cMatrix3d* rotationY = new cMatrix3d(0.0, 0.0, -1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0);
-  cMatrix3d* rotationZ = new cMatrix3d(cCosDeg(45), -cSinDeg(45), 0.0, cSinDeg(45), cCosDeg(45), 0.0, 0, 0, 1);
-  cMatrix3d rotation = cMul(*rotationY, *rotationZ);
-  cVector3d cupPos = *startTarget - cVector3d(0.0, cartPos, -pendulumLength+2);
-  cCreateRingSection(cupMesh, 1, 1, pendulumLength, 90, true, 10, 10, cupPos, rotation, cColorf(1.0, 1.0, 0.0, 1.0));
+  //Cup, shared with every other cups task of the same pendulum length
+  cMatrix3d rotationY(0.0, 0.0, -1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0);
+  cMatrix3d rotationZ(cCosDeg(45), -cSinDeg(45), 0.0, cSinDeg(45), cCosDeg(45), 0.0, 0, 0, 1);
+  cupOffset = *startTarget - cVector3d(0.0, cartPos, -pendulumLength+2);
+  cupMesh = graphicsData.geometryCache.ringSection(1, 1, pendulumLength, 90, true, 10, 10);
+  cupMesh->setLocalPos(cupOffset);
+  cupMesh->setLocalRot(cMul(rotationY, rotationZ));
+  cupMesh->m_material->setColorf(1.0, 1.0, 0.0, 1.0);
   cupMesh->setEnabled(true);
   cupMesh->createEffectSurface();
   cupMesh->m_material->setStiffness(hapticsData.hapticDeviceInfo.m_maxLinearStiffness);
@@ -95,14 +96,14 @@ void cCups::graphicsLoopFunction(double dt, cVector3d toolPos, cVector3d toolVel
 {
   if (running == true) {
     // Update cart graphics
-    cupMesh->setLocalPos(0.0, toolPos.y(), 0.0);
+    cupMesh->setLocalPos(cupOffset + cVector3d(0.0, toolPos.y(), 0.0));
 
     // Update ball graphics
 
     double ballX = cartPos - pendulumLength * cSinDeg(ballPos);
     double ballY = pendulumLength - pendulumLength * cCosDeg(ballPos);
-    cVector3d* newBallPos = new cVector3d(0.0, floor(ballX*100)/100, floor(ballY*100)/100);
-    ball->setLocalPos(*newBallPos); //cVector3d(toolPos.x(), floor(ballX*100)/100, floor(ballY*100)/100));
+    cVector3d newBallPos(0.0, floor(ballX*100)/100, floor(ballY*100)/100);
+    ball->setLocalPos(newBallPos); //cVector3d(toolPos.x(), floor(ballX*100)/100, floor(ballY*100)/100));
   }
 }
 
@@ -140,22 +141,12 @@ void cCups::updateNextBallPosition(double dt)
   
   M_CUPS_DATA cupsData;
   memset(&cupsData, 0, sizeof(cupsData));
-  auto packetIdx = controlData.client->async_call("getMsgNum");
-  auto timestamp = controlData.client->async_call("getTimestamp");
-  packetIdx.wait();
-  timestamp.wait();
-  int packetNum = packetIdx.get().as<int>();
-  double currTime = timestamp.get().as<double>();
-  cupsData.header.serial_no = packetNum;
-  cupsData.header.msg_type = CUPS_DATA;
-  cupsData.header.timestamp = currTime;
+  stampHeader(&cupsData.header, CUPS_DATA);
   cupsData.ballPos = ballPos;
   cupsData.cartPos = cartPos;
   char packet[sizeof(cupsData)];
   memcpy(&packet, &cupsData, sizeof(cupsData));
-    vector<char> packetData(packet, packet+sizeof(packet) / sizeof(char));
-
-  auto cupsInt = controlData.client->async_call("sendMessage", packetData, sizeof(cupsData), controlData.MODULE_NUM);    
+  sendPacket(packet, sizeof(cupsData));
 
 }
 
@@ -181,6 +172,12 @@ void cCups::stopCups()
 
 void cCups::destructCups()
 {
-  world->deleteChild(ball);
-  world->deleteChild(cupMesh);
+  world->removeChild(ball);
+  world->removeChild(cupMesh);
+  world->removeChild(start);
+  world->removeChild(stop);
+  retireObject(ball);
+  retireObject(cupMesh);
+  retireObject(start);
+  retireObject(stop);
 }
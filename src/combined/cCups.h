@@ -31,6 +31,7 @@ class cCups: public cGenericMovingObject, public cGenericEffect
     cShapeBox* start;
     cShapeBox* stop;
     cMesh* cupMesh;
+    cVector3d cupOffset; // position of the cup when the cart is at 0
     cVector3d* startTarget;
     cVector3d* stopTarget;
     double ballPos;
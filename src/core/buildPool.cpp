@@ -0,0 +1,129 @@
+#include "buildPool.h"
+#include "core/controller.h"
+#include "messageDispatch.h"
+
+/**
+ * @file buildPool.h
+ * @file buildPool.cpp
+ * @brief Worker threads that build objects from create messages.
+ */
+
+static int64_t monotonicNs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+BuildPool::BuildPool(int numWorkers)
+{
+  stopping = false;
+  for (int i = 0; i < numWorkers; i++) {
+    workers.push_back(thread(&BuildPool::work, this));
+  }
+}
+
+BuildPool::~BuildPool()
+{
+  stop();
+}
+
+/**
+ * Queues a job for the next free worker. Jobs are not necessarily finished in the order they were
+ * submitted.
+ */
+void BuildPool::submit(BuildJob* job)
+{
+  {
+    lock_guard<mutex> guard(lock);
+    jobs.push_back(job);
+  }
+  ready.notify_one();
+}
+
+/**
+ * Queues retired objects from takeReclaimable for a worker to delete, ahead of any build job.
+ */
+void BuildPool::submitReclaimed(RetiredBatch* batch)
+{
+  {
+    lock_guard<mutex> guard(lock);
+    reclaimed.push_back(batch);
+  }
+  ready.notify_one();
+}
+
+/**
+ * Lets the workers finish their current job and waits for them. Queued jobs are dropped.
+ */
+void BuildPool::stop()
+{
+  {
+    lock_guard<mutex> guard(lock);
+    if (stopping) {
+      return;
+    }
+    stopping = true;
+  }
+  ready.notify_all();
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+}
+
+void BuildPool::work()
+{
+  while (true) {
+    BuildJob* job = NULL;
+    RetiredBatch* batch = NULL;
+    {
+      unique_lock<mutex> guard(lock);
+      ready.wait(guard, [this] { return stopping || !jobs.empty() || !reclaimed.empty(); });
+      if (stopping) {
+        return;
+      }
+      if (!reclaimed.empty()) {
+        batch = reclaimed.front();
+        reclaimed.pop_front();
+      } else {
+        job = jobs.front();
+        jobs.pop_front();
+      }
+    }
+    if (batch != NULL) {
+      destroyRetired(batch);
+      continue;
+    }
+    if (job->attached) {
+      finish(job);
+      continue;
+    }
+    int64_t start = monotonicNs();
+    job->built = buildObject(job->packet.data());
+    job->buildNs = monotonicNs() - start;
+    recordHandlerTime(packetMsgType(job->packet.data(), job->packet.size()), job->buildNs);
+    job->done.store(true, memory_order_release);
+  }
+}
+
+/**
+ * Tells trial control that the object of a job is in the world, and frees the job.
+ */
+void BuildPool::finish(BuildJob* job)
+{
+  MSG_HEADER request;
+  memcpy(&request, job->packet.data(), sizeof(request));
+  M_OBJECT_READY readyMsg;
+  memset(&readyMsg, 0, sizeof(readyMsg));
+  stampHeader(&readyMsg.header, OBJECT_READY);
+  readyMsg.msgType = request.msg_type;
+  readyMsg.serialNo = request.serial_no;
+  readyMsg.buildSeconds = job->buildNs / 1e9;
+  readyMsg.readySeconds = (monotonicNs() - job->receivedNs) / 1e9;
+  if (job->built != NULL) {
+    strncpy(readyMsg.objectName, job->built->name.c_str(), MAX_STRING_LENGTH - 1);
+  }
+  sendPacket((const char*) &readyMsg, sizeof(readyMsg));
+  delete job->built;
+  delete job;
+}
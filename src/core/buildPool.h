@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef _BUILDPOOL_H_
+#define _BUILDPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include "core/reclaim.h"
+
+using namespace std;
+
+/**
+ * @file buildPool.h
+ * @brief Worker threads that build objects from create messages.
+ *
+ * Building a pipe, an arrow or a bounding plane means generating meshes and collision trees, which
+ * can take milliseconds. The listener hands these messages to a BuildPool instead of building them
+ * itself, and the haptics thread adds each object to the world once its job is done, in the order
+ * the messages arrived. The workers then tell trial control with M_OBJECT_READY. They also delete the
+ * objects the haptics thread has retired and reclaimed, see reclaim.h.
+ */
+
+#define BUILD_WORKERS 2
+
+struct BuiltObject;
+
+/**
+ * One create message on its way through the pool. The job goes to a worker twice: first to build
+ * the object, then, once the haptics thread has attached it, to send M_OBJECT_READY and free the job.
+ */
+struct BuildJob
+{
+  vector<char> packet;
+  BuiltObject* built; // set by the worker, NULL if the message does not create an object
+  atomic<bool> done{false}; // built is set
+  bool attached; // set by the haptics thread before the job is submitted again
+  int64_t receivedNs;
+  int64_t buildNs;
+};
+
+class BuildPool
+{
+  private:
+    mutex lock;
+    condition_variable ready;
+    deque<BuildJob*> jobs;
+    deque<RetiredBatch*> reclaimed; // retired objects no thread can reach any more
+    vector<thread> workers;
+    bool stopping;
+    void work();
+    void finish(BuildJob* job);
+
+  public:
+    BuildPool(int numWorkers);
+    ~BuildPool();
+    void submit(BuildJob* job);
+    void submitReclaimed(RetiredBatch* batch);
+    void stop();
+};
+
+#endif
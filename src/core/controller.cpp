@@ -1,4 +1,5 @@
 #include "controller.h"
+#include "messageDispatch.h"
 
 /**
  * @file controller.h
@@ -23,14 +24,33 @@ int main(int argc, char* argv[])
   const char* MH_IP;
   int MH_PORT;
 
-  cout << endl;
-  cout << "-----------------------------------" << endl;
-  cout << "CHAI3D" << endl;
-  cout << "-----------------------------------" << endl << endl << endl;
-  cout << "Keyboard Options:" << endl << endl;
-  cout << "[f] - Enable/Disable full screen mode" << endl;
-  cout << "[q] - Exit application" << endl;
-  cout << endl << endl;
+  // Options can go anywhere, the remaining arguments are read by position
+  controlData.hapticsOnly = false;
+  vector<char*> args;
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--haptics-only") == 0) {
+      controlData.hapticsOnly = true;
+    }
+    else {
+      args.push_back(argv[i]);
+    }
+  }
+  argc = args.size();
+  argv = args.data();
+
+  cout << '\n';
+  cout << "-----------------------------------\n";
+  cout << "CHAI3D\n";
+  cout << "-----------------------------------" << "\n\n\n";
+  if (controlData.hapticsOnly) {
+    cout << "Haptics only, no window. Stop with SESSION_END or Ctrl-C\n";
+  }
+  else {
+    cout << "Keyboard Options:" << "\n\n";
+    cout << "[f] - Enable/Disable full screen mode\n";
+    cout << "[q] - Exit application\n";
+  }
+  cout << "\n\n";
   
   controlData.simulationRunning = false;
   controlData.simulationFinished = true;
@@ -38,6 +58,15 @@ int main(int argc, char* argv[])
   controlData.listenerUp = false;
   controlData.streamerUp = false;
   controlData.loggingData = false;
+  controlData.objectGeneration = 0;
+  controlData.contactObjects = new vector<ContactObject>();
+  graphicsData.movingObjects = new vector<cGenericMovingObject*>();
+  controlData.sceneQueue = new SceneQueue();
+  controlData.openTransaction = NULL;
+  controlData.buildPool = new BuildPool(BUILD_WORKERS);
+  controlData.sceneCommandsApplied = 0;
+  controlData.sceneLatencyTicks = 0;
+  controlData.maxSceneLatencyTicks = 0;
 
   // TODO: Set these IP addresses from a config file
   //controlData.LISTENER_IP = "127.0.0.1";
@@ -60,367 +89,321 @@ int main(int argc, char* argv[])
     controlData.MH_PORT = atoi(argv[4]);
   }
   controlData.client = new rpc::client(controlData.MH_IP, controlData.MH_PORT);
+  controlData.streamBatchSize = STREAM_BATCH_SIZE;
+  controlData.streamBatchMicros = STREAM_BATCH_MICROS;
+  controlData.streamFormat = 1;
+  controlData.frameSamples = STREAM_FRAME_SAMPLES;
+  controlData.frameMicros = STREAM_FRAME_MICROS;
   //controlData.SENDER_IPS.push_back("127.0.0.1");
   //controlData.SENDER_IPS.push_back("127.0.0.1");
   //controlData.SENDER_PORTS.push_back(9000);
   //controlData.SENDER_PORTS.push_back(10000);
-  controlData.hapticsOnly = false;
+  registerHandlers();
   
-  if (controlData.hapticsOnly == false) {
-    initDisplay();
-    initScene();
-  }
-
-  initHaptics();
-  startHapticsThread(); 
-  atexit(close);
-  resizeWindowCallback(graphicsData.window, graphicsData.width, graphicsData.height);
-  sleep(2); 
-  openMessagingSocket();
-  int addSuccess = addMessageHandlerModule();
-  if (addSuccess == 0) {
-    cout << "Module addition failed" << endl;
-    close();
+  if (startController() == 0) {
     exit(1);
   }
-  sleep(1);
-  int subscribeSuccess = subscribeToTrialControl();
-  if (subscribeSuccess == 0) {
-    cout << "Subcribe to Trial Control failed" << endl;
-    close();
-    exit(1);
+  if (controlData.hapticsOnly) {
+    superviseHeadless();
+    return(0);
   }
-  sleep(2);
-  startStreamer(); 
-  startListener();
-  cout << "streamer and listener started" << endl;
   
+  enterEpochs(GRAPHICS_READER);
   while (!glfwWindowShouldClose(graphicsData.window)) {
     glfwGetWindowSize(graphicsData.window, &graphicsData.width, &graphicsData.height);
     graphicsData.graphicsClock = clock();
     updateGraphics();
+    quiescent(GRAPHICS_READER);
     glfwSwapBuffers(graphicsData.window);
     glfwPollEvents();
     graphicsData.freqCounterGraphics.signal(1);
   }
+  leaveEpochs(GRAPHICS_READER);
   glfwDestroyWindow(graphicsData.window);
   glfwTerminate();
   return(0);
 }
 
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+  stopRequested = 1;
+}
+
 /**
- * Checks if the haptics and messaging threads have exited yet. The graphics loop is in main, and
- * exits when all other threads are down, so it is not checked here.
+ * Main loop in hapticsOnly mode. Nothing is drawn and moving objects are not updated, so the main
+ * thread only waits for the session to end (SESSION_END, SIGINT or SIGTERM) and reports the haptic
+ * loop rate every HEADLESS_REPORT_INTERVAL seconds. Returns once the session is closed and the
+ * haptics, streamer and listener threads have exited, so that main can return.
+ */
+void superviseHeadless()
+{
+  signal(SIGINT, requestStop);
+  signal(SIGTERM, requestStop);
+  unsigned int lastTicks = hapticsData.deviceTicks.load(memory_order_relaxed);
+  int pollsPerReport = HEADLESS_REPORT_INTERVAL * 1000 / HEADLESS_POLL_MS;
+  int polls = 0;
+  while (controlData.simulationRunning && !stopRequested) {
+    cSleepMs(HEADLESS_POLL_MS);
+    if (++polls == pollsPerReport) {
+      unsigned int ticks = hapticsData.deviceTicks.load(memory_order_relaxed);
+      cout << "Haptic loop: " << (ticks - lastTicks) / HEADLESS_REPORT_INTERVAL << " Hz\n";
+      lastTicks = ticks;
+      polls = 0;
+    }
+  }
+  close();
+  while (controlData.hapticsUp || controlData.streamerUp || controlData.listenerUp) {
+    cSleepMs(HEADLESS_POLL_MS);
+  }
+}
+
+/**
+ * Checks if the threads that use the world, haptics and streamer, have exited yet. The graphics
+ * loop is in main, and the listener may be the thread calling close (SESSION_END), so neither is
+ * checked here.
  */
 bool allThreadsDown()
 {
-  return (controlData.hapticsUp && controlData.listenerUp && controlData.streamerUp);  
+  return (!controlData.hapticsUp && !controlData.streamerUp);
 }
 
 /**
- * Ends the program. This method does so by setting the "simulationRunning" boolean to false. When
- * false, other threads will exit. To exit gracefully, this method waits until all threads have
- * returned before stopping the haptic tool and exiting the graphic interface.
+ * Does the work of close, exactly once.
  */
-void close()
+static void closeController()
 {
   controlData.simulationRunning = false;
+  wakeListener();
+  controlData.buildPool->stop();
+  printHandlerStats();
+  graphicsData.geometryCache.printStats();
+  uint64_t applied = controlData.sceneCommandsApplied;
+  if (applied > 0) {
+    cout << "Scene commands: " << applied << " applied, latency mean "
+         << (double) controlData.sceneLatencyTicks / applied << " ticks, max " << controlData.maxSceneLatencyTicks << " ticks\n";
+  }
   while (!controlData.simulationFinished) {
     controlData.simulationFinished = allThreadsDown();
     cSleepMs(100);
   }
   hapticsData.tool->stop();
-  cout << "Haptic tool stopped" << endl;
+  cout << "Haptic tool stopped\n";
   delete hapticsData.hapticsThread;
-  cout << "Deleted haptics thread" << endl;
+  cout << "Deleted haptics thread\n";
   delete graphicsData.world;
-  cout << "Deleted world" << endl;
+  cout << "Deleted world\n";
   delete hapticsData.handler;
-  cout << "Deleted handler" << endl;
+  cout << "Deleted handler\n";
   closeMessagingSocket();
-  graphicsData.world->deleteAllChildren();
+}
 
+/**
+ * Ends the program. This method does so by setting the "simulationRunning" boolean to false. When
+ * false, other threads will exit. To exit gracefully, this method waits until the haptics and
+ * streamer threads have returned before stopping the haptic tool and deleting the world. Calling it
+ * again, e.g. from atexit after SESSION_END, waits until the first call is done and does nothing else.
+ */
+void close()
+{
+  static once_flag closed;
+  call_once(closed, closeController);
 }
 
 /**
- * This function receives packets from the listener threads and updates the haptic environment
- * variables accordingly.
- * @param packet is a pointer to a char array of bytes
+ * Binds a handle to an object or world effect name.
+ * @return 1 on success, 0 if the handle is out of range
  */
-void parsePacket(char* packet)
+int registerObjectHandle(int handle, const char* name)
 {
-  MSG_HEADER header;
-  memcpy(&header, packet, sizeof(header));
-  int msgType = header.msg_type;
-  switch (msgType)
-  {
-    case SESSION_START:
-    {
-      cout << "Received SESSION_START Message" << endl;
-      break;
-    }
+  if (handle < 0 || handle >= MAX_OBJECT_HANDLES) {
+    cout << "Object handle " << handle << " out of range\n";
+    return 0;
+  }
+  if (handle >= (int) controlData.objectHandles.size()) {
+    ObjectHandle unused;
+    unused.registered = false;
+    unused.object = NULL;
+    unused.effect = NULL;
+    unused.generation = 0;
+    controlData.objectHandles.resize(handle + 1, unused);
+  }
+  ObjectHandle& objectHandle = controlData.objectHandles[handle];
+  if (objectHandle.registered) {
+    controlData.handleByName.erase(objectHandle.name);
+  }
+  objectHandle.name = name;
+  controlData.handleByName[objectHandle.name] = handle;
+  objectHandle.registered = true;
+  // Force a lookup on first use
+  objectHandle.generation = controlData.objectGeneration - 1;
+  return 1;
+}
 
-    case SESSION_END:
-    {
-      cout << "Received SESSION_END Message" << endl;
-      controlData.simulationRunning = false;
-      close();
-      break;
-    }
+/**
+ * Finds what a handle refers to. Names are only looked up again when objects or effects may have
+ * changed since the last use of the handle, so repeated messages on the same object skip the
+ * string hashing.
+ * @return NULL if the handle was never registered
+ */
+ObjectHandle* resolveHandle(int handle)
+{
+  if (handle < 0 || handle >= (int) controlData.objectHandles.size() || !controlData.objectHandles[handle].registered) {
+    cout << "Object handle " << handle << " not registered\n";
+    return NULL;
+  }
+  ObjectHandle* objectHandle = &controlData.objectHandles[handle];
+  if (objectHandle->generation != controlData.objectGeneration) {
+    unordered_map<string, cGenericObject*>::iterator objIt = controlData.objectMap.find(objectHandle->name);
+    objectHandle->object = (objIt == controlData.objectMap.end()) ? NULL : objIt->second;
+    unordered_map<string, cGenericEffect*>::iterator effIt = controlData.worldEffects.find(objectHandle->name);
+    objectHandle->effect = (effIt == controlData.worldEffects.end()) ? NULL : effIt->second;
+    objectHandle->generation = controlData.objectGeneration;
+  }
+  return objectHandle;
+}
 
-    case TRIAL_START:
-    {
-      cout << "Received TRIAL_START Message" << endl;
-      break;
+void removeObject(const string& name)
+{
+  if (controlData.objectMap.find(name) == controlData.objectMap.end()) {
+    cout << name << " not found\n";
+    return;
+  }
+  cGenericObject* objPtr = controlData.objectMap[name];
+  cCST* cst = dynamic_cast<cCST*>(objPtr);
+  if (cst != NULL) {
+    cst->stopCST();
+    cst->destructCST();
+  }
+  cCups* cups = dynamic_cast<cCups*>(objPtr);
+  if (cups != NULL) {
+    cups->stopCups();
+    cups->destructCups();
+  }
+  graphicsData.world->removeChild(objPtr);
+  unordered_map<string, vector<cGenericObject*>>::iterator partsIt = controlData.objectParts.find(name);
+  if (partsIt != controlData.objectParts.end()) {
+    for (size_t i = 0; i < partsIt->second.size(); i++) {
+      graphicsData.world->removeChild(partsIt->second[i]);
+      retireObject(partsIt->second[i]);
     }
-
-    case TRIAL_END:
-    {
-      cout << "Received TRIAL_END Message" << endl;
-      break;
+    controlData.objectParts.erase(partsIt);
+  }
+  cGenericMovingObject* moving = dynamic_cast<cGenericMovingObject*>(objPtr);
+  if (moving != NULL) {
+    removeMovingObject(moving);
+  }
+  cGenericEffect* effect = dynamic_cast<cGenericEffect*>(objPtr);
+  if (effect != NULL) {
+    graphicsData.world->removeEffect(effect);
+    unordered_map<string, cGenericEffect*>::iterator effIt = controlData.worldEffects.begin();
+    while (effIt != controlData.worldEffects.end()) {
+      effIt = (effIt->second == effect) ? controlData.worldEffects.erase(effIt) : next(effIt);
     }
+  }
+  retireObject(objPtr);
+  controlData.objectMap.erase(name);
+  controlData.objectGeneration++;
+}
 
-    case START_RECORDING:
-    {
-      cout << "Received START_RECORDING Message" << endl;
-      M_START_RECORDING recInfo;
-      memcpy(&recInfo, packet, sizeof(recInfo));
-      char* fileName;
-      fileName = recInfo.filename;
-      controlData.dataFile.open(fileName, ofstream::binary);
-      controlData.dataFile.flush();
-      controlData.loggingData = true;
-      break; 
-    }
-
-    case STOP_RECORDING:
-    {
-      cout << "Received STOP_RECORDING Message" << endl;
-      controlData.dataFile.close();
-      controlData.loggingData = false;
-      break;
-    }
-    
-    case REMOVE_OBJECT:
-    {
-      cout << "Received REMOVE_OBJECT Message" << endl;
-      M_REMOVE_OBJECT rmObj;
-      memcpy(&rmObj, packet, sizeof(rmObj));
-      if (controlData.objectMap.find(rmObj.objectName) == controlData.objectMap.end()) {
-        cout << rmObj.objectName << " not found" << endl;
-      }
-      else {
-        cGenericObject* objPtr = controlData.objectMap[rmObj.objectName];
-        graphicsData.world->deleteChild(objPtr);
-        controlData.objectMap.erase(rmObj.objectName);
-      }
-      break;
-    }
-    
-    case RESET_WORLD:
-    {
-      cout << "Received RESET_WORLD Message" << endl;
-      unordered_map<string, cGenericObject*>::iterator objIt = controlData.objectMap.begin();
-      while (objIt != controlData.objectMap.end()) {
-        bool removedObj = graphicsData.world->deleteChild(objIt->second);
-        objIt++;
-      }
-      unordered_map<string, cGenericEffect*>::iterator effIt = controlData.worldEffects.begin();
-      while (effIt != controlData.worldEffects.end()) {
-        bool removedEffect = graphicsData.world->removeEffect(effIt->second);
-        effIt++;
-      }
-      controlData.objectMap.clear();
-      controlData.objectEffects.clear();
-      controlData.worldEffects.clear();
-      break;
+void removeWorldEffect(const string& name)
+{
+  if (controlData.worldEffects.find(name) == controlData.worldEffects.end()) {
+    cout << name << " not found\n";
+  }
+  else {
+    cGenericEffect* fieldEffect = controlData.worldEffects[name];
+    graphicsData.world->removeEffect(fieldEffect);
+    controlData.worldEffects.erase(name);
+    if (dynamic_cast<cGenericObject*>(fieldEffect) == NULL) {
+      retireEffect(fieldEffect); // tasks that are objects too are retired by removeObject
     }
+    controlData.objectGeneration++;
+  }
+}
 
-    case CST_CREATE:
-    {
-      cout << "Received CST_CREATE Message" << endl;
-      M_CST_CREATE cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      cCST* cst = new cCST(graphicsData.world, cstObj.lambdaVal, 
-          cstObj.forceMagnitude, cstObj.visionEnabled, cstObj.hapticEnabled);
-      char* cstName = cstObj.cstName;
-      controlData.objectMap[cstName] = cst;
-      graphicsData.movingObjects.push_back(cst);
-      graphicsData.world->addEffect(cst);
-      controlData.worldEffects[cstName] = cst;
-      break;
-    }
-    case CST_DESTRUCT:
-    {
-      cout << "Received CST_DESTRUCT Message" << endl;
-      M_CST_DESTRUCT cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      if (controlData.objectMap.find(cstObj.cstName) == controlData.objectMap.end()) {
-        cout << cstObj.cstName << " not found" << endl;
-      }
-      else {
-        cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
-        cst->stopCST();
-        cst->destructCST();
-        remove(graphicsData.movingObjects.begin(), graphicsData.movingObjects.end(), cst);
-        controlData.worldEffects.erase(cstObj.cstName);
-        bool removedCST = graphicsData.world->removeEffect(cst);
-      }
-      break;
-    }
-    case CST_START:
-    {
-      cout << "Received CST_START Message" << endl;
-      M_CST_START cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
-      hapticsData.tool->setShowEnabled(false);
-      cst->startCST();
-      break;
-    }
-    case CST_STOP:
-    {
-      cout << "Received CST_STOP Message" << endl;
-      M_CST_STOP cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
-      cst->stopCST();
-      hapticsData.tool->setShowEnabled(true);
-      break;
-    }
-    case CST_SET_VISUAL:
-    {
-      cout << "Received CST_SET_VISUAL Message" << endl;
-      M_CST_SET_VISUAL cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      bool visual = cstObj.visionEnabled;
-      cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
-      cst->setVisionEnabled(visual);
-      break;
-    }
-    case CST_SET_HAPTIC:
-    {
-      cout << "Received CST_SET_HAPTIC Message" << endl;
-      M_CST_SET_HAPTIC cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      bool haptic = cstObj.hapticEnabled;
-      cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
-      cst->setHapticEnabled(haptic);
-      break;
-    }
-    case CST_SET_LAMBDA:
-    {
-      cout << "Received CST_SET_LAMBDA Message" << endl;
-      M_CST_SET_LAMBDA cstObj;
-      memcpy(&cstObj, packet, sizeof(cstObj));
-      double lambda = cstObj.lambdaVal;
-      cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
-      cst->setLambda(lambda);
-      break;
-    }
-    case CUPS_CREATE:
-    {
-      cout << "Received CUPS_CREATE Message" << endl;
-      M_CUPS_CREATE createCups;
-      memcpy(&createCups, packet, sizeof(createCups));
-      cCups* cups = new cCups(graphicsData.world, createCups.escapeAngle, 
-          createCups.pendulumLength, createCups.ballMass, createCups.cartMass);
-      char* cupsName = createCups.cupsName;
-      controlData.objectMap[cupsName] = cups;
-      graphicsData.movingObjects.push_back(cups);
-      graphicsData.world->addEffect(cups);
-      controlData.worldEffects[cupsName] = cups;
-      break;
-    }
-    case CUPS_DESTRUCT:
-    {
-      cout << "Received CUPS_DESTRUCT Message" << endl;
-      M_CUPS_DESTRUCT cupsObj;
-      memcpy(&cupsObj, packet, sizeof(cupsObj));
-      if (controlData.objectMap.find(cupsObj.cupsName) == controlData.objectMap.end()) {
-        cout << cupsObj.cupsName << " not found" << endl;
-      }
-      else {
-        cCups* cups = dynamic_cast<cCups*>(controlData.objectMap[cupsObj.cupsName]);
-        cups->stopCups();
-        cups->destructCups();
-        remove(graphicsData.movingObjects.begin(), graphicsData.movingObjects.end(), cups);
-        controlData.worldEffects.erase(cupsObj.cupsName);
-        bool removedCups = graphicsData.world->removeEffect(cups);
-      }
-      break;
-    }
-    case CUPS_START:
-    {
-      cout << "Received CUPS_START Message" << endl;
-      M_CUPS_START cupsObj;
-      memcpy(&cupsObj, packet, sizeof(cupsObj));
-      cCups* cups = dynamic_cast<cCups*>(controlData.objectMap[cupsObj.cupsName]);
-      hapticsData.tool->setShowEnabled(false);
-      cups->startCups();
-      break;
-    }
-    case CUPS_STOP:
-    {
-      cout << "Received CUPS_STOP Message" << endl;
-      M_CUPS_STOP cupsObj;
-      memcpy(&cupsObj, packet, sizeof(cupsObj));
-      cCups* cups = dynamic_cast<cCups*>(controlData.objectMap[cupsObj.cupsName]);
-      cups->stopCups();
-      hapticsData.tool->setShowEnabled(true);
-      break;
-    }
-    case HAPTICS_SET_ENABLED:
-    {
-      cout << "Received HAPTICS_SET_ENABLED Message" << endl;
-      M_HAPTICS_SET_ENABLED hapticsEnabled;
-      memcpy(&hapticsEnabled, packet, sizeof(hapticsEnabled));
-      char* objectName;
-      objectName = hapticsEnabled.objectName;
-      if (controlData.objectMap.find(objectName) == controlData.objectMap.end()) {
-        cout << objectName << " not found" << endl;
-      }
-      else {
-        if (hapticsEnabled.enabled == 1) {
-          controlData.objectMap[objectName]->setHapticEnabled(true);
-        }
-        else if (hapticsEnabled.enabled == 0) {
-          controlData.objectMap[objectName]->setHapticEnabled(false);
-        }
-      }
-      break;
-    }
+/**
+ * Adds an object to the list of objects the graphics thread moves. The list is copied, so the
+ * graphics thread can keep iterating over the old one. Must only be called by the haptics thread.
+ */
+void addMovingObject(cGenericMovingObject* object)
+{
+  const vector<cGenericMovingObject*>* current = graphicsData.movingObjects.load(memory_order_relaxed);
+  vector<cGenericMovingObject*>* updated = new vector<cGenericMovingObject*>(*current);
+  updated->push_back(object);
+  graphicsData.movingObjects.store(updated, memory_order_release);
+  retireList(current);
+}
 
-    case HAPTICS_SET_ENABLED_WORLD:
-    {
-      M_HAPTICS_SET_ENABLED_WORLD worldEnabled;
-      memcpy(&worldEnabled, packet, sizeof(worldEnabled));
-      char* effectName;
-      effectName = worldEnabled.effectName;
-      cGenericEffect* fieldEffect = controlData.worldEffects[effectName];
-      fieldEffect->setEnabled(worldEnabled.enabled);
-      break; 
-    }
+/**
+ * Takes an object out of the list of objects the graphics thread moves. Must only be called by the
+ * haptics thread.
+ */
+void removeMovingObject(cGenericMovingObject* object)
+{
+  const vector<cGenericMovingObject*>* current = graphicsData.movingObjects.load(memory_order_relaxed);
+  vector<cGenericMovingObject*>* updated = new vector<cGenericMovingObject*>(*current);
+  updated->erase(remove(updated->begin(), updated->end(), object), updated->end());
+  graphicsData.movingObjects.store(updated, memory_order_release);
+  retireList(current);
+}
 
-    case HAPTICS_SET_STIFFNESS:
-    {
-      cout << "Received HAPTICS_SET_STIFFNESS Message" << endl;
-      M_HAPTICS_SET_STIFFNESS stiffness;
-      memcpy(&stiffness, packet, sizeof(stiffness));
-      char* objectName;
-      objectName = stiffness.objectName;
-      if (controlData.objectMap.find(objectName) == controlData.objectMap.end()) {
-        cout << objectName << " not found" << endl;
-      }
-      else {
-        controlData.objectMap[objectName]->m_material->setStiffness(stiffness.stiffness);
-      }
-      break;
-    }
+/**
+ * Gives the streamer a new copy of objectMap and handleByName. Must only be called by the haptics
+ * thread, after objects or handles have changed.
+ */
+void publishContactObjects()
+{
+  vector<ContactObject>* updated = new vector<ContactObject>();
+  updated->reserve(controlData.objectMap.size());
+  unordered_map<string, cGenericObject*>::iterator objIt;
+  for (objIt = controlData.objectMap.begin(); objIt != controlData.objectMap.end(); objIt++) {
+    ContactObject contact;
+    contact.name = objIt->first;
+    contact.object = objIt->second;
+    unordered_map<string, int>::iterator handleIt = controlData.handleByName.find(objIt->first);
+    contact.handle = (handleIt == controlData.handleByName.end()) ? -1 : handleIt->second;
+    updated->push_back(contact);
+  }
+  const vector<ContactObject>* current = controlData.contactObjects.exchange(updated, memory_order_acq_rel);
+  retireList(current);
+}
+
+/**
+ * True for messages that refer to objects by handle and leave the set of named objects alone. All
+ * other messages may add, replace or remove named objects, so they invalidate cached lookups.
+ */
+static bool isHandleMessage(int msgType)
+{
+  switch (msgType)
+  {
+    case OBJECT_HANDLE_REGISTER:
+    case HAPTICS_SET_ENABLED_BY_HANDLE:
+    case HAPTICS_SET_ENABLED_WORLD_BY_HANDLE:
+    case HAPTICS_SET_STIFFNESS_BY_HANDLE:
+    case GRAPHICS_SET_ENABLED_BY_HANDLE:
+    case GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE:
+      return true;
+    default:
+      return false;
+  }
+}
 
+/**
+ * Builds the object a message creates, without adding it to the world.
+ * @return NULL if the message does not create an object
+ */
+BuiltObject* buildObject(const char* packet)
+{
+  MSG_HEADER header;
+  memcpy(&header, packet, sizeof(header));
+  BuiltObject* built = new BuiltObject();
+  built->moving = NULL;
+  switch (header.msg_type)
+  {
     case HAPTICS_BOUNDING_PLANE:
     {
-      cout << "Received HAPTICS_BOUNDING_PLANE Message" << endl;
       M_HAPTICS_BOUNDING_PLANE bpMsg;
       memcpy(&bpMsg, packet, sizeof(bpMsg));
       double bWidth = bpMsg.bWidth;
@@ -428,196 +411,881 @@ void parsePacket(char* packet)
       int stiffness = hapticsData.hapticDeviceInfo.m_maxLinearStiffness;
       double toolRadius = hapticsData.toolRadius;
       cBoundingPlane* bp = new cBoundingPlane(stiffness, toolRadius, bWidth, bHeight);
-      graphicsData.world->addChild(bp->getLowerBoundingPlane());
-      graphicsData.world->addChild(bp->getUpperBoundingPlane());
-      graphicsData.world->addChild(bp->getTopBoundingPlane());
-      graphicsData.world->addChild(bp->getBottomBoundingPlane());
-      graphicsData.world->addChild(bp->getLeftBoundingPlane());
-      graphicsData.world->addChild(bp->getRightBoundingPlane());
-      controlData.objectMap["boundingPlane"] = bp;
-      break;
-    }
-    
-    case HAPTICS_CONSTANT_FORCE_FIELD:
-    {
-      cout << "Received HAPTICS_CONSTANT_FORCE_FIELD Message" << endl;
-      M_HAPTICS_CONSTANT_FORCE_FIELD cffInfo;
-      memcpy(&cffInfo, packet, sizeof(cffInfo));
-      double d = cffInfo.direction;
-      double m = cffInfo.magnitude;
-      cConstantForceFieldEffect* cFF = new cConstantForceFieldEffect(graphicsData.world, d, m);
-      graphicsData.world->addEffect(cFF);
-      controlData.worldEffects[cffInfo.effectName] = cFF;
+      built->children.push_back(bp->getLowerBoundingPlane());
+      built->children.push_back(bp->getUpperBoundingPlane());
+      built->children.push_back(bp->getTopBoundingPlane());
+      built->children.push_back(bp->getBottomBoundingPlane());
+      built->children.push_back(bp->getLeftBoundingPlane());
+      built->children.push_back(bp->getRightBoundingPlane());
+      built->name = "boundingPlane";
+      built->object = bp;
       break;
     }
-
-    case HAPTICS_VISCOSITY_FIELD:
-    {
-      cout << "Received HAPTICS_VISCOSITY_FIELD Message" << endl;
-      M_HAPTICS_VISCOSITY_FIELD vF;
-      memcpy(&vF, packet, sizeof(vF));
-      cMatrix3d* B = new cMatrix3d(vF.viscosityMatrix[0], vF.viscosityMatrix[1], vF.viscosityMatrix[2],
-                                   vF.viscosityMatrix[3], vF.viscosityMatrix[4], vF.viscosityMatrix[5],
-                                   vF.viscosityMatrix[6], vF.viscosityMatrix[7], vF.viscosityMatrix[8]);
-      cViscosityEffect* vFF = new cViscosityEffect(graphicsData.world, B);
-      graphicsData.world->addEffect(vFF);
-      controlData.worldEffects[vF.effectName] = vFF;
-      break;
-    }
-    
-    case HAPTICS_FREEZE_EFFECT:
-    {
-      cout << "Received HAPTICS_FREEZE_EFFECT Message" << endl;
-      M_HAPTICS_FREEZE_EFFECT freeze;
-      memcpy(&freeze, packet, sizeof(freeze));
-      double workspaceScaleFactor = hapticsData.tool->getWorkspaceScaleFactor();
-      double maxStiffness = 1.5*hapticsData.hapticDeviceInfo.m_maxLinearStiffness/workspaceScaleFactor;
-      cVector3d currentPos = hapticsData.tool->getDeviceGlobalPos();
-      cFreezeEffect* freezeEff = new cFreezeEffect(graphicsData.world, maxStiffness, currentPos);
-      graphicsData.world->addEffect(freezeEff);
-      controlData.worldEffects[freeze.effectName] = freezeEff;
-      break;  
-    }
-
-    case HAPTICS_REMOVE_WORLD_EFFECT:
-    {
-      cout << "Received HAPTICS_REMOVE_FIELD_EFFECT Message" << endl;
-      M_HAPTICS_REMOVE_WORLD_EFFECT rmField;
-      memcpy(&rmField, packet, sizeof(rmField));
-      cGenericEffect* fieldEffect = controlData.worldEffects[rmField.effectName];
-      graphicsData.world->removeEffect(fieldEffect);
-      controlData.worldEffects.erase(rmField.effectName);
-      break;
-    }
-
-    case GRAPHICS_SET_ENABLED:
-    {
-      cout << "Received GRAPHICS_SET_ENABLED Message" << endl;
-      M_GRAPHICS_SET_ENABLED graphicsEnabled;
-      memcpy(&graphicsEnabled, packet, sizeof(graphicsEnabled));
-      char* objectName;
-      objectName = graphicsEnabled.objectName;
-      int enabled = graphicsEnabled.enabled;
-      if (controlData.objectMap.find(objectName) == controlData.objectMap.end()) {
-        cout << objectName << " not found" << endl;
-      }
-      else {
-        if (graphicsEnabled.enabled == 1) {
-          controlData.objectMap[objectName]->setShowEnabled(true);
-        }
-        else if (graphicsEnabled.enabled == 0) {
-          controlData.objectMap[objectName]->setShowEnabled(false);
-        }
-      }
-      break;
-    }
-    
-    case GRAPHICS_CHANGE_BG_COLOR:
-    {
-      cout << "Received GRAPHICS_CHANGE_BG_COLOR Message" << endl;
-      M_GRAPHICS_CHANGE_BG_COLOR bgColor;
-      memcpy(&bgColor, packet, sizeof(bgColor));
-      float red = bgColor.color[0]/250.0;
-      float green = bgColor.color[1]/250.0;
-      float blue = bgColor.color[2]/250.0;
-      graphicsData.world->setBackgroundColor(red, green, blue);
-      break;
-    }
-    
     case GRAPHICS_PIPE:
     {
-      cout << "Received GRAPHICS_PIPE Message" << endl;
       M_GRAPHICS_PIPE pipe;
       memcpy(&pipe, packet, sizeof(pipe));
-      cVector3d* position = new cVector3d(pipe.position[0], pipe.position[1], pipe.position[2]);
-      cMatrix3d* rotation = new cMatrix3d(pipe.rotation[0], pipe.rotation[1], pipe.rotation[2],
-                                          pipe.rotation[3], pipe.rotation[4], pipe.rotation[5],
-                                          pipe.rotation[6], pipe.rotation[7], pipe.rotation[8]);
-      cColorf* color = new cColorf(pipe.color[0], pipe.color[1], pipe.color[2], pipe.color[3]);
-      cPipe* myPipe = new cPipe(pipe.height, pipe.innerRadius, pipe.outerRadius, pipe.numSides, 
-                                pipe.numHeightSegments, position, rotation, color);
-      controlData.objectMap[pipe.objectName] = myPipe->getPipeObj();
-      graphicsData.world->addChild(myPipe->getPipeObj());
+      cVector3d position(pipe.position[0], pipe.position[1], pipe.position[2]);
+      cMatrix3d rotation(pipe.rotation[0], pipe.rotation[1], pipe.rotation[2],
+                         pipe.rotation[3], pipe.rotation[4], pipe.rotation[5],
+                         pipe.rotation[6], pipe.rotation[7], pipe.rotation[8]);
+      cColorf color(pipe.color[0], pipe.color[1], pipe.color[2], pipe.color[3]);
+      cPipe myPipe(pipe.height, pipe.innerRadius, pipe.outerRadius, pipe.numSides, 
+                   pipe.numHeightSegments, position, rotation, color);
+      built->name = string(pipe.objectName, strnlen(pipe.objectName, MAX_STRING_LENGTH));
+      built->object = myPipe.getPipeObj();
+      built->children.push_back(myPipe.getPipeObj());
       break;
     }
-
     case GRAPHICS_ARROW:
     {
-      cout << "Received GRAPHICS_ARROW Message" << endl;
       M_GRAPHICS_ARROW arrow;
       memcpy(&arrow, packet, sizeof(arrow));
-      cVector3d* direction = new cVector3d(arrow.direction[0], arrow.direction[1], arrow.direction[2]);
-      cVector3d* position = new cVector3d(arrow.position[0], arrow.position[1], arrow.position[2]);
-      cColorf* color = new cColorf(arrow.color[0], arrow.color[1], arrow.color[2], arrow.color[3]);
-      cArrow* myArrow = new cArrow(arrow.aLength, arrow.shaftRadius, arrow.lengthTip, arrow.radiusTip,
-                                    arrow.bidirectional, arrow.numSides, direction, position, color);
-      controlData.objectMap[arrow.objectName] = myArrow->getArrowObj();
-      graphicsData.world->addChild(myArrow->getArrowObj());
-      break;
-    }
-    
-    case GRAPHICS_CHANGE_OBJECT_COLOR:
-    {
-      cout << "Received GRAPHICS_CHANGE_OBJECT_COLOR Message" << endl;
-      M_GRAPHICS_CHANGE_OBJECT_COLOR color;
-      memcpy(&color, packet, sizeof(color));
-      cGenericObject* obj = controlData.objectMap[color.objectName];
-      obj->m_material->setColorf(color.color[0], color.color[1], color.color[2], color.color[3]);
+      cVector3d direction(arrow.direction[0], arrow.direction[1], arrow.direction[2]);
+      cVector3d position(arrow.position[0], arrow.position[1], arrow.position[2]);
+      cColorf color(arrow.color[0], arrow.color[1], arrow.color[2], arrow.color[3]);
+      cArrow myArrow(arrow.aLength, arrow.shaftRadius, arrow.lengthTip, arrow.radiusTip,
+                     arrow.bidirectional, arrow.numSides, direction, position, color);
+      built->name = string(arrow.objectName, strnlen(arrow.objectName, MAX_STRING_LENGTH));
+      built->object = myArrow.getArrowObj();
+      built->children.push_back(myArrow.getArrowObj());
       break;
     }
     case GRAPHICS_MOVING_DOTS:
     {
-      cout << "Received GRAPHICS_MOVING_DOTS Message" << endl;
-      cMultiPoint* test = new cMultiPoint();
       M_GRAPHICS_MOVING_DOTS dots;
       memcpy(&dots, packet, sizeof(dots));
-      char* objectName;
-      objectName = dots.objectName;
       cMovingDots* md = new cMovingDots(dots.numDots, dots.coherence, dots.direction, dots.magnitude);
-      controlData.objectMap[objectName] = md;
-      graphicsData.movingObjects.push_back(md);
-      graphicsData.world->addChild(md->getMovingPoints());
-      graphicsData.world->addChild(md->getRandomPoints());
+      built->name = string(dots.objectName, strnlen(dots.objectName, MAX_STRING_LENGTH));
+      built->object = md;
+      built->moving = md;
+      built->children.push_back(md->getMovingPoints());
+      built->children.push_back(md->getRandomPoints());
       break;
     }
     case GRAPHICS_SHAPE_BOX:
     {
-      cout << "Received GRAPHICS_SHAPE_BOX Message" << endl;
       M_GRAPHICS_SHAPE_BOX box;
       memcpy(&box, packet, sizeof(box));
       cShapeBox* boxObj = new cShapeBox(box.sizeX, box.sizeY, box.sizeZ);
       boxObj->setLocalPos(box.localPosition[0], box.localPosition[1], box.localPosition[2]);
       boxObj->m_material->setColorf(box.color[0], box.color[1], box.color[2], box.color[3]);
-      controlData.objectMap[box.objectName] = boxObj;
-      graphicsData.world->addChild(boxObj);
+      built->name = string(box.objectName, strnlen(box.objectName, MAX_STRING_LENGTH));
+      built->object = boxObj;
+      built->children.push_back(boxObj);
       break;
     }
-    case GRAPHICS_SHAPE_SPHERE: 
+    case GRAPHICS_SHAPE_SPHERE:
     {
-      cout << "Received GRAPHICS_SHAPE_SPHERE Message" << endl;
       M_GRAPHICS_SHAPE_SPHERE sphere;
       memcpy(&sphere, packet, sizeof(sphere));
       cShapeSphere* sphereObj = new cShapeSphere(sphere.radius);
       sphereObj->setLocalPos(sphere.localPosition[0], sphere.localPosition[1], sphere.localPosition[2]);
       sphereObj->m_material->setColorf(sphere.color[0], sphere.color[1], sphere.color[2], sphere.color[3]);
-      controlData.objectMap[sphere.objectName] = sphereObj;
-      graphicsData.world->addChild(sphereObj);
+      built->name = string(sphere.objectName, strnlen(sphere.objectName, MAX_STRING_LENGTH));
+      built->object = sphereObj;
+      built->children.push_back(sphereObj);
       break;
     }
     case GRAPHICS_SHAPE_TORUS:
     {
-      cout << "Received GRAPHICS_SHAPE_TORUS Message" << endl;
       M_GRAPHICS_SHAPE_TORUS torus;
       memcpy(&torus, packet, sizeof(torus));
       cShapeTorus* torusObj = new cShapeTorus(torus.innerRadius, torus.outerRadius);
-      graphicsData.world->addChild(torusObj);
       torusObj->setLocalPos(0.0, 0.0, 0.0);
       torusObj->m_material->setStiffness(1.0);
       torusObj->m_material->setColorf(255.0, 255.0, 255.0, 1.0);
       cEffectSurface* torusEffect = new cEffectSurface(torusObj);
       torusObj->addEffect(torusEffect);
-      controlData.objectMap[torus.objectName] = torusObj;
-      break; 
+      built->name = string(torus.objectName, strnlen(torus.objectName, MAX_STRING_LENGTH));
+      built->object = torusObj;
+      built->children.push_back(torusObj);
+      break;
     }
+    default:
+      delete built;
+      return NULL;
   }
+  return built;
+}
+
+/**
+ * Adds a built object to the world and to objectMap. Must only be called by the haptics thread.
+ */
+void attachObject(BuiltObject* built)
+{
+  if (built == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < built->children.size(); i++) {
+    graphicsData.world->addChild(built->children[i]);
+  }
+  if (built->children.size() != 1 || built->children[0] != built->object) {
+    controlData.objectParts[built->name] = built->children;
+  }
+  if (built->moving != NULL) {
+    addMovingObject(built->moving);
+  }
+  controlData.objectMap[built->name] = built->object;
+  controlData.objectGeneration++;
+}
+
+/**
+ * True for messages that buildObject builds an object for.
+ */
+bool isBuildMessage(int msgType)
+{
+  switch (msgType)
+  {
+    case HAPTICS_BOUNDING_PLANE:
+    case GRAPHICS_PIPE:
+    case GRAPHICS_ARROW:
+    case GRAPHICS_MOVING_DOTS:
+    case GRAPHICS_SHAPE_BOX:
+    case GRAPHICS_SHAPE_SPHERE:
+    case GRAPHICS_SHAPE_TORUS:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Hands a create message to the BuildPool. Called by the listener.
+ */
+BuildJob* submitBuild(const char* packet, int length)
+{
+  cout << "Received " << messageName(packetMsgType(packet, length)) << " Message\n";
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  BuildJob* job = new BuildJob();
+  job->packet.assign(packet, packet + length);
+  job->built = NULL;
+  job->attached = false;
+  job->receivedNs = now.tv_sec * 1000000000LL + now.tv_nsec;
+  job->buildNs = 0;
+  controlData.buildPool->submit(job);
+  return job;
+}
+
+/**
+ * Adds the object of a finished build job to the world, then hands the job back to the BuildPool to
+ * report it to trial control. Must only be called by the haptics thread.
+ */
+void publishBuild(BuildJob* job)
+{
+  attachObject(job->built);
+  job->attached = true;
+  controlData.buildPool->submit(job);
+}
+
+/**
+ * Adds a scene message to the open transaction. Objects start building right away, so that the
+ * commit only has to attach them.
+ */
+void stageSceneMessage(const char* packet, int length)
+{
+  SceneStep step;
+  step.packet.assign(packet, packet + length);
+  step.build = isBuildMessage(packetMsgType(packet, length)) ? submitBuild(packet, length) : NULL;
+  controlData.openTransaction->steps.push_back(step);
+}
+
+/**
+ * True once every object of a transaction has been built.
+ */
+static bool transactionBuilt(SceneTransaction* transaction)
+{
+  for (size_t i = 0; i < transaction->steps.size(); i++) {
+    BuildJob* job = transaction->steps[i].build;
+    if (job != NULL && !job->done.load(memory_order_acquire)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Applies all messages of a transaction, in order, and frees it. Must only be called by the haptics
+ * thread.
+ */
+void applySceneTransaction(SceneTransaction* transaction)
+{
+  for (size_t i = 0; i < transaction->steps.size(); i++) {
+    SceneStep& step = transaction->steps[i];
+    if (step.build != NULL) {
+      publishBuild(step.build);
+    }
+    else {
+      applyPacket(step.packet.data());
+    }
+  }
+  cout << "Committed scene transaction of " << transaction->steps.size() << " messages\n";
+  delete transaction;
+}
+
+/**
+ * True for messages that change the world or the objects in it. These are applied by the haptics
+ * thread between two ticks, see applySceneCommands. All other messages are applied right away by
+ * the listener.
+ */
+bool isSceneMessage(int msgType)
+{
+  switch (msgType)
+  {
+    case REMOVE_OBJECT:
+    case RESET_WORLD:
+    case OBJECT_HANDLE_REGISTER:
+    case REMOVE_OBJECT_BY_HANDLE:
+      return true;
+    case HAPTIC_DATA_STREAM:
+    case HAPTIC_DATA_STREAM_V2:
+    case HAPTIC_DATA_FRAME:
+    case CST_DATA:
+    case CUPS_DATA:
+      return false;
+    default:
+      return (msgType >= 500 && msgType < 3000);
+  }
+}
+
+/**
+ * Copies a packet into the scene queue, waiting for the haptics thread to make room if the queue is
+ * full.
+ * @return 1 on success, 0 if the packet is too long or the simulation stopped while waiting
+ */
+int enqueueSceneCommand(const char* packet, int length, BuildJob* build)
+{
+  if (length > MAX_PACKET_LENGTH) {
+    return 0;
+  }
+  SceneCommand* command;
+  while ((command = controlData.sceneQueue->reserve()) == NULL) {
+    if (!controlData.simulationRunning) {
+      return 0;
+    }
+    usleep(50);
+  }
+  command->enqueueTick = hapticsData.deviceTicks.load(memory_order_relaxed);
+  command->length = length;
+  command->transaction = NULL;
+  command->build = build;
+  if (length >= (int) sizeof(MSG_HEADER) && packetMsgType(packet, length) == SCENE_COMMIT) {
+    command->transaction = controlData.openTransaction;
+    controlData.openTransaction = NULL;
+  }
+  memcpy(command->packet, packet, length);
+  controlData.sceneQueue->publish();
+  return 1;
+}
+
+/**
+ * Applies queued scene commands, in order. Called by the haptics thread at the start of a tick, so
+ * the world never changes while the haptics thread is using it. At least one command is applied per
+ * call, and more while the time spent stays under the budget. A command whose object is still being
+ * built holds back the commands behind it until the build is done. While the graphics thread is
+ * drawing a frame, no command is applied, see beginWorldChange.
+ * @param budgetNs Time after which no new command is started
+ */
+void applySceneCommands(int64_t budgetNs)
+{
+  struct timespec start, now;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  SceneCommand* command;
+  bool applied = false;
+  bool changing = controlData.sceneQueue->front() != NULL && beginWorldChange();
+  while (changing && (command = controlData.sceneQueue->front()) != NULL) {
+    SceneTransaction* transaction = command->transaction;
+    if (command->build != NULL && !command->build->done.load(memory_order_acquire)) {
+      break;
+    }
+    if (transaction != NULL && !transactionBuilt(transaction)) {
+      break;
+    }
+    if (command->build != NULL) {
+      publishBuild(command->build);
+    }
+    else if (transaction != NULL) {
+      applySceneTransaction(transaction);
+    }
+    else {
+      applyPacket(command->packet);
+    }
+    unsigned int latency = hapticsData.deviceTicks.load(memory_order_relaxed) - command->enqueueTick;
+    controlData.sceneQueue->pop();
+    applied = true;
+    controlData.sceneCommandsApplied.fetch_add(1, memory_order_relaxed);
+    controlData.sceneLatencyTicks.fetch_add(latency, memory_order_relaxed);
+    if (latency > controlData.maxSceneLatencyTicks.load(memory_order_relaxed)) {
+      controlData.maxSceneLatencyTicks.store(latency, memory_order_relaxed);
+    }
+    if (transaction != NULL) {
+      break; // a transaction is a whole tick's worth of scene changes
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if ((now.tv_sec - start.tv_sec) * 1000000000LL + (now.tv_nsec - start.tv_nsec) >= budgetNs) {
+      break;
+    }
+  }
+  if (changing) {
+    endWorldChange();
+  }
+  if (applied) {
+    publishContactObjects();
+  }
+  RetiredBatch* reclaimable = takeReclaimable(RECLAIM_PER_TICK);
+  if (reclaimable != NULL) {
+    controlData.buildPool->submitReclaimed(reclaimable);
+  }
+}
+
+/**
+ * This function receives packets from the listener threads. Packets of unknown types, truncated
+ * packets and packets that fail validation are dropped. Messages that change the world are queued
+ * for the haptics thread, or held until SCENE_COMMIT if a scene transaction is open. Others are
+ * applied right away.
+ * @param packet is a pointer to a char array of bytes
+ * @param length is the number of bytes received
+ */
+void parsePacket(char* packet, int length)
+{
+  if (!validatePacket(packet, length)) {
+    return;
+  }
+  MSG_HEADER header;
+  memcpy(&header, packet, sizeof(header));
+  if (header.msg_type == SCENE_BEGIN) {
+    if (controlData.openTransaction != NULL) {
+      cout << "SCENE_BEGIN while a scene transaction is open, adding to it\n";
+      return;
+    }
+    controlData.openTransaction = new SceneTransaction();
+    return;
+  }
+  if (header.msg_type == SCENE_COMMIT) {
+    if (controlData.openTransaction == NULL) {
+      cout << "SCENE_COMMIT without SCENE_BEGIN, ignoring\n";
+      return;
+    }
+    enqueueSceneCommand(packet, sizeof(M_SCENE_COMMIT));
+    return;
+  }
+  if (isSceneMessage(header.msg_type)) {
+    const MESSAGE_INFO* info = findMessageInfo(header.msg_type);
+    length = (info == NULL) ? MAX_PACKET_LENGTH : info->size;
+    if (controlData.openTransaction != NULL) {
+      stageSceneMessage(packet, length);
+    }
+    else if (isBuildMessage(header.msg_type)) {
+      enqueueSceneCommand(packet, length, submitBuild(packet, length));
+    }
+    else {
+      enqueueSceneCommand(packet, length);
+    }
+    return;
+  }
+  applyPacket(packet);
+}
+
+/**
+ * Updates the haptic environment variables according to a message, by calling the handler
+ * registered for its type.
+ * @param packet is a pointer to a char array of bytes
+ */
+void applyPacket(char* packet)
+{
+  MSG_HEADER header;
+  memcpy(&header, packet, sizeof(header));
+  int msgType = header.msg_type;
+  if (isSceneMessage(msgType) && !isHandleMessage(msgType)) {
+    controlData.objectGeneration++;
+  }
+  runHandler(packet);
+}
+
+/**
+ * Handle messages carry the handle right after the header.
+ */
+static bool validHandle(const char* packet, int)
+{
+  int handle;
+  memcpy(&handle, packet + offsetof(M_REMOVE_OBJECT_BY_HANDLE, handle), sizeof(handle));
+  return handle >= 0 && handle < MAX_OBJECT_HANDLES;
+}
+
+static bool validFilename(const char* packet, int)
+{
+  const char* filename = packet + offsetof(M_START_RECORDING, filename);
+  return memchr(filename, '\0', MAX_STRING_LENGTH) != NULL;
+}
+
+static void handleSessionStart(char*)
+{
+}
+
+static void handleSessionEnd(char*)
+{
+  controlData.simulationRunning = false;
+  close();
+}
+
+static void handleTrialStart(char*)
+{
+}
+
+static void handleTrialEnd(char*)
+{
+}
+
+static void handleStartRecording(char* packet)
+{
+  M_START_RECORDING recInfo;
+  memcpy(&recInfo, packet, sizeof(recInfo));
+  char* fileName;
+  fileName = recInfo.filename;
+  controlData.dataFile.open(fileName, ofstream::binary);
+  controlData.dataFile.flush();
+  controlData.loggingData = true;
+}
+
+static void handleStopRecording(char*)
+{
+  controlData.dataFile.close();
+  controlData.loggingData = false;
+}
+
+static void handleRemoveObject(char* packet)
+{
+  M_REMOVE_OBJECT rmObj;
+  memcpy(&rmObj, packet, sizeof(rmObj));
+  removeObject(rmObj.objectName);
+}
+
+static void handleModuleReady(char* packet)
+{
+  M_MODULE_READY ready;
+  memcpy(&ready, packet, sizeof(ready));
+  markModuleReady(ready.moduleID);
+}
+
+static void handleStreamFormat(char* packet)
+{
+  M_STREAM_FORMAT format;
+  memcpy(&format, packet, sizeof(format));
+  if (format.version >= 1 && format.version <= 3) {
+    controlData.streamFormat = format.version;
+  }
+  else {
+    cout << "Unknown stream format " << format.version << '\n';
+  }
+  if (format.frameSamples > 0) {
+    controlData.frameSamples = min(format.frameSamples, MAX_FRAME_SAMPLES);
+  }
+  if (format.frameMicros > 0) {
+    controlData.frameMicros = format.frameMicros;
+  }
+}
+
+static void handleObjectHandleRegister(char* packet)
+{
+  M_OBJECT_HANDLE_REGISTER handleMsg;
+  memcpy(&handleMsg, packet, sizeof(handleMsg));
+  handleMsg.objectName[MAX_STRING_LENGTH-1] = '\0';
+  registerObjectHandle(handleMsg.handle, handleMsg.objectName);
+}
+
+static void handleRemoveObjectByHandle(char* packet)
+{
+  M_REMOVE_OBJECT_BY_HANDLE rmObj;
+  memcpy(&rmObj, packet, sizeof(rmObj));
+  ObjectHandle* objectHandle = resolveHandle(rmObj.handle);
+  if (objectHandle != NULL) {
+    removeObject(objectHandle->name);
+  }
+}
+
+static void handleResetWorld(char*)
+{
+  vector<string> names;
+  unordered_map<string, cGenericObject*>::iterator objIt;
+  for (objIt = controlData.objectMap.begin(); objIt != controlData.objectMap.end(); objIt++) {
+    names.push_back(objIt->first);
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    removeObject(names[i]);
+  }
+  unordered_map<string, cGenericEffect*>::iterator effIt;
+  for (effIt = controlData.worldEffects.begin(); effIt != controlData.worldEffects.end(); effIt++) {
+    graphicsData.world->removeEffect(effIt->second);
+    retireEffect(effIt->second);
+  }
+  controlData.objectMap.clear();
+  controlData.objectParts.clear();
+  controlData.objectEffects.clear();
+  controlData.worldEffects.clear();
+  controlData.objectGeneration++;
+}
+
+static void handleCstCreate(char* packet)
+{
+  M_CST_CREATE cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  cCST* cst = new cCST(graphicsData.world, cstObj.lambdaVal, 
+      cstObj.forceMagnitude, cstObj.visionEnabled, cstObj.hapticEnabled);
+  char* cstName = cstObj.cstName;
+  controlData.objectMap[cstName] = cst;
+  addMovingObject(cst);
+  graphicsData.world->addEffect(cst);
+  controlData.worldEffects[cstName] = cst;
+}
+
+static void handleCstDestruct(char* packet)
+{
+  M_CST_DESTRUCT cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  removeObject(cstObj.cstName);
+}
+
+static void handleCstStart(char* packet)
+{
+  M_CST_START cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
+  hapticsData.tool->setShowEnabled(false);
+  cst->startCST();
+}
+
+static void handleCstStop(char* packet)
+{
+  M_CST_STOP cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
+  cst->stopCST();
+  hapticsData.tool->setShowEnabled(true);
+}
+
+static void handleCstSetVisual(char* packet)
+{
+  M_CST_SET_VISUAL cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  bool visual = cstObj.visionEnabled;
+  cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
+  cst->setVisionEnabled(visual);
+}
+
+static void handleCstSetHaptic(char* packet)
+{
+  M_CST_SET_HAPTIC cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  bool haptic = cstObj.hapticEnabled;
+  cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
+  cst->setHapticEnabled(haptic);
+}
+
+static void handleCstSetLambda(char* packet)
+{
+  M_CST_SET_LAMBDA cstObj;
+  memcpy(&cstObj, packet, sizeof(cstObj));
+  double lambda = cstObj.lambdaVal;
+  cCST* cst = dynamic_cast<cCST*>(controlData.objectMap[cstObj.cstName]);
+  cst->setLambda(lambda);
+}
+
+static void handleCupsCreate(char* packet)
+{
+  M_CUPS_CREATE createCups;
+  memcpy(&createCups, packet, sizeof(createCups));
+  cCups* cups = new cCups(graphicsData.world, createCups.escapeAngle, 
+      createCups.pendulumLength, createCups.ballMass, createCups.cartMass);
+  char* cupsName = createCups.cupsName;
+  controlData.objectMap[cupsName] = cups;
+  addMovingObject(cups);
+  graphicsData.world->addEffect(cups);
+  controlData.worldEffects[cupsName] = cups;
+}
+
+static void handleCupsDestruct(char* packet)
+{
+  M_CUPS_DESTRUCT cupsObj;
+  memcpy(&cupsObj, packet, sizeof(cupsObj));
+  removeObject(cupsObj.cupsName);
+}
+
+static void handleCupsStart(char* packet)
+{
+  M_CUPS_START cupsObj;
+  memcpy(&cupsObj, packet, sizeof(cupsObj));
+  cCups* cups = dynamic_cast<cCups*>(controlData.objectMap[cupsObj.cupsName]);
+  hapticsData.tool->setShowEnabled(false);
+  cups->startCups();
+}
+
+static void handleCupsStop(char* packet)
+{
+  M_CUPS_STOP cupsObj;
+  memcpy(&cupsObj, packet, sizeof(cupsObj));
+  cCups* cups = dynamic_cast<cCups*>(controlData.objectMap[cupsObj.cupsName]);
+  cups->stopCups();
+  hapticsData.tool->setShowEnabled(true);
+}
+
+static void handleHapticsSetEnabled(char* packet)
+{
+  M_HAPTICS_SET_ENABLED hapticsEnabled;
+  memcpy(&hapticsEnabled, packet, sizeof(hapticsEnabled));
+  char* objectName;
+  objectName = hapticsEnabled.objectName;
+  if (controlData.objectMap.find(objectName) == controlData.objectMap.end()) {
+    cout << objectName << " not found\n";
+  }
+  else {
+    if (hapticsEnabled.enabled == 1) {
+      controlData.objectMap[objectName]->setHapticEnabled(true);
+    }
+    else if (hapticsEnabled.enabled == 0) {
+      controlData.objectMap[objectName]->setHapticEnabled(false);
+    }
+  }
+}
+
+static void handleHapticsSetEnabledWorld(char* packet)
+{
+  M_HAPTICS_SET_ENABLED_WORLD worldEnabled;
+  memcpy(&worldEnabled, packet, sizeof(worldEnabled));
+  char* effectName;
+  effectName = worldEnabled.effectName;
+  cGenericEffect* fieldEffect = controlData.worldEffects[effectName];
+  fieldEffect->setEnabled(worldEnabled.enabled);
+}
+
+static void handleHapticsSetStiffness(char* packet)
+{
+  M_HAPTICS_SET_STIFFNESS stiffness;
+  memcpy(&stiffness, packet, sizeof(stiffness));
+  char* objectName;
+  objectName = stiffness.objectName;
+  if (controlData.objectMap.find(objectName) == controlData.objectMap.end()) {
+    cout << objectName << " not found\n";
+  }
+  else {
+    controlData.objectMap[objectName]->m_material->setStiffness(stiffness.stiffness);
+  }
+}
+
+/**
+ * Handler of all messages that create an object, see buildObject.
+ */
+static void handleBuildObject(char* packet)
+{
+  BuiltObject* built = buildObject(packet);
+  attachObject(built);
+  delete built;
+}
+
+static void handleHapticsConstantForceField(char* packet)
+{
+  M_HAPTICS_CONSTANT_FORCE_FIELD cffInfo;
+  memcpy(&cffInfo, packet, sizeof(cffInfo));
+  double d = cffInfo.direction;
+  double m = cffInfo.magnitude;
+  cConstantForceFieldEffect* cFF = new cConstantForceFieldEffect(graphicsData.world, d, m);
+  graphicsData.world->addEffect(cFF);
+  controlData.worldEffects[cffInfo.effectName] = cFF;
+}
+
+static void handleHapticsViscosityField(char* packet)
+{
+  M_HAPTICS_VISCOSITY_FIELD vF;
+  memcpy(&vF, packet, sizeof(vF));
+  cMatrix3d* B = new cMatrix3d(vF.viscosityMatrix[0], vF.viscosityMatrix[1], vF.viscosityMatrix[2],
+                               vF.viscosityMatrix[3], vF.viscosityMatrix[4], vF.viscosityMatrix[5],
+                               vF.viscosityMatrix[6], vF.viscosityMatrix[7], vF.viscosityMatrix[8]);
+  cViscosityEffect* vFF = new cViscosityEffect(graphicsData.world, B);
+  graphicsData.world->addEffect(vFF);
+  controlData.worldEffects[vF.effectName] = vFF;
+}
+
+static void handleHapticsFreezeEffect(char* packet)
+{
+  M_HAPTICS_FREEZE_EFFECT freeze;
+  memcpy(&freeze, packet, sizeof(freeze));
+  double workspaceScaleFactor = hapticsData.tool->getWorkspaceScaleFactor();
+  double maxStiffness = 1.5*hapticsData.hapticDeviceInfo.m_maxLinearStiffness/workspaceScaleFactor;
+  cVector3d currentPos = hapticsData.tool->getDeviceGlobalPos();
+  cFreezeEffect* freezeEff = new cFreezeEffect(graphicsData.world, maxStiffness, currentPos);
+  graphicsData.world->addEffect(freezeEff);
+  controlData.worldEffects[freeze.effectName] = freezeEff;
+}
+
+static void handleHapticsRemoveWorldEffect(char* packet)
+{
+  M_HAPTICS_REMOVE_WORLD_EFFECT rmField;
+  memcpy(&rmField, packet, sizeof(rmField));
+  removeWorldEffect(rmField.effectName);
+}
+
+static void handleHapticsSetEnabledByHandle(char* packet)
+{
+  M_HAPTICS_SET_ENABLED_BY_HANDLE hapticsEnabled;
+  memcpy(&hapticsEnabled, packet, sizeof(hapticsEnabled));
+  ObjectHandle* objectHandle = resolveHandle(hapticsEnabled.handle);
+  if (objectHandle == NULL || objectHandle->object == NULL) {
+    return;
+  }
+  if (hapticsEnabled.enabled == 1) {
+    objectHandle->object->setHapticEnabled(true);
+  }
+  else if (hapticsEnabled.enabled == 0) {
+    objectHandle->object->setHapticEnabled(false);
+  }
+}
+
+static void handleHapticsSetEnabledWorldByHandle(char* packet)
+{
+  M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE worldEnabled;
+  memcpy(&worldEnabled, packet, sizeof(worldEnabled));
+  ObjectHandle* objectHandle = resolveHandle(worldEnabled.handle);
+  if (objectHandle != NULL && objectHandle->effect != NULL) {
+    objectHandle->effect->setEnabled(worldEnabled.enabled);
+  }
+}
+
+static void handleHapticsSetStiffnessByHandle(char* packet)
+{
+  M_HAPTICS_SET_STIFFNESS_BY_HANDLE stiffness;
+  memcpy(&stiffness, packet, sizeof(stiffness));
+  ObjectHandle* objectHandle = resolveHandle(stiffness.handle);
+  if (objectHandle != NULL && objectHandle->object != NULL) {
+    objectHandle->object->m_material->setStiffness(stiffness.stiffness);
+  }
+}
+
+static void handleHapticsRemoveWorldEffectByHandle(char* packet)
+{
+  M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE rmField;
+  memcpy(&rmField, packet, sizeof(rmField));
+  ObjectHandle* objectHandle = resolveHandle(rmField.handle);
+  if (objectHandle != NULL) {
+    removeWorldEffect(objectHandle->name);
+  }
+}
+
+static void handleGraphicsSetEnabled(char* packet)
+{
+  M_GRAPHICS_SET_ENABLED graphicsEnabled;
+  memcpy(&graphicsEnabled, packet, sizeof(graphicsEnabled));
+  char* objectName;
+  objectName = graphicsEnabled.objectName;
+  int enabled = graphicsEnabled.enabled;
+  if (controlData.objectMap.find(objectName) == controlData.objectMap.end()) {
+    cout << objectName << " not found\n";
+  }
+  else {
+    if (graphicsEnabled.enabled == 1) {
+      controlData.objectMap[objectName]->setShowEnabled(true);
+    }
+    else if (graphicsEnabled.enabled == 0) {
+      controlData.objectMap[objectName]->setShowEnabled(false);
+    }
+  }
+}
+
+static void handleGraphicsChangeBgColor(char* packet)
+{
+  M_GRAPHICS_CHANGE_BG_COLOR bgColor;
+  memcpy(&bgColor, packet, sizeof(bgColor));
+  float red = bgColor.color[0]/250.0;
+  float green = bgColor.color[1]/250.0;
+  float blue = bgColor.color[2]/250.0;
+  graphicsData.world->setBackgroundColor(red, green, blue);
+}
+
+static void handleGraphicsChangeObjectColor(char* packet)
+{
+  M_GRAPHICS_CHANGE_OBJECT_COLOR color;
+  memcpy(&color, packet, sizeof(color));
+  cGenericObject* obj = controlData.objectMap[color.objectName];
+  obj->m_material->setColorf(color.color[0], color.color[1], color.color[2], color.color[3]);
+}
+
+static void handleGraphicsSetEnabledByHandle(char* packet)
+{
+  M_GRAPHICS_SET_ENABLED_BY_HANDLE graphicsEnabled;
+  memcpy(&graphicsEnabled, packet, sizeof(graphicsEnabled));
+  ObjectHandle* objectHandle = resolveHandle(graphicsEnabled.handle);
+  if (objectHandle == NULL || objectHandle->object == NULL) {
+    return;
+  }
+  if (graphicsEnabled.enabled == 1) {
+    objectHandle->object->setShowEnabled(true);
+  }
+  else if (graphicsEnabled.enabled == 0) {
+    objectHandle->object->setShowEnabled(false);
+  }
+}
+
+static void handleGraphicsChangeObjectColorByHandle(char* packet)
+{
+  M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE color;
+  memcpy(&color, packet, sizeof(color));
+  ObjectHandle* objectHandle = resolveHandle(color.handle);
+  if (objectHandle != NULL && objectHandle->object != NULL) {
+    objectHandle->object->m_material->setColorf(color.color[0], color.color[1], color.color[2], color.color[3]);
+  }
+}
+
+/**
+ * Registers the handlers of all messages the controller accepts. SCENE_BEGIN and SCENE_COMMIT
+ * have no handler, parsePacket deals with them.
+ */
+void registerHandlers()
+{
+  registerHandler(SCENE_BEGIN, sizeof(M_SCENE_BEGIN), NULL);
+  registerHandler(SCENE_COMMIT, sizeof(M_SCENE_COMMIT), NULL);
+  registerHandler(MODULE_READY, sizeof(M_MODULE_READY), handleModuleReady);
+  registerHandler(SESSION_START, sizeof(M_SESSION_START), handleSessionStart);
+  registerHandler(SESSION_END, sizeof(M_SESSION_END), handleSessionEnd);
+  registerHandler(TRIAL_START, sizeof(M_TRIAL_START), handleTrialStart);
+  registerHandler(TRIAL_END, sizeof(M_TRIAL_END), handleTrialEnd);
+  registerHandler(START_RECORDING, sizeof(M_START_RECORDING), handleStartRecording, validFilename);
+  registerHandler(STOP_RECORDING, sizeof(M_STOP_RECORDING), handleStopRecording);
+  registerHandler(REMOVE_OBJECT, sizeof(M_REMOVE_OBJECT), handleRemoveObject);
+  registerHandler(STREAM_FORMAT, sizeof(M_STREAM_FORMAT), handleStreamFormat);
+  registerHandler(OBJECT_HANDLE_REGISTER, sizeof(M_OBJECT_HANDLE_REGISTER), handleObjectHandleRegister, validHandle, false);
+  registerHandler(REMOVE_OBJECT_BY_HANDLE, sizeof(M_REMOVE_OBJECT_BY_HANDLE), handleRemoveObjectByHandle, validHandle, false);
+  registerHandler(RESET_WORLD, sizeof(M_RESET_WORLD), handleResetWorld);
+  registerHandler(CST_CREATE, sizeof(M_CST_CREATE), handleCstCreate);
+  registerHandler(CST_DESTRUCT, sizeof(M_CST_DESTRUCT), handleCstDestruct);
+  registerHandler(CST_START, sizeof(M_CST_START), handleCstStart);
+  registerHandler(CST_STOP, sizeof(M_CST_STOP), handleCstStop);
+  registerHandler(CST_SET_VISUAL, sizeof(M_CST_SET_VISUAL), handleCstSetVisual);
+  registerHandler(CST_SET_HAPTIC, sizeof(M_CST_SET_HAPTIC), handleCstSetHaptic);
+  registerHandler(CST_SET_LAMBDA, sizeof(M_CST_SET_LAMBDA), handleCstSetLambda);
+  registerHandler(CUPS_CREATE, sizeof(M_CUPS_CREATE), handleCupsCreate);
+  registerHandler(CUPS_DESTRUCT, sizeof(M_CUPS_DESTRUCT), handleCupsDestruct);
+  registerHandler(CUPS_START, sizeof(M_CUPS_START), handleCupsStart);
+  registerHandler(CUPS_STOP, sizeof(M_CUPS_STOP), handleCupsStop);
+  registerHandler(HAPTICS_SET_ENABLED, sizeof(M_HAPTICS_SET_ENABLED), handleHapticsSetEnabled);
+  registerHandler(HAPTICS_SET_ENABLED_WORLD, sizeof(M_HAPTICS_SET_ENABLED_WORLD), handleHapticsSetEnabledWorld, NULL, false);
+  registerHandler(HAPTICS_SET_STIFFNESS, sizeof(M_HAPTICS_SET_STIFFNESS), handleHapticsSetStiffness);
+  registerHandler(HAPTICS_BOUNDING_PLANE, sizeof(M_HAPTICS_BOUNDING_PLANE), handleBuildObject);
+  registerHandler(HAPTICS_CONSTANT_FORCE_FIELD, sizeof(M_HAPTICS_CONSTANT_FORCE_FIELD), handleHapticsConstantForceField);
+  registerHandler(HAPTICS_VISCOSITY_FIELD, sizeof(M_HAPTICS_VISCOSITY_FIELD), handleHapticsViscosityField);
+  registerHandler(HAPTICS_FREEZE_EFFECT, sizeof(M_HAPTICS_FREEZE_EFFECT), handleHapticsFreezeEffect);
+  registerHandler(HAPTICS_REMOVE_WORLD_EFFECT, sizeof(M_HAPTICS_REMOVE_WORLD_EFFECT), handleHapticsRemoveWorldEffect);
+  registerHandler(HAPTICS_SET_ENABLED_BY_HANDLE, sizeof(M_HAPTICS_SET_ENABLED_BY_HANDLE), handleHapticsSetEnabledByHandle, validHandle, false);
+  registerHandler(HAPTICS_SET_ENABLED_WORLD_BY_HANDLE, sizeof(M_HAPTICS_SET_ENABLED_WORLD_BY_HANDLE), handleHapticsSetEnabledWorldByHandle, validHandle, false);
+  registerHandler(HAPTICS_SET_STIFFNESS_BY_HANDLE, sizeof(M_HAPTICS_SET_STIFFNESS_BY_HANDLE), handleHapticsSetStiffnessByHandle, validHandle, false);
+  registerHandler(HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE, sizeof(M_HAPTICS_REMOVE_WORLD_EFFECT_BY_HANDLE), handleHapticsRemoveWorldEffectByHandle, validHandle, false);
+  registerHandler(GRAPHICS_SET_ENABLED, sizeof(M_GRAPHICS_SET_ENABLED), handleGraphicsSetEnabled);
+  registerHandler(GRAPHICS_CHANGE_BG_COLOR, sizeof(M_GRAPHICS_CHANGE_BG_COLOR), handleGraphicsChangeBgColor);
+  registerHandler(GRAPHICS_PIPE, sizeof(M_GRAPHICS_PIPE), handleBuildObject);
+  registerHandler(GRAPHICS_ARROW, sizeof(M_GRAPHICS_ARROW), handleBuildObject);
+  registerHandler(GRAPHICS_CHANGE_OBJECT_COLOR, sizeof(M_GRAPHICS_CHANGE_OBJECT_COLOR), handleGraphicsChangeObjectColor);
+  registerHandler(GRAPHICS_SET_ENABLED_BY_HANDLE, sizeof(M_GRAPHICS_SET_ENABLED_BY_HANDLE), handleGraphicsSetEnabledByHandle, validHandle, false);
+  registerHandler(GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE, sizeof(M_GRAPHICS_CHANGE_OBJECT_COLOR_BY_HANDLE), handleGraphicsChangeObjectColorByHandle, validHandle, false);
+  registerHandler(GRAPHICS_MOVING_DOTS, sizeof(M_GRAPHICS_MOVING_DOTS), handleBuildObject);
+  registerHandler(GRAPHICS_SHAPE_BOX, sizeof(M_GRAPHICS_SHAPE_BOX), handleBuildObject);
+  registerHandler(GRAPHICS_SHAPE_SPHERE, sizeof(M_GRAPHICS_SHAPE_SPHERE), handleBuildObject);
+  registerHandler(GRAPHICS_SHAPE_TORUS, sizeof(M_GRAPHICS_SHAPE_TORUS), handleBuildObject);
 }
@@ -6,6 +6,8 @@
 #include "chai3d.h"
 #include "GLFW/glfw3.h"
 #include <atomic>
+#include <csignal>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -15,6 +17,11 @@
 #include "haptics/haptics.h"
 #include "graphics/graphics.h"
 #include "combined/combined.h"
+#include "core/sceneQueue.h"
+#include "core/messageRegistry.h"
+#include "core/buildPool.h"
+#include "core/reclaim.h"
+#include "core/startup.h"
 #include <fstream>
 #include <thread>
 #include "rpc/client.h"
@@ -22,6 +29,62 @@
 using namespace chai3d;
 using namespace std;
 
+#define SCENE_TICK_BUDGET_US 200 // time the haptics thread may spend applying scene commands per tick
+#define HEADLESS_POLL_MS 100 // how often the main thread checks on the others in hapticsOnly mode
+#define HEADLESS_REPORT_INTERVAL 10 // seconds between haptic loop rate reports in hapticsOnly mode
+
+/**
+ * What a handle from M_OBJECT_HANDLE_REGISTER refers to. The object and effect pointers are looked
+ * up by name the first time the handle is used, and again whenever named objects may have changed.
+ */
+struct ObjectHandle
+{
+  string name;
+  bool registered;
+  cGenericObject* object; // NULL if there is no object with that name
+  cGenericEffect* effect; // NULL if there is no world effect with that name
+  unsigned long generation; // value of ControlData::objectGeneration when object and effect were looked up
+};
+
+/**
+ * An object built from a message, not yet added to the world. Building can take a while (meshes,
+ * collision trees), so it is done before the haptics thread attaches the object.
+ */
+struct BuiltObject
+{
+  string name; // key in ControlData::objectMap
+  cGenericObject* object;
+  vector<cGenericObject*> children; // added to the world
+  cGenericMovingObject* moving; // added to GraphicsData::movingObjects, NULL if the object does not move
+};
+
+/**
+ * One message of a scene transaction, with its build job if the message creates an object.
+ */
+struct SceneStep
+{
+  vector<char> packet;
+  BuildJob* build; // NULL for messages that are applied as they are
+};
+
+/**
+ * Scene messages received between SCENE_BEGIN and SCENE_COMMIT, applied together in one haptic tick.
+ */
+struct SceneTransaction
+{
+  vector<SceneStep> steps;
+};
+
+/**
+ * An object the streamer checks for contacts with the tool.
+ */
+struct ContactObject
+{
+  string name;
+  cGenericObject* object;
+  int handle; // -1 if the object has no handle
+};
+
 struct ControlData
 {
   // State variables
@@ -41,6 +104,11 @@ struct ControlData
   const char* MH_IP;
   int MH_PORT;
   rpc::client* client;
+  int streamBatchSize;
+  int streamBatchMicros;
+  atomic<int> streamFormat; // 1 for HAPTIC_DATA_STREAM, 2 for HAPTIC_DATA_STREAM_V2, 3 for HAPTIC_DATA_FRAME
+  atomic<int> frameSamples;
+  atomic<int> frameMicros;
   
   //const char* LISTENER_IP;
   //int LISTENER_PORT;
@@ -53,16 +121,51 @@ struct ControlData
   cThread* listenerThread;
   ofstream dataFile;
 
-  // TODO: Make the hapticsOnly = true mode actually work
+  // Set with --haptics-only. There is no window and the world is not drawn, the main thread only
+  // supervises the other threads. For rigs where another module provides vision, or no display.
   bool hapticsOnly;
   
   //Object Tracking
   unordered_map<string, cGenericObject*> objectMap;
   unordered_map<string, vector<string>> objectEffects;
   unordered_map<string, cGenericEffect*> worldEffects;
+  vector<ObjectHandle> objectHandles; // indexed by handle
+  unordered_map<string, int> handleByName; // reverse of objectHandles, for reporting contacts
+  unsigned long objectGeneration; // changes whenever objects or effects may have been added or removed
+  unordered_map<string, vector<cGenericObject*>> objectParts; // world children of objects that are not in the world themselves
+  // objectMap and handleByName as seen by the streamer, replaced as a whole by the haptics thread
+  atomic<const vector<ContactObject>*> contactObjects;
+
+  // Scene mutations queued by the listener for the haptics thread
+  SceneQueue* sceneQueue;
+  SceneTransaction* openTransaction; // between SCENE_BEGIN and SCENE_COMMIT, only used by the listener
+  BuildPool* buildPool;
+  atomic<uint64_t> sceneCommandsApplied;
+  atomic<uint64_t> sceneLatencyTicks; // sum over all applied commands, in haptic ticks
+  atomic<unsigned int> maxSceneLatencyTicks;
 };
 
 bool allThreadsDown(void);
 void close(void);
-void parsePacket(char* packet);
+void superviseHeadless(void);
+void parsePacket(char* packet, int length);
+void registerHandlers(void);
+bool isSceneMessage(int msgType);
+int enqueueSceneCommand(const char* packet, int length, BuildJob* build = NULL);
+void applySceneCommands(int64_t budgetNs);
+void applyPacket(char* packet);
+BuiltObject* buildObject(const char* packet);
+void attachObject(BuiltObject* built);
+bool isBuildMessage(int msgType);
+BuildJob* submitBuild(const char* packet, int length);
+void publishBuild(BuildJob* job);
+void stageSceneMessage(const char* packet, int length);
+void applySceneTransaction(SceneTransaction* transaction);
+int registerObjectHandle(int handle, const char* name);
+ObjectHandle* resolveHandle(int handle);
+void removeObject(const string& name);
+void removeWorldEffect(const string& name);
+void addMovingObject(cGenericMovingObject* object);
+void removeMovingObject(cGenericMovingObject* object);
+void publishContactObjects(void);
 #endif
@@ -0,0 +1,163 @@
+#include "messageRegistry.h"
+#include "messageDispatch.h"
+#include <iostream>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @file messageRegistry.h
+ * @file messageRegistry.cpp
+ * @brief Table of message handlers, indexed by message type, with per-type counters and timings.
+ */
+
+static HandlerEntry* handlers[MAX_REGISTERED_MSG_TYPE];
+static atomic<uint64_t> unknownPackets{0};
+
+static int64_t nowNs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static HandlerEntry* findHandler(int msgType)
+{
+  if (msgType < 0 || msgType >= MAX_REGISTERED_MSG_TYPE) {
+    return NULL;
+  }
+  return handlers[msgType];
+}
+
+/**
+ * Registers the handler of a message type, replacing any earlier one.
+ * @param expectedSize is the smallest packet length accepted for this type
+ * @return 1 on success, 0 if the type is out of range
+ */
+int registerHandler(int msgType, int expectedSize, PacketHandler handler, PacketValidator validator,
+                    bool logReceived)
+{
+  if (msgType < 0 || msgType >= MAX_REGISTERED_MSG_TYPE) {
+    cout << "Cannot register a handler for message type " << msgType << '\n';
+    return 0;
+  }
+  HandlerEntry* entry = handlers[msgType];
+  if (entry == NULL) {
+    entry = new HandlerEntry();
+    for (int i = 0; i < HANDLER_TIME_BUCKETS; i++) {
+      entry->timeBuckets[i] = 0;
+    }
+    handlers[msgType] = entry;
+  }
+  entry->handler = handler;
+  entry->validator = validator;
+  entry->expectedSize = expectedSize;
+  entry->logReceived = logReceived;
+  return 1;
+}
+
+/**
+ * Checks that a packet has a registered type, is not truncated, and passes the type's validator.
+ * Rejected packets are counted.
+ */
+bool validatePacket(const char* packet, int length)
+{
+  HandlerEntry* entry = findHandler(packetMsgType(packet, length));
+  if (entry == NULL) {
+    unknownPackets.fetch_add(1, memory_order_relaxed);
+    return false;
+  }
+  if (length < entry->expectedSize) {
+    cout << "Rejected " << messageName(packetMsgType(packet, length)) << ": " << length
+         << " bytes, expected " << entry->expectedSize << '\n';
+    entry->rejected.fetch_add(1, memory_order_relaxed);
+    return false;
+  }
+  if (entry->validator != NULL && !entry->validator(packet, length)) {
+    cout << "Rejected " << messageName(packetMsgType(packet, length)) << ": invalid contents\n";
+    entry->rejected.fetch_add(1, memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Calls the handler of a validated packet and records how long it took.
+ * @return 1 if a handler was called, 0 otherwise
+ */
+int runHandler(char* packet)
+{
+  MSG_HEADER header;
+  memcpy(&header, packet, sizeof(header));
+  HandlerEntry* entry = findHandler(header.msg_type);
+  if (entry == NULL || entry->handler == NULL) {
+    return 0;
+  }
+  if (entry->logReceived) {
+    cout << "Received " << messageName(header.msg_type) << " Message\n";
+  }
+  int64_t start = nowNs();
+  entry->handler(packet);
+  recordHandlerTime(header.msg_type, nowNs() - start);
+  return 1;
+}
+
+/**
+ * Counts one handling of a message type that took a given time. runHandler calls this itself; work
+ * done elsewhere, such as building objects in the BuildPool, is recorded with it directly.
+ */
+void recordHandlerTime(int msgType, uint64_t elapsedNs)
+{
+  HandlerEntry* entry = findHandler(msgType);
+  if (entry == NULL) {
+    return;
+  }
+  entry->calls.fetch_add(1, memory_order_relaxed);
+  entry->totalNs.fetch_add(elapsedNs, memory_order_relaxed);
+  uint64_t currentMax = entry->maxNs.load(memory_order_relaxed);
+  while (elapsedNs > currentMax && !entry->maxNs.compare_exchange_weak(currentMax, elapsedNs, memory_order_relaxed)) {}
+  int bucket = (elapsedNs == 0) ? 0 : 63 - __builtin_clzll(elapsedNs);
+  entry->timeBuckets[min(bucket, HANDLER_TIME_BUCKETS - 1)].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * Upper end of the bucket below which 99% of the calls of a handler fall, in nanoseconds.
+ */
+static uint64_t p99Ns(HandlerEntry* entry)
+{
+  uint64_t target = entry->calls.load(memory_order_relaxed) * 99 / 100;
+  uint64_t sum = 0;
+  for (int i = 0; i < HANDLER_TIME_BUCKETS; i++) {
+    sum += entry->timeBuckets[i].load(memory_order_relaxed);
+    if (sum > target) {
+      return 2ULL << i;
+    }
+  }
+  return entry->maxNs.load(memory_order_relaxed);
+}
+
+/**
+ * Prints the call count, rejections and handler times of every message type that was received.
+ */
+void printHandlerStats()
+{
+  cout << "Message handlers (calls, rejected, mean/p99/max us):\n";
+  for (int i = 0; i < MAX_REGISTERED_MSG_TYPE; i++) {
+    HandlerEntry* entry = handlers[i];
+    if (entry == NULL) {
+      continue;
+    }
+    uint64_t calls = entry->calls.load(memory_order_relaxed);
+    uint64_t rejected = entry->rejected.load(memory_order_relaxed);
+    if (calls == 0 && rejected == 0) {
+      continue;
+    }
+    double meanUs = (calls == 0) ? 0.0 : entry->totalNs.load(memory_order_relaxed) / 1e3 / calls;
+    cout << "  " << messageName(i) << ": " << calls << ", " << rejected << ", " << meanUs << "/"
+         << p99Ns(entry) / 1e3 << "/" << entry->maxNs.load(memory_order_relaxed) / 1e3 << '\n';
+  }
+  uint64_t unknown = unknownPackets.load(memory_order_relaxed);
+  if (unknown > 0) {
+    cout << "  unknown types: " << unknown << '\n';
+  }
+  cout.flush();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef _MESSAGEREGISTRY_H_
+#define _MESSAGEREGISTRY_H_
+
+#include <atomic>
+#include <stdint.h>
+#include "messageDefinitions.h"
+
+using namespace std;
+
+/**
+ * @file messageRegistry.h
+ * @brief Table of message handlers, indexed by message type.
+ *
+ * Each message type the controller accepts registers a handler, the size its packets must have at
+ * least, and optionally a validator that checks the contents. validatePacket is called when a packet
+ * arrives and rejects unknown types, truncated packets and packets the validator refuses;
+ * runHandler calls the handler and records how long it took. Handlers must be registered before the
+ * listener starts.
+ */
+
+#define MAX_REGISTERED_MSG_TYPE 4096 // types from 0 to this value - 1 can have a handler
+#define HANDLER_TIME_BUCKETS 32 // bucket i counts handler calls that took 2^i to 2^(i+1) ns
+
+typedef void (*PacketHandler)(char* packet);
+typedef bool (*PacketValidator)(const char* packet, int length);
+
+struct HandlerEntry
+{
+  PacketHandler handler; // NULL for messages that parsePacket handles itself
+  PacketValidator validator; // NULL if the size check is enough
+  int expectedSize;
+  bool logReceived; // print "Received ... Message" when the handler runs
+  atomic<uint64_t> calls{0};
+  atomic<uint64_t> rejected{0};
+  atomic<uint64_t> totalNs{0};
+  atomic<uint64_t> maxNs{0};
+  atomic<uint64_t> timeBuckets[HANDLER_TIME_BUCKETS];
+};
+
+int registerHandler(int msgType, int expectedSize, PacketHandler handler,
+                    PacketValidator validator = NULL, bool logReceived = true);
+bool validatePacket(const char* packet, int length);
+int runHandler(char* packet);
+void recordHandlerTime(int msgType, uint64_t elapsedNs);
+void printHandlerStats();
+
+#endif
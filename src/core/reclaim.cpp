@@ -0,0 +1,184 @@
+#include "reclaim.h"
+#include <deque>
+#include <thread>
+#include <unordered_set>
+
+/**
+ * @file reclaim.h
+ * @file reclaim.cpp
+ * @brief Epoch-based reclamation of objects removed from the world.
+ */
+
+#define EPOCH_OFFLINE UINT64_MAX // slot value of a thread that is not running
+
+struct ReaderSlot
+{
+  alignas(64) atomic<uint64_t> epoch{EPOCH_OFFLINE};
+};
+
+static atomic<uint64_t> globalEpoch{0};
+static ReaderSlot readers[NUM_EPOCH_READERS];
+static deque<RetiredItem> retired; // oldest first, haptics thread only
+static unordered_set<void*> retiredIdentities; // so nothing is deleted twice
+static atomic<bool> worldChanging{false}; // the haptics thread is changing child lists
+static atomic<bool> worldChangeWanted{false}; // beginWorldChange failed and the changes are waiting
+static atomic<bool> worldTraversing{false}; // the graphics thread is walking child lists
+
+/**
+ * Marks a thread as running. Must be called before the thread reads anything from the world.
+ */
+void enterEpochs(EpochReader reader)
+{
+  readers[reader].epoch.store(globalEpoch.load());
+}
+
+/**
+ * Announces that a thread holds no pointer into the world right now.
+ */
+void quiescent(EpochReader reader)
+{
+  readers[reader].epoch.store(globalEpoch.load());
+}
+
+/**
+ * Marks a thread as stopped, so that reclamation no longer waits for it.
+ */
+void leaveEpochs(EpochReader reader)
+{
+  readers[reader].epoch.store(EPOCH_OFFLINE);
+}
+
+/**
+ * Calls destroy(pointer) once no thread can be using the pointer any more. Retiring the same
+ * identity again before it is destroyed does nothing.
+ */
+void retire(void* pointer, void* identity, void (*destroy)(void* pointer))
+{
+  if (!retiredIdentities.insert(identity).second) {
+    return;
+  }
+  RetiredItem item;
+  item.epoch = globalEpoch.fetch_add(1);
+  item.pointer = pointer;
+  item.identity = identity;
+  item.destroy = destroy;
+  retired.push_back(item);
+}
+
+/**
+ * Deletes an object, and its children, once no thread can be using it any more.
+ */
+void retireObject(cGenericObject* object)
+{
+  if (object != NULL) {
+    retire(object, dynamic_cast<void*>(object), [](void* pointer) { delete (cGenericObject*) pointer; });
+  }
+}
+
+/**
+ * Deletes an effect once no thread can be using it any more. Effects that are also objects, such as
+ * the CST and cups tasks, are retired as objects, so that retiring both never deletes them twice.
+ */
+void retireEffect(cGenericEffect* effect)
+{
+  if (effect == NULL) {
+    return;
+  }
+  cGenericObject* object = dynamic_cast<cGenericObject*>(effect);
+  if (object != NULL) {
+    retireObject(object);
+    return;
+  }
+  retire(effect, dynamic_cast<void*>(effect), [](void* pointer) { delete (cGenericEffect*) pointer; });
+}
+
+/**
+ * Takes the oldest retired items that every running thread has moved past. They are no longer
+ * reachable by any thread, so they can be deleted anywhere, see destroyRetired.
+ * @param maxItems is the most items taken in this call
+ * @return The items, or NULL if none is ready
+ */
+RetiredBatch* takeReclaimable(int maxItems)
+{
+  if (retired.empty()) {
+    return NULL;
+  }
+  uint64_t oldest = EPOCH_OFFLINE;
+  for (int i = 0; i < NUM_EPOCH_READERS; i++) {
+    oldest = min(oldest, readers[i].epoch.load());
+  }
+  if (retired.front().epoch >= oldest) {
+    return NULL;
+  }
+  RetiredBatch* batch = new RetiredBatch();
+  while (!retired.empty() && (int) batch->size() < maxItems && retired.front().epoch < oldest) {
+    batch->push_back(retired.front());
+    retiredIdentities.erase(retired.front().identity);
+    retired.pop_front();
+  }
+  return batch;
+}
+
+/**
+ * Deletes the items of a batch from takeReclaimable, and the batch. Deleting meshes and collision
+ * trees takes time, so this is called by a BuildPool worker rather than the haptics thread.
+ */
+void destroyRetired(RetiredBatch* batch)
+{
+  for (size_t i = 0; i < batch->size(); i++) {
+    (*batch)[i].destroy((*batch)[i].pointer);
+  }
+  delete batch;
+}
+
+size_t retiredCount()
+{
+  return retired.size();
+}
+
+/**
+ * Called by the haptics thread before it adds or removes objects. Never waits.
+ * @return True if the world may be changed until endWorldChange, false if the graphics thread is
+ * walking it and the changes must wait
+ */
+bool beginWorldChange()
+{
+  worldChanging.store(true);
+  if (worldTraversing.load()) {
+    worldChanging.store(false);
+    worldChangeWanted.store(true);
+    return false;
+  }
+  worldChangeWanted.store(false);
+  return true;
+}
+
+void endWorldChange()
+{
+  worldChanging.store(false);
+}
+
+/**
+ * Called by the graphics thread before it walks the world. Waits while the haptics thread changes
+ * it, and lets waiting changes through first so that drawing frames back to back cannot hold them
+ * off. Changes are only waited for while the haptics thread is running.
+ */
+void beginWorldTraversal()
+{
+  while (true) {
+    bool hapticsRunning = readers[HAPTICS_READER].epoch.load() != EPOCH_OFFLINE;
+    if (!hapticsRunning || !worldChangeWanted.load()) {
+      worldTraversing.store(true);
+      if (!worldChanging.load()) {
+        return;
+      }
+      worldTraversing.store(false);
+    }
+    this_thread::yield();
+  }
+}
+
+void endWorldTraversal()
+{
+  worldTraversing.store(false);
+}
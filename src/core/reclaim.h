@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef _RECLAIM_H_
+#define _RECLAIM_H_
+
+#include "chai3d.h"
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+using namespace chai3d;
+using namespace std;
+
+/**
+ * @file reclaim.h
+ * @brief Epoch-based reclamation of objects removed from the world.
+ *
+ * The haptics thread removes objects and effects between two ticks, but the graphics thread may be
+ * rendering them and the streamer may be checking them for contacts at that moment. Removed objects
+ * are therefore retired instead of deleted: each is tagged with the current epoch, and the epoch
+ * moves on. The graphics, haptics and streamer threads call quiescent whenever they hold no pointer
+ * into the world, which records the epoch they have reached. A retired object is deleted once every
+ * active thread has reached a later epoch. Retiring and announcing a quiescent point never block.
+ *
+ * Objects must be unlinked (taken out of the world, objectMap, movingObjects, ...) before they are
+ * retired. Retiring and the epoch bookkeeping are done by the haptics thread only; the items it
+ * finds ready are deleted by a BuildPool worker, so that freeing meshes never takes time from a
+ * haptic tick.
+ *
+ * Retiring keeps removed objects alive, but adding or removing a child also changes the child list
+ * of its parent, which the graphics thread walks while it renders. The haptics thread therefore only
+ * changes the world between beginWorldChange and endWorldChange, and the graphics thread only walks
+ * it between beginWorldTraversal and endWorldTraversal; the two never overlap. beginWorldChange
+ * never waits: while a frame is being drawn it fails and the changes wait for the next tick. The
+ * graphics thread then waits before its next frame until the haptics thread has made them.
+ */
+
+#define RECLAIM_PER_TICK 8 // retired objects handed over per call to takeReclaimable at most
+
+struct RetiredItem
+{
+  uint64_t epoch; // value of the global epoch when the item was retired
+  void* pointer;
+  void* identity; // address of the whole object, the same whichever base class it was retired as
+  void (*destroy)(void* pointer);
+};
+
+typedef vector<RetiredItem> RetiredBatch;
+
+enum EpochReader
+{
+  HAPTICS_READER,
+  GRAPHICS_READER,
+  STREAMER_READER,
+  NUM_EPOCH_READERS
+};
+
+void enterEpochs(EpochReader reader);
+void quiescent(EpochReader reader);
+void leaveEpochs(EpochReader reader);
+void retire(void* pointer, void* identity, void (*destroy)(void* pointer));
+void retireObject(cGenericObject* object);
+void retireEffect(cGenericEffect* effect);
+RetiredBatch* takeReclaimable(int maxItems);
+void destroyRetired(RetiredBatch* batch);
+size_t retiredCount(void);
+bool beginWorldChange(void);
+void endWorldChange(void);
+void beginWorldTraversal(void);
+void endWorldTraversal(void);
+
+/**
+ * Deletes a list that has been replaced by a copy once no thread can be reading it any more.
+ */
+template<typename T> void retireList(const T* list)
+{
+  if (list != NULL) {
+    retire((void*) list, (void*) list, [](void* pointer) { delete (T*) pointer; });
+  }
+}
+
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+#ifndef _SCENEQUEUE_H_
+#define _SCENEQUEUE_H_
+
+#include <atomic>
+#include <stdint.h>
+#include "messageDefinitions.h"
+
+/**
+ * @file sceneQueue.h
+ * @brief Queue of scene mutations from the listener thread to the haptics thread.
+ *
+ * Messages that change the world are not applied by the listener, since the haptics thread may be
+ * traversing the world at the same time. They are copied into a SceneQueue instead, and the haptics
+ * thread applies them between two ticks. The queue has a single producer (the listener) and a single
+ * consumer (the haptics thread), so it needs no locks. Slots are filled in place with reserve and
+ * publish, and read in place with front and pop, so a packet is copied once.
+ */
+
+#define SCENE_QUEUE_SLOTS 256 // power of two
+
+struct SceneTransaction;
+struct BuildJob;
+
+/**
+ * One queued message and the haptic tick at which it was queued. A committed scene transaction is
+ * queued as its SCENE_COMMIT message, with the transaction attached.
+ */
+struct SceneCommand
+{
+  unsigned int enqueueTick;
+  int length;
+  SceneTransaction* transaction; // NULL except for SCENE_COMMIT
+  BuildJob* build; // for messages that create an object, NULL otherwise
+  char packet[MAX_PACKET_LENGTH];
+};
+
+class SceneQueue
+{
+  private:
+    SceneCommand slots[SCENE_QUEUE_SLOTS];
+    alignas(64) std::atomic<uint64_t> head{0}; // next slot to read, written by the consumer
+    alignas(64) std::atomic<uint64_t> tail{0}; // next slot to write, written by the producer
+
+  public:
+    /**
+     * Slot for the next command. Producer only.
+     * @return NULL if the queue is full
+     */
+    SceneCommand* reserve()
+    {
+      uint64_t index = tail.load(std::memory_order_relaxed);
+      if (index - head.load(std::memory_order_acquire) >= SCENE_QUEUE_SLOTS) {
+        return NULL;
+      }
+      return &slots[index % SCENE_QUEUE_SLOTS];
+    }
+
+    /**
+     * Makes the slot returned by reserve visible to the consumer. Producer only.
+     */
+    void publish()
+    {
+      tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Oldest queued command. Consumer only.
+     * @return NULL if the queue is empty
+     */
+    SceneCommand* front()
+    {
+      uint64_t index = head.load(std::memory_order_relaxed);
+      if (index == tail.load(std::memory_order_acquire)) {
+        return NULL;
+      }
+      return &slots[index % SCENE_QUEUE_SLOTS];
+    }
+
+    /**
+     * Releases the slot returned by front. Consumer only.
+     */
+    void pop()
+    {
+      head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint64_t size()
+    {
+      return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "startup.h"
+#include "core/controller.h"
+#include <chrono>
+
+/**
+ * @file startup.h
+ * @file startup.cpp
+ * @brief Startup sequence of the controller.
+ */
+
+extern HapticData hapticsData;
+extern GraphicsData graphicsData;
+extern ControlData controlData;
+
+static const char* phaseNames[NUM_STARTUP_PHASES] = {"device", "display", "broker", "haptics",
+                                                      "subscription", "transport"};
+static chrono::steady_clock::time_point startupBegin;
+
+static double startupSeconds()
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - startupBegin).count();
+}
+
+/**
+ * Logs the end of a phase.
+ * @param phase Phase that ended
+ * @param start Value of startupSeconds when the phase started
+ * @param success True if the phase succeeded
+ */
+static void phaseDone(StartupPhase phase, double start, bool success)
+{
+  double end = startupSeconds();
+  cout << "Startup: " << phaseNames[phase] << (success ? " ready" : " failed") << " at "
+       << (int) (end * 1000) << " ms, took " << (int) ((end - start) * 1000) << " ms\n";
+}
+
+static void runDevicePhase(int* status)
+{
+  double start = startupSeconds();
+  *status = openHapticDevice();
+  phaseDone(PHASE_DEVICE, start, *status == 1);
+}
+
+/**
+ * Registers with MessageHandler and subscribes to Trial Control. The messaging socket is opened
+ * first, so that MODULE_READY cannot arrive before there is a socket to receive it.
+ * @param status Set to the result of subscribeToTrialControl, or 0 if the module was not added
+ */
+static void runBrokerPhase(int* status)
+{
+  double start = startupSeconds();
+  openMessagingSocket();
+  if (addMessageHandlerModule() == 0) {
+    cout << "Module addition failed\n";
+    *status = 0;
+  }
+  else {
+    syncBrokerClock();
+    *status = subscribeToTrialControl();
+    if (*status == 0) {
+      cout << "Subscribe to Trial Control failed\n";
+    }
+  }
+  phaseDone(PHASE_BROKER, start, *status != 0);
+}
+
+/**
+ * Undoes the device and broker phases when startup fails before the haptics thread runs, which
+ * close cannot do since it expects the haptic tool to exist.
+ * @param deviceStatus Result of the device phase, the device is only closed if it was opened
+ */
+static void abortStartup(int deviceStatus)
+{
+  if (deviceStatus == 1) {
+    hapticsData.hapticDevice->close();
+    cout << "Haptic device closed\n";
+  }
+  delete hapticsData.handler;
+  controlData.buildPool->stop();
+  closeMessagingSocket();
+}
+
+/**
+ * Runs the startup phases and starts the haptics, streamer and listener threads. Must be called
+ * from the main thread, which GLFW needs the window to be created on.
+ * @return 1 on success, 0 if the haptic device could not be opened, the controller could not
+ * register with MessageHandler or Trial Control was not added within SUBSCRIBE_TIMEOUT seconds.
+ * Everything started so far is shut down before 0 is returned.
+ */
+int startController(void)
+{
+  startupBegin = chrono::steady_clock::now();
+  int deviceStatus = 0;
+  int subscribeStatus = 0;
+  thread deviceThread(runDevicePhase, &deviceStatus);
+  thread brokerThread(runBrokerPhase, &subscribeStatus);
+
+  double start = startupSeconds();
+  initWorld();
+  if (controlData.hapticsOnly == false) {
+    initDisplay();
+    initScene();
+  }
+  phaseDone(PHASE_DISPLAY, start, true);
+  deviceThread.join();
+  brokerThread.join();
+  if (deviceStatus == 0) {
+    cout << "Haptic device could not be opened, exiting.\n";
+  }
+  if (deviceStatus == 0 || subscribeStatus == 0) {
+    abortStartup(deviceStatus);
+    return 0;
+  }
+
+  start = startupSeconds();
+  initHaptics();
+  startHapticsThread();
+  atexit(close);
+  if (controlData.hapticsOnly == false) {
+    resizeWindowCallback(graphicsData.window, graphicsData.width, graphicsData.height);
+  }
+  phaseDone(PHASE_HAPTICS, start, true);
+
+  if (subscribeStatus == 2) {
+    cout << "Waiting for Trial Control to be added to MessageHandler\n";
+    start = startupSeconds();
+    int ready = waitForModuleReady(TRIAL_CONTROL_MODULE, SUBSCRIBE_TIMEOUT);
+    phaseDone(PHASE_SUBSCRIBED, start, ready == 1);
+    if (ready == 0) {
+      cout << "Error subscribing to Trial Control, exiting.\n";
+      close();
+      return 0;
+    }
+  }
+
+  start = startupSeconds();
+  if (attachSharedMemory() == 0) {
+    openIngestSocket();
+  }
+  startStreamer();
+  startListener();
+  phaseDone(PHASE_TRANSPORT, start, true);
+  cout << "streamer and listener started\n";
+  return 1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef _STARTUP_H_
+#define _STARTUP_H_
+
+using namespace std;
+
+/**
+ * @file startup.h
+ * @brief Startup sequence of the controller.
+ *
+ * Opening and calibrating the device, creating the window and the world, and registering with
+ * MessageHandler do not depend on each other, so they run at the same time. The haptic tool needs
+ * both the device and the world, so it is created once they are ready. If Trial Control has not
+ * been added to MessageHandler yet, the controller then waits for MessageHandler to send
+ * MODULE_READY instead of polling subscribeTo. Each phase logs when it finished and how long it took.
+ */
+
+enum StartupPhase
+{
+  PHASE_DEVICE, // open and calibrate the haptic device
+  PHASE_DISPLAY, // world, and window and GL context unless hapticsOnly
+  PHASE_BROKER, // messaging socket, addModule, clock sync and subscribeTo
+  PHASE_HAPTICS, // haptic tool and haptics thread
+  PHASE_SUBSCRIBED, // Trial Control added to MessageHandler, only if subscribeTo was deferred
+  PHASE_TRANSPORT, // shared memory or ingest port, streamer and listener
+  NUM_STARTUP_PHASES
+};
+
+int startController(void);
+
+#endif
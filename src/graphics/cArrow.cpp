@@ -1,4 +1,6 @@
 #include "cArrow.h"
+#include "graphics.h"
+extern GraphicsData graphicsData;
 
 /** 
  * @param a_length Length of the arrow 
@@ -10,11 +12,12 @@
  * @param a_dir Direction of arrow 
  * @param a_pos Position to start arrow. Arrow starts at a_pos and points in a_dir, with the length
  * being the length of the a_dir vector.
- * @param a_color Color of vertices
+ * @param a_color Color of the arrow
  *
+ * The mesh shares its geometry with every other arrow of the same dimensions, see cGeometryCache.
  */
 cArrow::cArrow(double a_length, double a_shaftRadius, double a_lengthTip, double a_radiusTip, bool a_bidir,
-                unsigned int a_numSides, cVector3d* a_dir, cVector3d* a_pos, cColorf* a_color)
+                unsigned int a_numSides, const cVector3d& a_dir, const cVector3d& a_pos, const cColorf& a_color)
 {
   myLength = a_length;
   shaftRadius = a_shaftRadius;
@@ -26,9 +29,10 @@ cArrow::cArrow(double a_length, double a_shaftRadius, double a_lengthTip, double
   position = a_pos;
   color = a_color;
 
-  myMesh = new cMesh();
-  cCreateArrow(myMesh, myLength, shaftRadius, lengthTip, radiusTip, bidirectional, 
-                numSides, *direction, *position, *color);
+  myMesh = graphicsData.geometryCache.arrow(myLength, shaftRadius, lengthTip, radiusTip, bidirectional, numSides);
+  myMesh->setLocalPos(position);
+  myMesh->setLocalRot(cGeometryCache::arrowRotation(direction));
+  myMesh->m_material->setColor(color);
 }
 
 /**
@@ -22,12 +22,12 @@ class cArrow : public cGenericObject
     double radiusTip;
     bool bidirectional;
     unsigned int numSides;
-    cVector3d* direction;
-    cVector3d* position;
-    cColorf* color;
+    cVector3d direction;
+    cVector3d position;
+    cColorf color;
 
   public:
     cArrow(double a_length, double a_shaftRadius, double a_lengthTip, double a_radiusTip, bool a_bidir,
-          unsigned int a_numSides, cVector3d* a_dir, cVector3d* a_pos, cColorf* a_color);
+          unsigned int a_numSides, const cVector3d& a_dir, const cVector3d& a_pos, const cColorf& a_color);
     cMesh* getArrowObj();
 };
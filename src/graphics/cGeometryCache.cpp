@@ -0,0 +1,118 @@
+#include "cGeometryCache.h"
+#include <stdio.h>
+
+static void createPipe(cMesh* mesh, const double* p)
+{
+  cCreatePipe(mesh, p[0], p[1], p[2], (unsigned int) p[3], (unsigned int) p[4]);
+}
+
+static void createArrow(cMesh* mesh, const double* p)
+{
+  cCreateArrow(mesh, p[0], p[1], p[2], p[3], p[4] != 0.0, (unsigned int) p[5]);
+}
+
+static void createRingSection(cMesh* mesh, const double* p)
+{
+  cCreateRingSection(mesh, p[0], p[1], p[2], p[3], p[4] != 0.0, (unsigned int) p[5], (unsigned int) p[6]);
+}
+
+/**
+ * Key of a shape: its name followed by its parameters, written exactly.
+ */
+static string shapeKey(const char* shape, const double* params, int numParams)
+{
+  string key(shape);
+  char buffer[32];
+  for (int i = 0; i < numParams; i++) {
+    snprintf(buffer, sizeof(buffer), ":%a", params[i]);
+    key += buffer;
+  }
+  return key;
+}
+
+/**
+ * Copy of the prototype of a shape, created first if needed. The copy shares the prototype's
+ * vertices and triangles and has its own material. Safe to call from several threads.
+ */
+cMesh* cGeometryCache::instance(const string& key, void (*create)(cMesh* mesh, const double* params),
+                                const double* params)
+{
+  lock_guard<mutex> guard(lock);
+  unordered_map<string, cMesh*>::iterator it = prototypes.find(key);
+  cMesh* prototype;
+  if (it == prototypes.end()) {
+    prototype = new cMesh();
+    create(prototype, params);
+    prototypes[key] = prototype;
+    misses++;
+  }
+  else {
+    prototype = it->second;
+    hits++;
+  }
+  return prototype->copy(true, false, false, false);
+}
+
+/**
+ * Pipe along the z axis, centered on the origin. @see cCreatePipe
+ */
+cMesh* cGeometryCache::pipe(double height, double innerRadius, double outerRadius, unsigned int numSides,
+                            unsigned int numHeightSegments)
+{
+  double params[] = {height, innerRadius, outerRadius, (double) numSides, (double) numHeightSegments};
+  return instance(shapeKey("pipe", params, 5), createPipe, params);
+}
+
+/**
+ * Arrow starting at the origin and pointing along the z axis, see arrowRotation to point it
+ * elsewhere. @see cCreateArrow
+ */
+cMesh* cGeometryCache::arrow(double length, double shaftRadius, double lengthTip, double radiusTip,
+                             bool bidirectional, unsigned int numSides)
+{
+  double params[] = {length, shaftRadius, lengthTip, radiusTip, bidirectional ? 1.0 : 0.0, (double) numSides};
+  return instance(shapeKey("arrow", params, 6), createArrow, params);
+}
+
+/**
+ * Ring section centered on the origin. @see cCreateRingSection
+ */
+cMesh* cGeometryCache::ringSection(double innerRadius0, double innerRadius1, double outerRadius,
+                                   double coverageAngleDeg, bool includeExtremityFaces, unsigned int numSides,
+                                   unsigned int numRings)
+{
+  double params[] = {innerRadius0, innerRadius1, outerRadius, coverageAngleDeg,
+                     includeExtremityFaces ? 1.0 : 0.0, (double) numSides, (double) numRings};
+  return instance(shapeKey("ringSection", params, 7), createRingSection, params);
+}
+
+/**
+ * Frame cCreateArrow builds around an arrow direction.
+ */
+static cMatrix3d arrowFrame(const cVector3d& direction)
+{
+  cVector3d vz = cNormalize(direction);
+  cVector3d t0(1.0, 0.0, 0.0);
+  cVector3d t1(0.0, 1.0, 0.0);
+  cVector3d t = (cAngle(vz, t0) > cAngle(vz, t1)) ? cCross(vz, t0) : cCross(vz, t1);
+  cVector3d vy = cNormalize(t);
+  cVector3d vx = cNormalize(cCross(vy, vz));
+  cMatrix3d frame;
+  frame.setCol(vx, vy, vz);
+  return frame;
+}
+
+/**
+ * Local rotation that turns an arrow from the cache into the one cCreateArrow would have built for
+ * a direction, including the roll of its sides around the shaft.
+ */
+cMatrix3d cGeometryCache::arrowRotation(const cVector3d& direction)
+{
+  return cMul(arrowFrame(direction), cTranspose(arrowFrame(cVector3d(0.0, 0.0, 1.0))));
+}
+
+void cGeometryCache::printStats()
+{
+  cout << "Geometry cache: " << prototypes.size() << " shapes, " << hits << " hits, " << misses
+       << " misses\n";
+}
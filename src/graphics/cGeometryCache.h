@@ -0,0 +1,42 @@
+#pragma once
+#include "chai3d.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace chai3d;
+using namespace std;
+
+/**
+ * @file cGeometryCache.h
+ *
+ * @class cGeometryCache
+ *
+ * @brief Meshes shared between objects with the same shape.
+ *
+ * Trials create and remove the same pipes, arrows and cups over and over. The first mesh of a given
+ * shape and size is generated at the origin and kept as a prototype; every mesh handed out is a copy
+ * that shares the prototype's vertex and triangle arrays and has its own transform and material.
+ * The arrays are reference counted, so removing an object never frees geometry another one uses.
+ * Collision trees are not shared, since every mesh deletes its own.
+ */
+class cGeometryCache
+{
+  private:
+    mutex lock;
+    unordered_map<string, cMesh*> prototypes;
+    atomic<unsigned long> hits{0};
+    atomic<unsigned long> misses{0};
+    cMesh* instance(const string& key, void (*create)(cMesh* mesh, const double* params), const double* params);
+
+  public:
+    cMesh* pipe(double height, double innerRadius, double outerRadius, unsigned int numSides,
+                unsigned int numHeightSegments);
+    cMesh* arrow(double length, double shaftRadius, double lengthTip, double radiusTip, bool bidirectional,
+                 unsigned int numSides);
+    cMesh* ringSection(double innerRadius0, double innerRadius1, double outerRadius, double coverageAngleDeg,
+                       bool includeExtremityFaces, unsigned int numSides, unsigned int numRings);
+    static cMatrix3d arrowRotation(const cVector3d& direction);
+    void printStats();
+};
@@ -1,4 +1,6 @@
 #include "cPipe.h"
+#include "graphics.h"
+extern GraphicsData graphicsData;
 
 /**
  * @param a_height Height of the pipe 
@@ -9,21 +11,26 @@
  * @param a_pos Position of the center of the pipe 
  * @param a_rot Rotation of the pipe, 0 is perfectly horizontal
  * @param a_color Color of the pipe
+ *
+ * The mesh shares its geometry with every other pipe of the same dimensions, see cGeometryCache.
  */
 cPipe::cPipe(double a_height, double a_innerRadius, double a_outerRadius, unsigned int a_numSides, 
-              unsigned int a_numHeightSegments, cVector3d* a_pos, cMatrix3d* a_rot, cColorf* a_color)
+              unsigned int a_numHeightSegments, const cVector3d& a_pos, const cMatrix3d& a_rot,
+              const cColorf& a_color)
 {
   height = a_height;
   innerRadius = a_innerRadius;
   outerRadius = a_outerRadius;
   numSides = a_numSides;
-  a_numHeightSegments = a_numHeightSegments;
+  numHeightSegments = a_numHeightSegments;
   pos = a_pos;
   rot = a_rot;
   color = a_color;
 
-  myMesh = new cMesh();
-  cCreatePipe(myMesh, height, innerRadius, outerRadius, numSides, numHeightSegments, *pos, *rot, *color);
+  myMesh = graphicsData.geometryCache.pipe(height, innerRadius, outerRadius, numSides, numHeightSegments);
+  myMesh->setLocalPos(pos);
+  myMesh->setLocalRot(rot);
+  myMesh->m_material->setColor(color);
 }
 
 /**
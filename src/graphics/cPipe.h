@@ -20,12 +20,12 @@ class cPipe : public cGenericObject
     double outerRadius;
     int numSides;
     int numHeightSegments;
-    cVector3d* pos;
-    cMatrix3d* rot;
-    cColorf* color;
+    cVector3d pos;
+    cMatrix3d rot;
+    cColorf color;
 
   public:
     cPipe(double height, double innerRadius, double outerRadius, unsigned int numSides, 
-          unsigned int numHeightSegments, cVector3d* pos, cMatrix3d* rot, cColorf* color);
+          unsigned int numHeightSegments, const cVector3d& pos, const cMatrix3d& rot, const cColorf& color);
     cMesh* getPipeObj();
 };
@@ -79,12 +79,19 @@ void initDisplay(void)
 }
 
 /**
- * Initializes the world for Chai3D. Also creates and sets the camera viewing angle and lighting.
+ * Creates the Chai3D world. This needs no window, so it is also done in hapticsOnly mode.
  */
-void initScene(void)
+void initWorld(void)
 {
   graphicsData.world = new cWorld();
   graphicsData.world->m_backgroundColor.setBlack();
+}
+
+/**
+ * Creates and sets the camera viewing angle and lighting of the world created by initWorld.
+ */
+void initScene(void)
+{
   graphicsData.camera = new cCamera(graphicsData.world);
   graphicsData.world->addChild(graphicsData.camera);
   graphicsData.camera->set(cVector3d(400.0, 0.0, 0.0),
@@ -177,16 +184,11 @@ void keySelectCallback(GLFWwindow* window, int key, int scancode, int action, in
     }
     M_KEYPRESS keypressEvent;
     memset(&keypressEvent, 0, sizeof(keypressEvent));
-    auto packetNum = controlData.client->call("getMsgNum").as<int>();
-    auto currTime = controlData.client->call("getTimestamp").as<double>();
-    keypressEvent.header.serial_no = packetNum;
-    keypressEvent.header.msg_type = KEYPRESS;
-    keypressEvent.header.timestamp = currTime;
+    stampHeader(&keypressEvent.header, KEYPRESS);
     memcpy(&(keypressEvent.keyname), key_name, sizeof(keypressEvent.keyname));
-    char* packet[sizeof(keypressEvent)];
+    char packet[sizeof(keypressEvent)];
     memcpy(&packet, &keypressEvent, sizeof(keypressEvent));
-    auto res = controlData.client->call("sendMessage", (char* const) packet, sizeof(packet), controlData.MODULE_NUM).as<int>();
-    //sendPacket((char *) packet, sizeof(packet), false);
+    int res = sendPacket(packet, sizeof(keypressEvent));
     if (res == 1) {
       cout << "Sent KEYPRESS message" << endl;
     }
@@ -203,14 +205,17 @@ void keySelectCallback(GLFWwindow* window, int key, int scancode, int action, in
  */
 void updateGraphics(void)
 {
+  beginWorldTraversal();
   graphicsData.world->updateShadowMaps(false, graphicsData.mirroredDisplay);
   graphicsData.camera->renderView(graphicsData.width, graphicsData.height);
-  for(vector<cGenericMovingObject*>::iterator it = graphicsData.movingObjects.begin(); it != graphicsData.movingObjects.end(); it++)
+  const vector<cGenericMovingObject*>* movingObjects = graphicsData.movingObjects.load(memory_order_acquire);
+  for(vector<cGenericMovingObject*>::const_iterator it = movingObjects->begin(); it != movingObjects->end(); it++)
   {
     double dt = (clock() - graphicsData.graphicsClock)/double(CLOCKS_PER_SEC);
     graphicsData.graphicsClock = clock();
     (*it)->graphicsLoopFunction(dt, hapticsData.tool->getDeviceGlobalPos(), hapticsData.tool->getDeviceGlobalLinVel());
   }
+  endWorldTraversal();
   glFinish();
   GLenum err = glGetError();
   if (err != GL_NO_ERROR) {
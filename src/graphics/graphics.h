@@ -7,6 +7,7 @@
 #include <GLFW/glfw3.h>
 #include "haptics/haptics.h"
 #include <vector>
+#include <atomic>
 
 // ------------------------------------------------------
 // -------------Custom Graphics Functionality------------
@@ -15,6 +16,7 @@
 #include "cMovingDots.h"
 #include "cPipe.h"
 #include "cArrow.h"
+#include "cGeometryCache.h"
 
 using namespace chai3d; 
 using namespace std; 
@@ -35,10 +37,14 @@ struct GraphicsData {
   cShapeTorus* object;
   cFrequencyCounter freqCounterGraphics;
   clock_t graphicsClock;
-  vector<cGenericMovingObject*> movingObjects;
+  // Replaced as a whole by the haptics thread, never changed in place, so the graphics thread can
+  // iterate over it while objects are added and removed. Old lists are retired, see reclaim.h
+  atomic<const vector<cGenericMovingObject*>*> movingObjects;
+  cGeometryCache geometryCache;
 };
 
 void initDisplay(void);
+void initWorld(void);
 void initScene(void);
 void errorCallback(int error, const char* errorDescription);
 void resizeWindowCallback(GLFWwindow* window, int w, int h);
@@ -15,13 +15,15 @@ extern GraphicsData graphicsData;
 extern ControlData controlData;
 
 /**
- * @brief Initializes the haptic thread. 
+ * @brief Opens and calibrates the haptic device.
  *
- * Contains some custom scale factors depending on which device is
- * used (Falcon or delta.3)
+ * Contains some custom scale factors depending on which device is used (Falcon or delta.3). This
+ * does not need the world, so it can run while the window and the world are being created.
+ * @return 1 if the device was opened, 0 otherwise
  */
-void initHaptics(void)
+int openHapticDevice(void)
 {
+  hapticsData.deviceTicks = 0;
   hapticsData.handler = new cHapticDeviceHandler();
   hapticsData.handler->getDevice(hapticsData.hapticDevice, 0);
   hapticsData.hapticDeviceInfo = hapticsData.hapticDevice->getSpecifications();
@@ -50,13 +52,24 @@ void initHaptics(void)
     //hapticsData.hapticDevice->close();
     cout << "Device not recognized." << endl;
   }
-  
+  hapticsData.workspaceScaleFactor = workspaceScaleFactor;
+  hapticsData.maxForce = hapticsData.hapticDeviceInfo.m_maxLinearForce;
+  return open_success ? 1 : 0;
+}
+
+/**
+ * @brief Initializes the haptic tool.
+ *
+ * Creates the tool cursor for the device opened by openHapticDevice and adds it to the world.
+ */
+void initHaptics(void)
+{
   hapticsData.tool = new cToolCursor(graphicsData.world);
   hapticsData.tool->m_hapticPoint->m_sphereProxy->m_material->setRed();
   graphicsData.world->addChild(hapticsData.tool);
   hapticsData.tool->setHapticDevice(hapticsData.hapticDevice);
   hapticsData.tool->setRadius(HAPTIC_TOOL_RADIUS);
-  hapticsData.tool->setWorkspaceScaleFactor(workspaceScaleFactor);
+  hapticsData.tool->setWorkspaceScaleFactor(hapticsData.workspaceScaleFactor);
   hapticsData.tool->setWaitForSmallForce(false);
   if (hapticsData.hapticDeviceInfo.m_model == C_HAPTIC_DEVICE_DELTA_3) {
     cMatrix3d rotate = cMatrix3d();
@@ -64,8 +77,6 @@ void initHaptics(void)
     hapticsData.tool->setDeviceGlobalRot(rotate);
   }
   hapticsData.tool->start();
-  
-  hapticsData.maxForce = hapticsData.hapticDeviceInfo.m_maxLinearForce;
   cout << "Haptics tool initialized" << endl;
 }
 
@@ -96,17 +107,23 @@ void updateHaptics(void)
   clock.reset();
   cVector3d angVel(0.0, 0.0, 0.1);
   usleep(500); // give some time for other threads to start up
+  enterEpochs(HAPTICS_READER);
   while (controlData.simulationRunning){
     clock.stop();
     double timeInterval = clock.getCurrentTimeSeconds();
     clock.reset();
     clock.start();
+    applySceneCommands(SCENE_TICK_BUDGET_US * 1000);
     graphicsData.world->computeGlobalPositions(true);
     cVector3d pos = hapticsData.tool->getDeviceLocalPos();
     //cout << pos.x() << ", " << pos.y() << ", " << pos.z() << endl;
     hapticsData.tool->updateFromDevice();
     hapticsData.tool->computeInteractionForces();
     hapticsData.tool->applyToDevice();
+    hapticsData.deviceTicks.fetch_add(1, memory_order_relaxed);
+    // The tool's contacts now only refer to objects still in the world
+    quiescent(HAPTICS_READER);
   }
+  leaveEpochs(HAPTICS_READER);
   controlData.hapticsUp = false;
 }
@@ -4,6 +4,7 @@
 #define _HAPTICS_H_INCLUDED_
 
 #include <stdio.h>
+#include <atomic>
 #include "chai3d.h"
 #include "graphics/graphics.h"
 #include "core/controller.h"
@@ -21,10 +22,13 @@ struct HapticData
   cFrequencyCounter freqCounterHaptics;
   double toolRadius;
   double maxForce;
+  double workspaceScaleFactor; // depends on the device model, set by openHapticDevice
+  atomic<unsigned int> deviceTicks; // haptic loop iterations, reported in HAPTIC_DATA_STREAM_V2
 };
 
 #define HAPTIC_TOOL_RADIUS 2
 
+int openHapticDevice(void);
 void initHaptics(void);
 void startHapticsThread(void);
 void updateHaptics(void);
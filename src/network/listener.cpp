@@ -2,6 +2,7 @@
 #include "haptics/haptics.h"
 #include "network.h"
 #include "core/controller.h"
+#include "messageDispatch.h"
 
 using namespace chai3d;
 using namespace std;
@@ -23,31 +24,57 @@ extern HapticData hapticsData;
  */
 void startListener()
 {
+  openListenerWakeup();
   controlData.listenerThread = new cThread();
   controlData.listenerThread->start(updateListener, CTHREAD_PRIORITY_HAPTICS);
   controlData.listenerUp = true;
 }
 
 /**
- * Upon receiving a packet, call the parsePacket function
+ * Zeroes the part of a short packet that its message struct would cover, so that parsePacket,
+ * which copies whole structs, reads zeros rather than what was left in the buffer.
+ */
+void zeroPacketTail(char* packet, int length)
+{
+  const MESSAGE_INFO* info = findMessageInfo(packetMsgType(packet, length));
+  int size = (info == NULL) ? (int) sizeof(MSG_HEADER) : info->size;
+  if (length < size) {
+    memset(packet + length, 0, size - length);
+  }
+}
+
+/**
+ * Waits for packets and calls parsePacket on each. Packets are received in batches with recvmmsg,
+ * and the thread sleeps in the kernel while there are none. wakeListener ends the wait, e.g. when
+ * the simulation stops.
  * @see parsePacket
  */
 void updateListener()
 {
-  char rawPacket[MAX_PACKET_LENGTH];
-  char* packetPointer = rawPacket;
-  
+  PacketBatch* batch = new PacketBatch;
+  initPacketBatch(batch);
+  char* ringPacket = new char[MAX_PACKET_LENGTH];
+  bool checkRings = readingRings();
+
   while (controlData.simulationRunning)
   {
-    memset(rawPacket, 0, MAX_PACKET_LENGTH);
-    int bytesRead = readPacket(packetPointer);
-    if (bytesRead > 0) {
-      //cout << "Bytes read " << bytesRead << endl;
-      parsePacket(packetPointer);
+    waitForPackets(checkRings);
+    int received;
+    while (controlData.simulationRunning && (received = readPackets(batch)) > 0) {
+      for (int i = 0; i < received && controlData.simulationRunning; i++) {
+        int length = batch->msgs[i].msg_len;
+        zeroPacketTail(batch->buffers[i], length);
+        parsePacket(batch->buffers[i], length);
+      }
+    }
+    int length;
+    while (controlData.simulationRunning && (length = readRingPacket(ringPacket)) > 0) {
+      zeroPacketTail(ringPacket, length);
+      parsePacket(ringPacket, length);
     }
-    usleep(100); // 1000 microseconds = 1 millisecond
   }
- closeMessagingSocket();
- controlData.listenerUp = false;
+  delete[] ringPacket;
+  delete batch;
+  closeMessagingSocket();
+  controlData.listenerUp = false;
 }
-
@@ -7,6 +7,7 @@
 
 void startListener(void);
 void updateListener(void);
+void zeroPacketTail(char* packet, int length);
 //void closeListener(void);
 //void startDataLogger(void);
 //void closeDataLogger(void);
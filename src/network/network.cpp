@@ -21,6 +21,48 @@ extern ControlData controlData;
 struct sockaddr_in msgStruct;
 int msgLen = sizeof(msgStruct);
 
+// Serial numbers leased from MessageHandler, handed out locally until the block runs out
+mutex serialMutex;
+int nextSerial = 0;
+int serialLeaseEnd = 0;
+
+// Local clock to MessageHandler clock mapping: 
+// brokerNs = localNs + clockOffsetNs + clockDrift * (localNs - clockRefNs)
+mutex clockMutex;
+atomic<bool> clockSynced{false};
+int64_t clockRefNs = 0;
+double clockOffsetNs = 0.0;
+double clockDrift = 0.0;
+int64_t clockAnchorNs = 0;
+double clockAnchorOffsetNs = 0.0;
+
+// Shared memory rings, only used when MessageHandler was started with shared memory enabled
+SharedRing* publishRing = NULL;
+// A ring has a single writer, but sendPacket is called from the streamer, haptics, graphics and
+// build pool threads
+mutex publishMutex;
+vector<SharedRing*> subscribedRings;
+vector<uint64_t> subscribedCursors;
+
+// Socket for sending straight to the MessageHandler ingest port, if it has one
+int ingestSocket = -1;
+struct sockaddr_in ingestStruct;
+
+// Socket that receives packets sent to the multicast groups of the modules this one joined
+int multicastSocket = -1;
+
+// Written to by wakeListener, so that the listener wakes up without a packet arriving
+int listenerWakeFd = -1;
+
+// Last module MessageHandler sent MODULE_READY for, see waitForModuleReady
+atomic<int> readyModule{-1};
+
+static int64_t localClockNs()
+{
+  return chrono::duration_cast<chrono::nanoseconds>(
+      chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /**
  * This function adds the robot environment to the MessageHandler. Information such as the module
  * number, IP address, and port are set through command-line inputs and stored in the controlData
@@ -34,28 +76,61 @@ int addMessageHandlerModule()
 
 /**
  * Subscribe to the trial control module. This tells MessageHandler to take all messages sent by
- * Trial Control and send them to this module.
+ * Trial Control and send them to this module. If Trial Control has not been added to
+ * MessageHandler yet, the subscription is made when it is, and MessageHandler then sends
+ * MODULE_READY, see waitForModuleReady.
+ * @return 1 if subscribed, 2 if the subscription is deferred, 0 on failure
  */
 int subscribeToTrialControl() 
 {
-  bool subscribed = false;
-  clock_t begin = clock();
-  while (subscribed == false) {
-    auto subscribe = controlData.client->async_call("subscribeTo", 1, 2);
-    subscribe.wait();
-    if (subscribe.get().as<int>() == 1) {
-      subscribed = true;
-      return 1;
+  return controlData.client->call("subscribeTo", controlData.MODULE_NUM, TRIAL_CONTROL_MODULE).as<int>();
+}
+
+/**
+ * Records that MessageHandler sent MODULE_READY for a module.
+ */
+void markModuleReady(int moduleID)
+{
+  readyModule.store(moduleID);
+}
+
+/**
+ * Waits for MODULE_READY after a deferred subscription. The listener is not running yet, so this
+ * receives packets itself and passes every one of them, MODULE_READY included, to parsePacket;
+ * packets from the module that arrive before MODULE_READY are therefore not lost.
+ * @param moduleID ID of the module the subscription is waiting for
+ * @param timeoutSeconds Time after which to give up
+ * @return 1 once the module is ready, 0 on timeout
+ */
+int waitForModuleReady(int moduleID, double timeoutSeconds)
+{
+  PacketBatch* batch = new PacketBatch;
+  initPacketBatch(batch);
+  chrono::steady_clock::time_point deadline = chrono::steady_clock::now() +
+      chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(timeoutSeconds));
+  while (readyModule.load() != moduleID && chrono::steady_clock::now() < deadline) {
+    struct pollfd fds[2];
+    int numFds = 0;
+    fds[numFds].fd = controlData.msg_socket;
+    fds[numFds++].events = POLLIN;
+    if (multicastSocket >= 0) {
+      fds[numFds].fd = multicastSocket;
+      fds[numFds++].events = POLLIN;
     }
-    clock_t now = clock();
-    double elapsed = double(now - begin)/CLOCKS_PER_SEC;
-    if (elapsed > 120) {
-      cout << "Error subscribing to Trial Control, exiting." << endl;
-      return 0;
+    if (poll(fds, numFds, READY_POLL_MS) <= 0) {
+      continue;
+    }
+    int received;
+    while ((received = readPackets(batch)) > 0) {
+      for (int i = 0; i < received; i++) {
+        int length = batch->msgs[i].msg_len;
+        zeroPacketTail(batch->buffers[i], length);
+        parsePacket(batch->buffers[i], length);
+      }
     }
-    sleep(5); // 1000 microseconds = 1 millisecond
   }
-  return 1;
+  delete batch;
+  return (readyModule.load() == moduleID) ? 1 : 0;
 }
 
 /**
@@ -90,31 +165,390 @@ int openMessagingSocket()
     cout << "Error binding messaging socket" << endl;
     exit(1);
   }
+  joinMulticastGroup(TRIAL_CONTROL_MODULE);
   return 1; 
 }
 
+/**
+ * Joins the multicast group that MessageHandler sends a module's packets to, if MessageHandler was
+ * started with multicast enabled. Packets from that module then arrive on the multicast socket
+ * instead of the messaging socket.
+ * @param publisherID ID of the module whose packets should be received through its group
+ * @return 1 if the group was joined, 0 if this module stays on unicast
+ */
+int joinMulticastGroup(int publisherID)
+{
+  string group = controlData.client->call("getMulticastGroup", publisherID).as<string>();
+  size_t colon = group.find(':');
+  if (group.empty() || colon == string::npos) {
+    return 0;
+  }
+  string groupIP = group.substr(0, colon);
+  int groupPort = atoi(group.substr(colon+1).c_str());
+  if (multicastSocket < 0) {
+    multicastSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (multicastSocket < 0) {
+      cout << "Opening multicast socket failed" << endl;
+      return 0;
+    }
+    int opt = 1;
+    int all = 0; // only receive the groups joined on this socket
+    setsockopt(multicastSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(multicastSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+    setsockopt(multicastSocket, IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all));
+    struct sockaddr_in groupStruct;
+    memset((char*) &groupStruct, 0, sizeof(groupStruct));
+    groupStruct.sin_family = AF_INET;
+    groupStruct.sin_port = htons(groupPort);
+    groupStruct.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(multicastSocket, (struct sockaddr*) &groupStruct, sizeof(groupStruct)) < 0) {
+      cout << "Error binding multicast socket, staying on unicast" << endl;
+      close(multicastSocket);
+      multicastSocket = -1;
+      return 0;
+    }
+  }
+  struct ip_mreq membership;
+  membership.imr_multiaddr.s_addr = inet_addr(groupIP.c_str());
+  membership.imr_interface.s_addr = inet_addr(controlData.IPADDR);
+  if (setsockopt(multicastSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+    cout << "Could not join multicast group " << group << ", staying on unicast" << endl;
+    return 0;
+  }
+  if (controlData.client->call("joinMulticast", controlData.MODULE_NUM, publisherID).as<int>() != 1) {
+    setsockopt(multicastSocket, IPPROTO_IP, IP_DROP_MEMBERSHIP, &membership, sizeof(membership));
+    return 0;
+  }
+  cout << "Joined multicast group " << group << " of module " << publisherID << endl;
+  return 1;
+}
+
 /**
  * Closes the socket for this module.
  */
 void closeMessagingSocket()
 {
   shutdown(controlData.msg_socket, 2);
+  if (multicastSocket >= 0) {
+    shutdown(multicastSocket, 2);
+  }
 }
 
 /**
- * Receives messages on the messaging socket and sends them to be parsed by the controller
- * @param packetPointer is a char pointer to store the read-in bytes
+ * Opens the eventfd that wakeListener uses to wake up the listener thread.
+ * @return 1 on success, 0 on failure
+ */
+int openListenerWakeup()
+{
+  listenerWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (listenerWakeFd < 0) {
+    cout << "Opening listener eventfd failed" << endl;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Wakes up the listener thread if it is waiting for packets, e.g. so that it sees that the
+ * simulation is no longer running.
+ */
+void wakeListener()
+{
+  if (listenerWakeFd >= 0) {
+    uint64_t one = 1;
+    ssize_t written = write(listenerWakeFd, &one, sizeof(one));
+    (void) written;
+  }
+}
+
+/**
+ * Blocks until a packet arrives on the messaging or multicast socket, or until wakeListener is
+ * called. Shared memory rings cannot be waited on, so if this module reads any, the wait also ends
+ * after LISTENER_RING_POLL_NS.
+ * @param readingRings True if the caller needs to check shared memory rings
+ * @return 1 if woken up by wakeListener, 0 otherwise
+ */
+int waitForPackets(bool readingRings)
+{
+  struct pollfd fds[3];
+  int numFds = 0;
+  fds[numFds].fd = controlData.msg_socket;
+  fds[numFds++].events = POLLIN;
+  if (multicastSocket >= 0) {
+    fds[numFds].fd = multicastSocket;
+    fds[numFds++].events = POLLIN;
+  }
+  int wakeIndex = numFds;
+  if (listenerWakeFd >= 0) {
+    fds[numFds].fd = listenerWakeFd;
+    fds[numFds++].events = POLLIN;
+  }
+  struct timespec ringPoll;
+  ringPoll.tv_sec = 0;
+  ringPoll.tv_nsec = LISTENER_RING_POLL_NS;
+  if (ppoll(fds, numFds, readingRings ? &ringPoll : NULL, NULL) <= 0) {
+    return 0;
+  }
+  if (wakeIndex < numFds && (fds[wakeIndex].revents & POLLIN)) {
+    uint64_t count;
+    ssize_t bytesRead = read(listenerWakeFd, &count, sizeof(count));
+    (void) bytesRead;
+    return 1;
+  }
+  return 0;
+}
+
+void initPacketBatch(PacketBatch* batch)
+{
+  memset(batch->msgs, 0, sizeof(batch->msgs));
+  for (int i = 0; i < LISTENER_BATCH_SIZE; i++) {
+    batch->iovecs[i].iov_base = batch->buffers[i];
+    batch->iovecs[i].iov_len = MAX_PACKET_LENGTH;
+    batch->msgs[i].msg_hdr.msg_iov = &(batch->iovecs[i]);
+    batch->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  batch->multicastFirst = false;
+}
+
+/**
+ * Receives the packets waiting on a socket into the free slots of a batch, without blocking.
+ * @param first is the first free slot
+ * @return Number of packets received
+ */
+int readPackets(PacketBatch* batch, int sock, int first)
+{
+  if (sock < 0 || first >= LISTENER_BATCH_SIZE) {
+    return 0;
+  }
+  int received = recvmmsg(sock, batch->msgs + first, LISTENER_BATCH_SIZE - first, MSG_DONTWAIT, NULL);
+  return (received < 0) ? 0 : received;
+}
+
+/**
+ * Receives the packets waiting on the messaging socket and on the multicast socket, up to
+ * LISTENER_BATCH_SIZE in all. The socket read first alternates, so a busy socket cannot keep the
+ * other one from being read.
  * @see parsePacket
+ * @return Number of packets received into the batch
  */
-int readPacket(char* packetPointer)
+int readPackets(PacketBatch* batch)
 {
-  int value = 0, bytesRead = 0;
-  ioctl(controlData.msg_socket, FIONREAD, &value);
-  if (value > 0) {
-    bytesRead = recvfrom(controlData.msg_socket, packetPointer, MAX_PACKET_LENGTH, 0, (struct sockaddr*) &msgStruct, (socklen_t *) &msgLen);
-    //cout << bytesRead << " bytes read from socket" << endl;
+  int firstSocket = batch->multicastFirst ? multicastSocket : controlData.msg_socket;
+  int secondSocket = batch->multicastFirst ? controlData.msg_socket : multicastSocket;
+  batch->multicastFirst = !batch->multicastFirst;
+  int received = readPackets(batch, firstSocket, 0);
+  return received + readPackets(batch, secondSocket, received);
+}
+
+/**
+ * Switches this module to the shared memory transport if MessageHandler offers it. Packets from this
+ * module are then written to its own ring, and packets from Trial Control are read from Trial
+ * Control's ring. Must be called after subscribing to Trial Control. 
+ * @return 1 if shared memory is in use, 0 if this module stays on UDP
+ */
+int attachSharedMemory()
+{
+  string myRing = controlData.client->call("getRingName", controlData.MODULE_NUM).as<string>();
+  string trialControlRing = controlData.client->call("getRingName", TRIAL_CONTROL_MODULE).as<string>();
+  if (myRing.empty() || trialControlRing.empty()) {
+    return 0;
+  }
+  SharedRing* ownRing = SharedRing::attach(myRing.c_str());
+  SharedRing* tcRing = SharedRing::attach(trialControlRing.c_str());
+  if (ownRing == NULL || tcRing == NULL) {
+    cout << "Could not map shared memory rings, staying on UDP" << endl;
+    delete ownRing;
+    delete tcRing;
+    return 0;
+  }
+  if (controlData.client->call("useSharedRing", controlData.MODULE_NUM, 1, 1).as<int>() != 1) {
+    delete ownRing;
+    delete tcRing;
+    return 0;
+  }
+  subscribedRings.push_back(tcRing);
+  subscribedCursors.push_back(tcRing->writeIndex());
+  publishRing = ownRing;
+  cout << "Using shared memory rings " << myRing << " and " << trialControlRing << endl;
+  return 1;
+}
+
+/**
+ * Opens a socket for sending packets straight to the MessageHandler ingest port, so that
+ * sendPacket does not need an RPC per packet.
+ * @return 1 if the ingest port is in use, 0 if MessageHandler does not have one
+ */
+int openIngestSocket()
+{
+  int port = controlData.client->call("getIngestPort").as<int>();
+  if (port <= 0) {
+    return 0;
+  }
+  ingestSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (ingestSocket < 0) {
+    cout << "Opening ingest socket failed" << endl;
+    return 0;
+  }
+  memset((char*) &ingestStruct, 0, sizeof(ingestStruct));
+  ingestStruct.sin_family = AF_INET;
+  ingestStruct.sin_port = htons(port);
+  ingestStruct.sin_addr.s_addr = inet_addr(controlData.MH_IP);
+  cout << "Sending packets to MessageHandler ingest port " << port << endl;
+  return 1;
+}
+
+/**
+ * True if sendPacket bypasses the sendMessage RPC, either through a shared memory ring or through
+ * the MessageHandler ingest port. Batching packets into RPCs is pointless in that case.
+ */
+bool usingDirectTransport()
+{
+  return (publishRing != NULL || ingestSocket >= 0);
+}
+
+/**
+ * Reads the next packet from any of the shared memory rings this module subscribes to.
+ * @param packetPointer is a char pointer to store the read-in bytes
+ * @return Number of bytes read, 0 if there are no new packets
+ */
+int readRingPacket(char* packetPointer)
+{
+  for (size_t i = 0; i < subscribedRings.size(); i++) {
+    int bytesRead = subscribedRings[i]->read(&(subscribedCursors[i]), packetPointer);
+    if (bytesRead > 0) {
+      return bytesRead;
+    }
   }
-  return bytesRead;
+  return 0;
+}
+
+/**
+ * True if this module reads packets from shared memory rings, which the listener has to check
+ * periodically.
+ */
+bool readingRings()
+{
+  return !subscribedRings.empty();
+}
+
+/**
+ * Sends a packet to every module subscribed to this one. In order of preference, this goes through
+ * the shared memory ring if this module publishes to one, the MessageHandler ingest port if it has
+ * one, or the sendMessage RPC. Safe to call from several threads.
+ * @param packet Bytes of the message, starting with the MSG_HEADER
+ * @param length Length of the message in bytes
+ * @return 1 on success, 0 on failure
+ */
+int sendPacket(const char* packet, int length)
+{
+  if (publishRing != NULL) {
+    lock_guard<mutex> guard(publishMutex);
+    return publishRing->write(packet, length);
+  }
+  if (ingestSocket >= 0) {
+    MSG_INGEST_PREFIX prefix;
+    prefix.moduleID = controlData.MODULE_NUM;
+    prefix.reserved = 0;
+    struct iovec iov[2];
+    iov[0].iov_base = &prefix;
+    iov[0].iov_len = sizeof(prefix);
+    iov[1].iov_base = (void*) packet;
+    iov[1].iov_len = length;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &ingestStruct;
+    msg.msg_namelen = sizeof(ingestStruct);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    return (sendmsg(ingestSocket, &msg, 0) < 0) ? 0 : 1;
+  }
+  vector<char> packetData(packet, packet+length);
+  return controlData.client->call("sendMessage", packetData, length, controlData.MODULE_NUM).as<int>();
+}
+
+/**
+ * Estimates the offset between the local clock and the MessageHandler clock. Several round trips
+ * are made and the one with the shortest round trip time is kept, assuming that the MessageHandler
+ * sampled its clock halfway through. When called again later, the change in offset since the first
+ * synchronization gives the drift rate, so that timestamps stay on the MessageHandler timebase
+ * between synchronizations. 
+ */
+int syncBrokerClock()
+{
+  int64_t bestRtt = -1;
+  int64_t bestLocal = 0;
+  double bestOffset = 0.0;
+  for (int i = 0; i < CLOCK_SYNC_SAMPLES; i++) {
+    int64_t t0 = localClockNs();
+    int64_t brokerNs = controlData.client->call("getTimestampNs").as<int64_t>();
+    int64_t t1 = localClockNs();
+    int64_t rtt = t1 - t0;
+    if (bestRtt < 0 || rtt < bestRtt) {
+      bestRtt = rtt;
+      bestLocal = t0 + rtt/2;
+      bestOffset = double(brokerNs - bestLocal);
+    }
+  }
+  
+  lock_guard<mutex> lock(clockMutex);
+  if (clockSynced == false) {
+    clockAnchorNs = bestLocal;
+    clockAnchorOffsetNs = bestOffset;
+    clockDrift = 0.0;
+  }
+  else if (bestLocal - clockAnchorNs > 1e9) {
+    clockDrift = (bestOffset - clockAnchorOffsetNs)/double(bestLocal - clockAnchorNs);
+  }
+  clockRefNs = bestLocal;
+  clockOffsetNs = bestOffset;
+  clockSynced = true;
+  return 1;
+}
+
+/**
+ * Returns the next serial number for an outgoing message. Serial numbers are leased from
+ * MessageHandler in blocks of SERIAL_LEASE_SIZE, so only one in every SERIAL_LEASE_SIZE calls makes
+ * a round trip.
+ */
+int getSerialNumber()
+{
+  lock_guard<mutex> lock(serialMutex);
+  if (nextSerial >= serialLeaseEnd) {
+    nextSerial = controlData.client->call("getMsgNumBlock", SERIAL_LEASE_SIZE).as<int>();
+    serialLeaseEnd = nextSerial + SERIAL_LEASE_SIZE;
+  }
+  return nextSerial++;
+}
+
+/**
+ * Returns the current time in seconds on the MessageHandler timebase, computed from the local clock
+ * @see syncBrokerClock
+ */
+double getBrokerTimestamp()
+{
+  if (clockSynced == false) {
+    syncBrokerClock();
+  }
+  int64_t localNs = localClockNs();
+  double brokerNs;
+  {
+    lock_guard<mutex> lock(clockMutex);
+    brokerNs = localNs + clockOffsetNs + clockDrift * double(localNs - clockRefNs);
+  }
+  return brokerNs/1e9;
+}
+
+/**
+ * Fills in the serial number, message type, and timestamp of an outgoing message header without
+ * making any calls to MessageHandler (except to renew the serial number lease).
+ * @param header Header of the message to be sent
+ * @param msgType Type of the message, from messageDefinitions.h
+ */
+void stampHeader(MSG_HEADER* header, int msgType)
+{
+  header->serial_no = getSerialNumber();
+  header->msg_type = msgType;
+  header->timestamp = getBrokerTimestamp();
 }
 
 /**
@@ -123,5 +557,11 @@ int readPacket(char* packetPointer)
 void closeAllConnections()
 {
   close(controlData.msg_socket);
+  if (listenerWakeFd >= 0) {
+    close(listenerWakeFd);
+  }
+  if (multicastSocket >= 0) {
+    close(multicastSocket);
+  }
 
 }
@@ -4,11 +4,15 @@
 #define _NETWORK_H_  
 
 #include "messageDefinitions.h"
+#include "sharedRing.h"
 #include <stdio.h>
 #include <string.h>
 #include <vector>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include <poll.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <unistd.h>
@@ -18,10 +22,52 @@
 #include <sstream>
 #include <iostream>
 #include <fcntl.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#define SERIAL_LEASE_SIZE 4096 // serial numbers reserved from MessageHandler per request
+#define CLOCK_SYNC_SAMPLES 8 // round trips per clock synchronization, the fastest one is kept
+#define CLOCK_SYNC_INTERVAL 5.0 // seconds between clock resynchronizations
+#define TRIAL_CONTROL_MODULE 2
+#define SUBSCRIBE_TIMEOUT 120 // seconds to wait for Trial Control to be added to MessageHandler
+#define READY_POLL_MS 100 // how often waitForModuleReady checks its timeout
+#define LISTENER_BATCH_SIZE 32 // packets received per recvmmsg call
+#define LISTENER_RING_POLL_NS 100000 // how often the listener checks shared memory rings
+
+/**
+ * Preallocated buffers for receiving a batch of packets with one recvmmsg call. Packet i is in
+ * buffers[i] and is msgs[i].msg_len bytes long.
+ */
+struct PacketBatch
+{
+  char buffers[LISTENER_BATCH_SIZE][MAX_PACKET_LENGTH];
+  struct iovec iovecs[LISTENER_BATCH_SIZE];
+  struct mmsghdr msgs[LISTENER_BATCH_SIZE];
+  bool multicastFirst; // socket readPackets reads first, swapped on each call so neither starves
+};
 
 int addMessageHandlerModule();
 int subscribeToTrialControl();
+void markModuleReady(int moduleID);
+int waitForModuleReady(int moduleID, double timeoutSeconds);
 int openMessagingSocket();
+int joinMulticastGroup(int publisherID);
 void closeMessagingSocket();
-int readPacket(char* packet);
+int openListenerWakeup();
+void wakeListener();
+int waitForPackets(bool readingRings);
+void initPacketBatch(PacketBatch* batch);
+int readPackets(PacketBatch* batch, int sock, int first);
+int readPackets(PacketBatch* batch);
+int attachSharedMemory();
+int openIngestSocket();
+bool usingDirectTransport();
+int readRingPacket(char* packet);
+bool readingRings();
+int sendPacket(const char* packet, int length);
+int syncBrokerClock();
+int getSerialNumber();
+double getBrokerTimestamp();
+void stampHeader(MSG_HEADER* header, int msgType);
 #endif
@@ -2,6 +2,7 @@
 
 #include "haptics/haptics.h"
 #include "network.h"
+#include "streamFrame.h"
 
 using namespace chai3d;
 using namespace std;
@@ -28,7 +29,123 @@ void startStreamer(void)
 }
 
 /**
- * Gets and sends the position, velocity, and force data of the robot
+ * Fills in a HAPTIC_DATA_STREAM message. At most 4 contacts fit in the message, others are left
+ * out.
+ * @return Length of the packet
+ */
+int buildStreamPacket(char* packet, const cVector3d& pos, const cVector3d& vel, const cVector3d& force)
+{
+  M_HAPTIC_DATA_STREAM toolData;
+  memset(&toolData, 0, sizeof(toolData)); 
+  stampHeader(&toolData.header, HAPTIC_DATA_STREAM);
+  toolData.posX = pos.x();
+  toolData.posY = pos.y();
+  toolData.posZ = pos.z();
+  toolData.velX = vel.x();
+  toolData.velY = vel.y();
+  toolData.velZ = vel.z();
+  toolData.forceX = force.x();
+  toolData.forceY = force.y();
+  toolData.forceZ = force.z();
+  int collisionIdx = 0;
+  const vector<ContactObject>* contacts = controlData.contactObjects.load(memory_order_acquire);
+  for (size_t i = 0; i < contacts->size() && collisionIdx < 4; i++)
+  {
+    if (hapticsData.tool->isInContact((*contacts)[i].object)) {
+      strncpy(toolData.collisions[collisionIdx], (*contacts)[i].name.c_str(), MAX_STRING_LENGTH-1);
+      collisionIdx++;
+    }
+  }
+  memcpy(packet, &toolData, sizeof(toolData));
+  return sizeof(toolData);
+}
+
+/**
+ * Fills in a HAPTIC_DATA_STREAM_V2 message, listing contacts by object handle. Only the contacts
+ * that are listed are sent, so the packet length depends on the number of contacts.
+ * @return Length of the packet
+ */
+int buildStreamPacketV2(char* packet, const cVector3d& pos, const cVector3d& vel, const cVector3d& force)
+{
+  M_HAPTIC_DATA_STREAM_V2 toolData;
+  memset(&toolData, 0, sizeof(toolData));
+  stampHeader(&toolData.header, HAPTIC_DATA_STREAM_V2);
+  toolData.deviceTick = hapticsData.deviceTicks.load(memory_order_relaxed);
+  for (int i = 0; i < 3; i++) {
+    toolData.pos[i] = pos(i);
+    toolData.vel[i] = vel(i);
+    toolData.force[i] = force(i);
+  }
+  const vector<ContactObject>* contacts = controlData.contactObjects.load(memory_order_acquire);
+  for (size_t i = 0; i < contacts->size(); i++)
+  {
+    if (hapticsData.tool->isInContact((*contacts)[i].object)) {
+      if ((*contacts)[i].handle == -1 || toolData.numContacts == MAX_STREAM_CONTACTS) {
+        toolData.unnamedContacts++;
+      }
+      else {
+        toolData.contacts[toolData.numContacts++] = (*contacts)[i].handle;
+      }
+    }
+  }
+  int length = HAPTIC_STREAM_V2_SIZE(toolData.numContacts);
+  memcpy(packet, &toolData, length);
+  return length;
+}
+
+/**
+ * Appends a sample to a frame that has room for it.
+ * @param frameStart Time of the first sample in the frame
+ */
+void addFrameSample(M_HAPTIC_DATA_FRAME* frame, double frameStart, double sampleTime, const cVector3d& pos,
+                    const cVector3d& vel, const cVector3d& force)
+{
+  STREAM_SAMPLE& sample = frame->samples[frame->numSamples++];
+  sample.deviceTick = hapticsData.deviceTicks.load(memory_order_relaxed);
+  sample.timeOffset = sampleTime - frameStart;
+  for (int i = 0; i < 3; i++) {
+    sample.pos[i] = pos(i);
+    sample.vel[i] = vel(i);
+    sample.force[i] = force(i);
+  }
+}
+
+/**
+ * Turns the samples collected in a frame into a HAPTIC_DATA_FRAME message and empties the frame.
+ * @return Length of the packet
+ */
+int buildStreamFrame(char* packet, M_HAPTIC_DATA_FRAME* frame, double frameStart)
+{
+  stampHeader(&frame->header, HAPTIC_DATA_FRAME);
+  frame->header.timestamp = frameStart;
+  int length = HAPTIC_FRAME_SIZE(frame->numSamples);
+  memcpy(packet, frame, length);
+  frame->numSamples = 0;
+  return length;
+}
+
+/**
+ * Writes a stream packet to the data file. Frames are written as one HAPTIC_DATA_STREAM_V2 record
+ * per sample, so data files look the same whether or not the stream was aggregated.
+ */
+void logStreamPacket(const char* packet, int length)
+{
+  int numSamples = frameSampleCount(packet, length);
+  if (numSamples == 0) {
+    controlData.dataFile.write(packet, length);
+    return;
+  }
+  M_HAPTIC_DATA_STREAM_V2 sample;
+  for (int i = 0; i < numSamples; i++) {
+    unpackStreamFrame(packet, length, i, &sample);
+    controlData.dataFile.write((const char*) &sample, HAPTIC_STREAM_V2_SIZE(0));
+  }
+}
+
+/**
+ * Gets and sends the position, velocity, and force data of the robot. Samples are batched into a
+ * single sendMessages call to MessageHandler. With stream format 3, samples are first collected into
+ * HAPTIC_DATA_FRAME messages, which are sent as soon as they are full.
  */
 void updateStreamer(void)
 {
@@ -36,74 +153,92 @@ void updateStreamer(void)
   cVector3d vel;
   cVector3d force;
 
-  double posX = 0, posY = 0, posZ = 0;
-  double velX = 0, velY = 0, velZ = 0;
-  double forceX = 0, forceY = 0, forceZ = 0;
-
   cPrecisionClock clock;
+  clock.start(true);
+  double lastClockSync = 0.0;
+  
+  // Samples are sent to MessageHandler in batches of streamBatchSize, or sooner if the oldest
+  // unsent sample is more than streamBatchMicros old
+  vector<vector<char>> pendingPackets;
+  pendingPackets.reserve(controlData.streamBatchSize);
+  double batchStart = 0.0;
+  future<RPCLIB_MSGPACK::object_handle> sendBatch;
+  M_HAPTIC_DATA_FRAME frame;
+  memset(&frame, 0, sizeof(frame));
+  double frameStart = 0.0;
+  enterEpochs(STREAMER_READER);
   while (controlData.simulationRunning)
   {
+    // The contact list read by the last packet is no longer in use
+    quiescent(STREAMER_READER);
     pos = hapticsData.tool->getDeviceGlobalPos();
-    posX = pos.x();
-    posY = pos.y();
-    posZ = pos.z();
     vel = hapticsData.tool->getDeviceGlobalLinVel();
-    velX = vel.x();
-    velY = vel.y();
-    velZ = vel.z();
-
     force = hapticsData.tool->getDeviceGlobalForce();
-    forceX = force.x();
-    forceY = force.y();
-    forceZ = force.z();
     
-    M_HAPTIC_DATA_STREAM toolData;
-    memset(&toolData, 0, sizeof(toolData)); 
-    auto packetIdx = controlData.client->async_call("getMsgNum");
-    auto timestamp = controlData.client->async_call("getTimestamp");
-    packetIdx.wait();
-    timestamp.wait();
-    auto packetNum = packetIdx.get().as<int>();
-    auto currTime = timestamp.get().as<double>();
-    toolData.header.serial_no = packetNum;
-    toolData.header.msg_type = HAPTIC_DATA_STREAM;
-    toolData.header.timestamp = currTime;
-    toolData.posX = posX;
-    toolData.posY = posY;
-    toolData.posZ = posZ;
-    toolData.velX = velX;
-    toolData.velY = velY;
-    toolData.velZ = velZ;
-    toolData.forceX = forceX;
-    toolData.forceY = forceY;
-    toolData.forceZ = forceZ;
-    char collisions[4][MAX_STRING_LENGTH];
-    memset(&collisions, 0, sizeof(collisions));
-    int collisionIdx = 0;
-    unordered_map<string, cGenericObject*>::iterator objectItr;
-    for (objectItr = controlData.objectMap.begin(); objectItr != controlData.objectMap.end(); objectItr++)
-    {
-      if (hapticsData.tool->isInContact(objectItr->second)) {
-        int n = objectItr->first.length();
-        char objectName[n+1];
-        strcpy(objectName, objectItr->first.c_str());
-        memcpy(&(collisions[collisionIdx]), objectName, sizeof(collisions[collisionIdx]));
-        collisionIdx++;
+    if (clock.getCurrentTimeSeconds() - lastClockSync > CLOCK_SYNC_INTERVAL) {
+      syncBrokerClock();
+      lastClockSync = clock.getCurrentTimeSeconds();
+    }
+
+    char packet[MAX_PACKET_LENGTH];
+    int packetLength;
+    int streamFormat = controlData.streamFormat;
+    if (streamFormat != 3) {
+      // Drop what is left of a frame if the format was just changed
+      frame.numSamples = 0;
+    }
+    if (streamFormat == 3) {
+      double sampleTime = getBrokerTimestamp();
+      if (frame.numSamples == 0) {
+        frameStart = sampleTime;
       }
+      addFrameSample(&frame, frameStart, sampleTime, pos, vel, force);
+      if (frame.numSamples < controlData.frameSamples && (sampleTime - frameStart) * 1e6 < controlData.frameMicros) {
+        usleep(250);
+        continue;
+      }
+      packetLength = buildStreamFrame(packet, &frame, frameStart);
+    }
+    else if (streamFormat == 2) {
+      packetLength = buildStreamPacketV2(packet, pos, vel, force);
+    }
+    else {
+      packetLength = buildStreamPacket(packet, pos, vel, force);
     }
-    memcpy(&(toolData.collisions), collisions, sizeof(toolData.collisions));
-    char packet[sizeof(toolData)];
-    memcpy(&packet, &toolData, sizeof(toolData));
-    vector<char> packetData(packet, packet+sizeof(packet)/sizeof(char));
-    auto sendInt = controlData.client->async_call("sendMessage", packetData, sizeof(toolData), controlData.MODULE_NUM);
-    //auto sendInt = controlData.client->async_call("sendMessage", (char *) packet, sizeof(packet), controlData.MODULE_NUM);
     if (controlData.loggingData == true)
     {
-      controlData.dataFile.write((const char*) packet, sizeof(toolData));
+      logStreamPacket(packet, packetLength);
+    }
+    if (usingDirectTransport()) {
+      // Without an RPC per packet there is nothing to gain from batching
+      sendPacket(packet, packetLength);
+      usleep(250);
+      continue;
+    }
+    if (pendingPackets.empty()) {
+      batchStart = clock.getCurrentTimeSeconds();
+    }
+    pendingPackets.emplace_back(packet, packet+packetLength);
+    double batchAge = (clock.getCurrentTimeSeconds() - batchStart) * 1e6;
+    // A frame has already waited for its samples, so it is not held back again
+    if (streamFormat == 3 || (int) pendingPackets.size() >= controlData.streamBatchSize ||
+        batchAge >= controlData.streamBatchMicros) {
+      // Only one batch is in flight at a time, which also bounds how far the stream can fall behind
+      if (sendBatch.valid()) {
+        sendBatch.wait();
+        sendBatch.get();
+      }
+      sendBatch = controlData.client->async_call("sendMessages", pendingPackets, controlData.MODULE_NUM);
+      pendingPackets.clear();
     }
     usleep(250); // 1000 microseconds = 1 millisecond
-    sendInt.wait();
-    auto sendNum = sendInt.get().as<int>();
+  }
+  leaveEpochs(STREAMER_READER);
+  if (sendBatch.valid()) {
+    sendBatch.wait();
+  }
+  if (!pendingPackets.empty()) {
+    controlData.client->call("sendMessages", pendingPackets, controlData.MODULE_NUM);
   }
   closeMessagingSocket();
   controlData.streamerUp = false;
@@ -6,8 +6,21 @@
 #include <stdlib.h>
 #include "chai3d.h"
 #include <vector>
+#include <future>
+#include "messageDefinitions.h"
+
+#define STREAM_BATCH_SIZE 8 // samples per sendMessages call
+#define STREAM_BATCH_MICROS 2000 // maximum time a sample waits before its batch is sent
+#define STREAM_FRAME_SAMPLES 8 // samples per HAPTIC_DATA_FRAME
+#define STREAM_FRAME_MICROS 2000 // maximum time a sample waits before its frame is sent
 
 void startStreamer(void);
 //void closeStreamer(void);
 void updateStreamer(void);
+int buildStreamPacket(char* packet, const chai3d::cVector3d& pos, const chai3d::cVector3d& vel, const chai3d::cVector3d& force);
+int buildStreamPacketV2(char* packet, const chai3d::cVector3d& pos, const chai3d::cVector3d& vel, const chai3d::cVector3d& force);
+void addFrameSample(M_HAPTIC_DATA_FRAME* frame, double frameStart, double sampleTime, const chai3d::cVector3d& pos,
+                    const chai3d::cVector3d& vel, const chai3d::cVector3d& force);
+int buildStreamFrame(char* packet, M_HAPTIC_DATA_FRAME* frame, double frameStart);
+void logStreamPacket(const char* packet, int length);
 #endif